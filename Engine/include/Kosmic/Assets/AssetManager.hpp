@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Kosmic/Assets/Model.hpp"
+#include "Kosmic/Renderer/Texture.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace Kosmic::Assets {
+
+struct AssetManagerStats {
+    uint32_t textures{0};       // Alive, loaded or not
+    uint32_t models{0};
+    uint32_t decoding{0};       // Queued or running on the workers
+    uint32_t pendingUploads{0}; // Decoded, waiting for Update
+    uint32_t uploadsLastFrame{0};
+};
+
+// Loads textures and models in the background. Load* returns the asset right
+// away: a texture binds a white placeholder and a model draws nothing until
+// its data is uploaded. Files are read and decoded on the job system, and GL
+// uploads happen in Update on the render thread; textures are handed on to
+// the TextureStreamer, which fills them in over the following frames.
+//
+// Assets are shared by path. The manager only keeps weak references, so an
+// asset is freed as soon as the last shared_ptr to it goes away.
+//
+// Without a running job system (tools, tests) loads complete synchronously.
+class AssetManager {
+public:
+    static std::shared_ptr<Renderer::Texture> LoadTexture(const std::string& path);
+    static std::shared_ptr<Model> LoadModel(const std::string& path);
+
+    // Uploads decoded assets until budgetMs is spent (at least one per call)
+    static void Update(double budgetMs);
+    // Blocks until everything requested so far is decoded and uploaded
+    static void WaitAll();
+    // Drops pending uploads and the placeholder; call before the GL context goes
+    static void Shutdown();
+
+    static AssetManagerStats GetStats();
+};
+
+} // namespace Kosmic::Assets
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Shared by the cooked formats (.kmesh, .ktex): every cooked file starts with
+// a CookedHeader identifying its format and the source it was made from.
+namespace Kosmic::Assets {
+
+// Size and modification time of a source file
+struct SourceStamp {
+    uint64_t size{0};
+    int64_t writeTime{0};
+
+    bool IsValid() const { return size != 0; }
+    bool operator==(const SourceStamp&) const = default;
+};
+
+struct CookedHeader {
+    uint32_t magic{0};
+    uint32_t version{0};
+    SourceStamp source;
+};
+
+// Invalid if the file doesn't exist
+SourceStamp GetSourceStamp(const std::string& sourcePath);
+
+// "<source><extension>" next to the source
+inline std::string GetCookedPath(const std::string& sourcePath, const char* extension) {
+    return sourcePath + extension;
+}
+
+bool ReadCookedHeader(const std::string& cookedPath, CookedHeader& header);
+// Rewrites only the stamp, for sources that were touched but not changed
+bool WriteSourceStamp(const std::string& cookedPath, const SourceStamp& source);
+
+} // namespace Kosmic::Assets
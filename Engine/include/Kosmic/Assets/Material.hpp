@@ -3,6 +3,8 @@
 #include "Kosmic/Renderer/Texture.hpp"
 #include <memory>
 
+namespace Kosmic::Renderer { class Shader; }
+
 namespace Kosmic::Assets {
 
 class Material {
@@ -15,16 +17,27 @@ public:
     Math::Vector3 diffuse{1.0f, 1.0f, 1.0f};
     Math::Vector3 specular{1.0f, 1.0f, 1.0f};
     float shininess{32.0f};
+    float opacity{1.0f}; // Below 1 the material is drawn in the transparent pass
+
+    // Shader to draw with, the renderer's default shader when null
+    std::shared_ptr<Renderer::Shader> shader;
 
     // Textures
     std::shared_ptr<Renderer::Texture> diffuseMap;
     std::shared_ptr<Renderer::Texture> specularMap;
-    std::shared_ptr<Renderer::Texture> normalMap;
+    std::shared_ptr<Renderer::Texture> normalMap; // Cooked as BC5: sample .rg, rebuild z
 
     // Set texture methods
     void SetDiffuseMap(const std::string& path);
     void SetSpecularMap(const std::string& path);
     void SetNormalMap(const std::string& path);
+
+    bool IsTransparent() const { return opacity < 1.0f; }
+    // Unique per material, used for sorting draws
+    uint32_t GetID() const { return m_ID; }
+
+private:
+    uint32_t m_ID;
 };
 
 } // namespace Kosmic::Assets
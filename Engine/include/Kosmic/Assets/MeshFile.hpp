@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Kosmic/Assets/CookedFile.hpp"
+#include "Kosmic/Renderer/Mesh.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Cooked mesh format (.kmesh). Everything a Model needs is stored in the
+// layout the GPU takes it, so loading is a map and a few glBufferData calls:
+//
+//   Header | Submesh[submeshCount] | MaterialRecord[materialCount]
+//          | vertices (vertexCount * layout.stride bytes, packed in layout)
+//          | indices (indexSize bytes, uint16_t or uint32_t per submesh)
+//
+// Offsets are from the start of the file, blobs are 16 byte aligned.
+// Files are written in the host byte order (little endian everywhere we ship).
+namespace Kosmic::Assets::MeshFile {
+
+constexpr uint32_t Magic = 0x48534D4B; // "KMSH"
+// Bump whenever the layout below or Renderer::VertexLayout changes
+constexpr uint32_t Version = 5;
+constexpr const char* Extension = ".kmesh";
+constexpr size_t MaxPath = 256;
+
+struct Header {
+    CookedHeader cooked{Magic, Version, {}};
+    uint32_t submeshCount{0};
+    uint32_t materialCount{0};
+    uint32_t vertexCount{0};
+    uint32_t indexSize{0};      // Bytes, the blob mixes 16 and 32 bit submeshes
+    uint32_t reserved{0};
+    uint64_t submeshOffset{0};
+    uint64_t materialOffset{0};
+    uint64_t vertexOffset{0};
+    uint64_t indexOffset{0};
+    Renderer::VertexLayout layout; // Shared by every submesh
+};
+
+// One Renderer::Mesh; indices are relative to firstVertex, 16 bit when
+// vertexCount allows it
+struct Submesh {
+    uint32_t firstVertex{0};
+    uint32_t vertexCount{0};
+    uint32_t indexOffset{0};    // Bytes into the index blob, aligned to the index size
+    uint32_t indexCount{0};
+    Renderer::IndexType indexType{Renderer::IndexType::UInt32};
+    uint32_t material{0};
+    Math::AABB bounds;
+    Math::BoundingSphere boundingSphere;
+};
+
+struct MaterialRecord {
+    Math::Vector3 ambient{1.0f};
+    Math::Vector3 diffuse{1.0f};
+    Math::Vector3 specular{1.0f};
+    float shininess{32.0f};
+    float opacity{1.0f};
+    char diffuseMap[MaxPath]{}; // Relative to the model directory, empty when none
+    char normalMap[MaxPath]{};
+};
+
+static_assert(std::is_trivially_copyable_v<Header> && std::is_trivially_copyable_v<Submesh> &&
+              std::is_trivially_copyable_v<MaterialRecord> && std::is_trivially_copyable_v<Renderer::VertexLayout>,
+              "kmesh records are written and mapped as raw bytes");
+
+// Contents of a cooked file built in memory, e.g. by an import
+struct MeshData {
+    Renderer::VertexLayout layout;
+    std::vector<uint8_t> vertices; // Packed in layout
+    std::vector<uint8_t> indices;
+    std::vector<Submesh> submeshes;
+    std::vector<MaterialRecord> materials;
+};
+
+// Pointers into a cooked file (or a MeshData), valid as long as the memory is
+struct View {
+    const Header* header{nullptr};
+    const Submesh* submeshes{nullptr};
+    const MaterialRecord* materials{nullptr};
+    const uint8_t* vertices{nullptr};
+    const uint8_t* indices{nullptr};
+};
+
+// Checks the header and that every range lies inside the file
+std::optional<View> Parse(const uint8_t* data, size_t size);
+View MakeView(const MeshData& data, const Header& header);
+
+// Writes through a temporary file, so readers never see a half written one
+bool Write(const std::string& path, const MeshData& data, const SourceStamp& source);
+
+} // namespace Kosmic::Assets::MeshFile
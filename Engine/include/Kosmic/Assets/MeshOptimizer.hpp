@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Kosmic/Renderer/Mesh.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Import time mesh optimization. Operates on one indexed triangle list:
+// welds duplicate vertices, orders triangles for the post-transform vertex
+// cache (Tipsify), then for overdraw, and finally orders vertices by first
+// use so fetches walk the vertex buffer front to back.
+namespace Kosmic::Assets::MeshOptimizer {
+
+// FIFO cache used for both ordering and the stats; close to what current
+// GPUs behave like for these purposes
+constexpr uint32_t CacheSize = 16;
+
+// Counts add up across meshes, the ratios are taken at the end
+struct VertexCacheStats {
+    uint32_t triangles{0};
+    uint32_t vertices{0};   // Unique vertices referenced
+    uint32_t transforms{0}; // Cache misses
+
+    // Average cache miss ratio: transforms per triangle (0.5 - 3, lower is better)
+    float GetACMR() const { return triangles ? float(transforms) / float(triangles) : 0.0f; }
+    // Average transform to vertex ratio (1 is ideal)
+    float GetATVR() const { return vertices ? float(transforms) / float(vertices) : 0.0f; }
+
+    VertexCacheStats& operator+=(const VertexCacheStats& other) {
+        triangles += other.triangles;
+        vertices += other.vertices;
+        transforms += other.transforms;
+        return *this;
+    }
+};
+
+struct Options {
+    bool overdraw{true};
+    float overdrawThreshold{1.05f}; // ACMR the overdraw pass may give up, relative to the cache pass
+};
+
+struct Result {
+    VertexCacheStats before;
+    VertexCacheStats after;
+
+    Result& operator+=(const Result& other) {
+        before += other.before;
+        after += other.after;
+        return *this;
+    }
+};
+
+// Merges bitwise identical vertices; returns the new vertex count
+uint32_t WeldVertices(std::vector<Renderer::Vertex>& vertices, std::vector<uint32_t>& indices);
+// Reorders triangles with Tipsify (Sander et al. 2007)
+void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount);
+// Splits the list where the cache starts cold and sorts those clusters so
+// outward facing ones draw first; kept only within the ACMR threshold
+void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Renderer::Vertex>& vertices,
+                      float threshold = 1.05f);
+// Renumbers vertices in first use order, dropping unreferenced ones
+void OptimizeVertexFetch(std::vector<Renderer::Vertex>& vertices, std::vector<uint32_t>& indices);
+
+VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, uint32_t vertexCount,
+                                    uint32_t cacheSize = CacheSize);
+
+// All of the above in order
+Result Optimize(std::vector<Renderer::Vertex>& vertices, std::vector<uint32_t>& indices, const Options& options = {});
+
+} // namespace Kosmic::Assets::MeshOptimizer
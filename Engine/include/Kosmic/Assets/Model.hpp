@@ -2,6 +2,9 @@
 
 #include "Kosmic/Renderer/Mesh.hpp"
 #include "Kosmic/Assets/Material.hpp"
+#include "Kosmic/Assets/MeshFile.hpp"
+#include "Kosmic/Assets/MeshOptimizer.hpp"
+#include "Kosmic/Core/MappedFile.hpp"
 #include "Kosmic/Renderer/Shader.hpp"
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -10,27 +13,69 @@
 #include <vector>
 #include <memory>
 
+namespace Kosmic::Renderer { class Renderer3D; }
+
 namespace Kosmic::Assets {
 
 class Model {
 public:
+    // CPU side of a load: the mapped cooked file, or an Assimp import. Needs
+    // no GL context, so it can be built on any thread. View points into the
+    // members, so keep it where it was decoded.
+    struct Data {
+        MappedFile file;
+        MeshFile::MeshData imported;
+        MeshFile::Header header;
+        MeshFile::View view;
+        std::string directory;
+
+        Data() = default;
+        Data(const Data&) = delete;
+        Data& operator=(const Data&) = delete;
+    };
+
+    // Empty model, filled in by Upload
+    Model() = default;
+    // Loads right away. Uses the cooked "<path>.kmesh" when it is up to date with the source,
+    // otherwise imports through Assimp and writes the cooked file for next time.
+    // A .kmesh path is loaded directly.
     Model(const std::string& path);
     ~Model() = default;
 
+    // Imports a source model and writes it as a cooked .kmesh. Needs no GL context.
+    static bool Cook(const std::string& sourcePath, const std::string& cookedPath);
+
+    // Reads the cooked file or imports the source, on any thread
+    static bool Decode(const std::string& path, Data& data);
+    // Creates the meshes and materials, on the GL thread
+    void Upload(const Data& data);
+    bool IsLoaded() const { return m_Loaded; }
+
     // Draws the model using the provided shader
     void Draw(const std::shared_ptr<Renderer::Shader>& shader);
+    // Queues every mesh with its material, transform is applied on top of the mesh transforms
+    void Submit(Renderer::Renderer3D& renderer, const Math::Mat4& transform = Math::Mat4(1.0f)) const;
     const std::vector<std::shared_ptr<Renderer::Mesh>>& GetMeshes() const { return m_Meshes; }
     const std::vector<std::shared_ptr<Material>>& GetMaterials() const { return m_Materials; }
+    // Bounds of all meshes with their transforms, in model space
+    const Math::AABB& GetBounds() const { return m_Bounds; }
 
 private:
-    void LoadModel(const std::string& path);
-    void ProcessNode(aiNode* node, const aiScene* scene);
-    std::shared_ptr<Renderer::Mesh> ProcessMesh(aiMesh* mesh, const aiScene* scene);
-    std::shared_ptr<Material> ProcessMaterial(aiMaterial* material, const aiScene* scene);
+    static bool DecodeCooked(const std::string& cookedPath, const SourceStamp* source, Data& data);
+
+    static bool Import(const std::string& path, MeshFile::MeshData& data);
+    // Vertices are gathered at full precision, the layout is picked once all are known
+    static void ProcessNode(aiNode* node, const aiScene* scene, MeshFile::MeshData& data,
+                            std::vector<Renderer::Vertex>& vertices, MeshOptimizer::Result& stats);
+    static MeshOptimizer::Result ProcessMesh(aiMesh* mesh, MeshFile::MeshData& data,
+                                             std::vector<Renderer::Vertex>& vertices);
+    static MeshFile::MaterialRecord ProcessMaterial(aiMaterial* material);
     
     std::vector<std::shared_ptr<Renderer::Mesh>> m_Meshes;
     std::vector<std::shared_ptr<Material>> m_Materials;
     std::string m_Directory;
+    Math::AABB m_Bounds;
+    bool m_Loaded{false};
 };
 
 } // namespace Kosmic::Assets
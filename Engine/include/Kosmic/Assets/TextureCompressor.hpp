@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Kosmic/Assets/TextureFile.hpp"
+#include <cstdint>
+
+// CPU block encoders for the cooker. They fit endpoints along the principal
+// axis of each 4x4 block and pick the nearest palette entry per texel; quick
+// enough to cook a scene in seconds, at a quality close to the driver's own.
+namespace Kosmic::Assets::TextureCompressor {
+
+// Encodes one block of 16 RGBA texels, row major in memory order
+void EncodeBC1Block(const uint8_t* rgba, uint8_t* block);
+void EncodeBC3Block(const uint8_t* rgba, uint8_t* block);
+// One channel of 16 values, the building block of BC3 alpha and BC5
+void EncodeBC4Block(const uint8_t* values, uint8_t* block);
+// Red and green of 16 RGBA texels
+void EncodeBC5Block(const uint8_t* rgba, uint8_t* block);
+// Mode 6 only: one RGBA endpoint pair with 16 steps, no partitions
+void EncodeBC7Block(const uint8_t* rgba, uint8_t* block);
+
+// Picks BC1 for opaque images and BC3 otherwise, or BC7 for both when asked;
+// normal maps always get BC5
+TextureFile::Format ChooseFormat(const TextureFile::TextureData& data, bool normalMap, bool bc7 = false);
+
+// Converts every level of an uncompressed texture to BC1, BC3, BC5 or BC7 in place.
+// Block rows are encoded in parallel when the job system is running.
+bool Compress(TextureFile::TextureData& data, TextureFile::Format format);
+
+} // namespace Kosmic::Assets::TextureCompressor
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Kosmic/Assets/CookedFile.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Cooked texture format (.ktex): pixels already flipped for OpenGL with the
+// full mip chain, either uncompressed or in a BCn block format, so loading
+// is one glTexImage2D / glCompressedTexImage2D per level.
+//
+//   Header | MipLevel[mipCount] | level 0 pixels | level 1 pixels | ...
+//
+// Rows are tightly packed (upload with GL_UNPACK_ALIGNMENT 1), levels are
+// 16 byte aligned. Compressed levels are rows of 4x4 blocks, partial blocks
+// at the right and bottom edges included.
+namespace Kosmic::Assets::TextureFile {
+
+constexpr uint32_t Magic = 0x5845544B; // "KTEX"
+constexpr uint32_t Version = 2;
+constexpr const char* Extension = ".ktex";
+
+enum class Format : uint32_t {
+    RGB8,
+    RGBA8,
+    BC1,   // RGB, 8 bytes per block
+    BC3,   // RGBA, 16 bytes per block
+    BC5,   // Two channels (normal map XY), 16 bytes per block
+    BC7    // RGBA, 16 bytes per block; cooked only with --bc7
+};
+
+struct Header {
+    CookedHeader cooked{Magic, Version, {}};
+    Format format{Format::RGBA8};
+    uint32_t width{0};
+    uint32_t height{0};
+    uint32_t mipCount{0};
+    uint64_t levelOffset{0};
+};
+
+struct MipLevel {
+    uint32_t width{0};
+    uint32_t height{0};
+    uint64_t offset{0};
+    uint64_t size{0};
+};
+
+static_assert(std::is_trivially_copyable_v<Header> && std::is_trivially_copyable_v<MipLevel>,
+              "ktex records are written and mapped as raw bytes");
+
+bool IsCompressed(Format format);
+// Uncompressed formats only
+uint32_t GetBytesPerPixel(Format format);
+// Uploads go by row units: one pixel row, or one row of 4x4 blocks
+uint32_t GetRowHeight(Format format);
+uint64_t GetRowPitch(Format format, uint32_t width);
+uint64_t GetLevelSize(Format format, uint32_t width, uint32_t height);
+const char* GetFormatName(Format format);
+
+// Decoded image in memory, level 0 first
+struct TextureData {
+    Format format{Format::RGBA8};
+    std::vector<MipLevel> levels;
+    std::vector<uint8_t> pixels;
+};
+
+// Box filters level 0 down to 1x1, appending the levels (uncompressed only)
+void GenerateMips(TextureData& data);
+
+struct View {
+    const Header* header{nullptr};
+    const MipLevel* levels{nullptr};
+    const uint8_t* data{nullptr}; // Start of the file, level offsets are relative to it
+};
+
+// Checks the header and that every level lies inside the file
+std::optional<View> Parse(const uint8_t* data, size_t size);
+
+// Writes through a temporary file, so readers never see a half written one
+bool Write(const std::string& path, const TextureData& data, const SourceStamp& source);
+
+} // namespace Kosmic::Assets::TextureFile
@@ -2,27 +2,84 @@
 #include <SDL2/SDL.h>
 #include <memory>
 #include <string>
+#include <cstdint>
 
 namespace Kosmic {
 
+namespace Renderer { class Framebuffer; }
+
+class HeadlessContext;
+class FrameBenchmark;
+
+// Runtime options, usually filled from the command line
+struct ApplicationSettings {
+    bool headless{false};             // Render offscreen through EGL, no window
+    uint32_t benchmarkFrames{0};      // Measured frames before exiting (0 = run until quit)
+    uint32_t warmupFrames{0};         // Frames discarded before measuring
+    std::string benchmarkOutput{"benchmark.json"};
+    std::string traceOutput;          // Chrome trace of the measured frames (empty = off)
+    uint32_t workerThreads{0};        // Job system workers (0 = one per core minus the main thread)
+
+    float fixedTimestep{0.0f};        // Seconds per simulation step (0 = one variable step per frame)
+    uint32_t maxUpdateSteps{5};       // Catch-up cap per frame in fixed-step mode
+    uint32_t frameLimit{0};           // Frames per second cap (0 = unlimited)
+    int swapInterval{1};              // 0 = off, 1 = vsync, -1 = adaptive (falls back to vsync)
+    float assetUploadBudget{2.0f};    // Milliseconds of asset uploads per frame
+    uint32_t textureStreamBudget{4096}; // Kilobytes of texture data streamed per frame
+
+    // Parses --headless, --frames N, --warmup M, --output PATH, --trace PATH, --workers N,
+    // --tick-rate HZ, --max-steps N, --fps-limit N, --swap-interval N,
+    // --upload-budget MS and --texture-budget KB
+    static ApplicationSettings FromCommandLine(int argc, char** argv);
+};
+
 class Application {
 public:
-    Application(const std::string& title = "Kosmic Engine", int width = 800, int height = 600);
+    Application(const std::string& title = "Kosmic Engine", int width = 800, int height = 600,
+                const ApplicationSettings& settings = {});
     virtual ~Application();
 
     void Run();
-    
+
+    const ApplicationSettings& GetSettings() const { return m_Settings; }
+    bool IsHeadless() const { return m_Settings.headless; }
+
 protected:
     virtual void OnInit() = 0;
+    // Called with the fixed timestep when one is set, possibly several times a frame
     virtual void OnUpdate(float deltaTime) = 0;
-    virtual void OnRender() = 0;
+    // alpha in [0, 1) is how far the frame is between the last two simulation
+    // steps, for interpolating state. Always 1 without a fixed timestep.
+    virtual void OnRender(float alpha) = 0;
     virtual void OnCleanup() = 0;
 
 private:
+    bool InitWindow(const std::string& title);
+    bool InitHeadless();
+    bool InitGL();
+    void DrawProfilerWindow(float deltaTime);
+    void ApplySwapInterval();
+    void WaitForFrameLimit(uint64_t frameStart);
+
+    std::string m_Title;
+    ApplicationSettings m_Settings;
+    int m_Width, m_Height;
     bool m_Running;
+    bool m_Initialized;
     SDL_Window* m_Window;
     SDL_GLContext m_GLContext;
-    uint32_t m_LastFrameTime;
+    uint64_t m_LastFrameTime;         // SDL performance counter ticks
+    uint64_t m_TimerFrequency;
+    double m_Accumulator{0.0};        // Unsimulated time in fixed-step mode
+    uint32_t m_UpdateSteps{0};        // Simulation steps taken this frame
+
+    // Headless mode renders into this target instead of a window
+    std::unique_ptr<HeadlessContext> m_HeadlessContext;
+    std::shared_ptr<Renderer::Framebuffer> m_OffscreenTarget;
+    std::unique_ptr<FrameBenchmark> m_Benchmark;
+
+    // Frames left in a capture started from the Profiler window
+    uint32_t m_CaptureFramesLeft{0};
 };
 
-} // namespace Kosmic
\ No newline at end of file
+} // namespace Kosmic
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Kosmic {
+
+// Collects per-frame CPU/GPU times for the --frames/--warmup driver
+class FrameBenchmark {
+public:
+    struct Summary {
+        double min{0.0};
+        double median{0.0};
+        double p99{0.0};
+        double mean{0.0};
+        double max{0.0};
+    };
+
+    FrameBenchmark(uint32_t warmupFrames, uint32_t measuredFrames);
+
+    // Times are in milliseconds, keyed by frame index; warmup frames are discarded.
+    // GPU times arrive a few frames late, so both are recorded separately.
+    void RecordCPUTime(uint64_t frame, double ms);
+    void RecordGPUTime(uint64_t frame, double ms);
+    // Any other per-frame value (draw calls, triangles, ...), summarized and
+    // written under "counters"
+    void RecordCounter(const std::string& name, uint64_t frame, double value);
+
+    // True once every measured frame has its CPU time
+    bool IsComplete() const { return m_RecordedFrames >= m_MeasuredFrames; }
+
+    // Ignores missing (negative) samples
+    static Summary Summarize(std::vector<double> samples);
+
+    // Writes the summaries and the raw per-frame samples as JSON
+    bool WriteJSON(const std::string& path, const std::string& name) const;
+
+private:
+    uint32_t m_WarmupFrames;
+    uint32_t m_MeasuredFrames;
+    uint32_t m_RecordedFrames{0};
+    std::vector<double> m_CpuTimes;
+    std::vector<double> m_GpuTimes;
+    std::vector<std::pair<std::string, std::vector<double>>> m_Counters; // In the order first recorded
+};
+
+} // namespace Kosmic
@@ -0,0 +1,26 @@
+#pragma once
+#include <memory>
+
+namespace Kosmic {
+
+// OpenGL context without a window, created through EGL.
+// Prefers the Mesa surfaceless platform (works with llvmpipe on machines
+// without a display) and falls back to the default display with a pbuffer.
+class HeadlessContext {
+public:
+    ~HeadlessContext();
+
+    // Returns nullptr if no suitable context could be created
+    static std::unique_ptr<HeadlessContext> Create(int majorVersion, int minorVersion);
+
+    bool MakeCurrent() const;
+
+private:
+    HeadlessContext() = default;
+
+    void* m_Display = nullptr;
+    void* m_Context = nullptr;
+    void* m_Surface = nullptr; // Only used when surfaceless contexts are unsupported
+};
+
+} // namespace Kosmic
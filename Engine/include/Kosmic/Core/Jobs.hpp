@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace Kosmic::Jobs {
+
+using JobFunction = std::function<void()>;
+struct Job;
+struct Scheduler;
+
+// Completion counter for a group of jobs. Jobs scheduled with a counter
+// increment it and decrement it when they finish; other jobs can be made
+// to depend on it with RunAfter. Call Wait before destroying a counter.
+class Counter {
+public:
+    Counter() = default;
+    Counter(const Counter&) = delete;
+    Counter& operator=(const Counter&) = delete;
+
+    bool IsDone() const { return m_Pending.load(std::memory_order_acquire) == 0; }
+    uint32_t GetPending() const { return m_Pending.load(std::memory_order_acquire); }
+
+private:
+    friend struct Scheduler; // Jobs.cpp
+
+    std::atomic<uint32_t> m_Pending{0};
+    std::mutex m_Mutex;            // Guards m_Continuations
+    std::vector<Job*> m_Continuations;
+};
+
+// Starts one worker per core (minus the calling thread) when workerCount is 0.
+// The calling thread becomes thread 0 and executes jobs while it waits.
+void Init(uint32_t workerCount = 0);
+void Shutdown();
+bool IsInitialized();
+
+uint32_t GetWorkerCount();
+// 0 for the thread that called Init, 1..N for workers, UINT32_MAX otherwise
+uint32_t GetThreadIndex();
+
+// Schedules a job. Without workers it runs inline.
+void Run(JobFunction job, Counter* counter = nullptr);
+// Schedules a job once dependency reaches zero
+void RunAfter(Counter& dependency, JobFunction job, Counter* counter = nullptr);
+// Executes other jobs until the counter reaches zero
+void Wait(Counter& counter);
+
+// Splits [0, count) into chunks of grainSize and runs body(begin, end) on
+// them in parallel. Returns once every chunk is done.
+void ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& body);
+
+} // namespace Kosmic::Jobs
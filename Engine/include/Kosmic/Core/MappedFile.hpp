@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Kosmic {
+
+// Read-only memory mapping of a whole file. The pages are loaded by the OS
+// on first touch, so nothing is copied until the data is actually read.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path) { Open(path); }
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return m_Data != nullptr; }
+    const uint8_t* GetData() const { return m_Data; }
+    size_t GetSize() const { return m_Size; }
+
+private:
+    const uint8_t* m_Data{nullptr};
+    size_t m_Size{0};
+#ifdef _WIN32
+    void* m_File{nullptr};
+    void* m_Mapping{nullptr};
+#endif
+};
+
+} // namespace Kosmic
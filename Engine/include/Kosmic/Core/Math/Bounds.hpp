@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Kosmic/Core/Math/Math.hpp"
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace Kosmic::Math {
+
+// Axis-aligned bounding box
+struct AABB {
+    Vector3 min{ std::numeric_limits<float>::max(),  std::numeric_limits<float>::max(),  std::numeric_limits<float>::max()};
+    Vector3 max{-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max()};
+
+    bool IsValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+    Vector3 GetCenter() const { return (min + max) * 0.5f; }
+    Vector3 GetExtents() const { return (max - min) * 0.5f; }
+
+    void Expand(const Vector3& point) {
+        min = {std::min(min.x, point.x), std::min(min.y, point.y), std::min(min.z, point.z)};
+        max = {std::max(max.x, point.x), std::max(max.y, point.y), std::max(max.z, point.z)};
+    }
+
+    void Expand(const AABB& other) {
+        if (!other.IsValid()) return;
+        Expand(other.min);
+        Expand(other.max);
+    }
+
+    // Box around this box after transform, still axis aligned
+    AABB Transformed(const Mat4& transform) const {
+        Vector3 center = GetCenter(), extents = GetExtents();
+        AABB result;
+        for (int axis = 0; axis < 3; ++axis) {
+            float c = transform[3][axis] + transform[0][axis] * center.x + transform[1][axis] * center.y + transform[2][axis] * center.z;
+            float e = std::abs(transform[0][axis]) * extents.x + std::abs(transform[1][axis]) * extents.y + std::abs(transform[2][axis]) * extents.z;
+            (&result.min.x)[axis] = c - e;
+            (&result.max.x)[axis] = c + e;
+        }
+        return result;
+    }
+};
+
+struct BoundingSphere {
+    Vector3 center;
+    float radius{0.0f};
+
+    // Sphere enclosing this one after transform (scaled by the largest axis)
+    BoundingSphere Transformed(const Mat4& transform) const {
+        float sx = transform[0][0] * transform[0][0] + transform[0][1] * transform[0][1] + transform[0][2] * transform[0][2];
+        float sy = transform[1][0] * transform[1][0] + transform[1][1] * transform[1][1] + transform[1][2] * transform[1][2];
+        float sz = transform[2][0] * transform[2][0] + transform[2][1] * transform[2][1] + transform[2][2] * transform[2][2];
+        float scale = std::sqrt(std::max({sx, sy, sz}));
+        return {
+            {
+                transform[3][0] + transform[0][0] * center.x + transform[1][0] * center.y + transform[2][0] * center.z,
+                transform[3][1] + transform[0][1] * center.x + transform[1][1] * center.y + transform[2][1] * center.z,
+                transform[3][2] + transform[0][2] * center.x + transform[1][2] * center.y + transform[2][2] * center.z
+            },
+            radius * scale
+        };
+    }
+};
+
+// Six planes (xyz normal pointing inwards, w distance) of a view frustum
+struct Frustum {
+    enum Plane { Left, Right, Bottom, Top, Near, Far, Count };
+    std::array<Vector4, Count> planes;
+
+    // Gribb/Hartmann extraction from a view-projection matrix
+    static Frustum FromMatrix(const Mat4& viewProjection) {
+        auto row = [&](int i) {
+            return Vector4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+        };
+        Vector4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+
+        Frustum frustum;
+        frustum.planes = {r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2};
+        for (Vector4& plane : frustum.planes) {
+            float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+            if (length > 0.0f) plane = plane / length;
+        }
+        return frustum;
+    }
+
+    bool Intersects(const BoundingSphere& sphere) const {
+        for (const Vector4& plane : planes) {
+            float distance = plane.x * sphere.center.x + plane.y * sphere.center.y + plane.z * sphere.center.z + plane.w;
+            if (distance < -sphere.radius) return false;
+        }
+        return true;
+    }
+
+    bool Intersects(const AABB& box) const {
+        Vector3 center = box.GetCenter(), extents = box.GetExtents();
+        for (const Vector4& plane : planes) {
+            float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+            float radius = std::abs(plane.x) * extents.x + std::abs(plane.y) * extents.y + std::abs(plane.z) * extents.z;
+            if (distance < -radius) return false;
+        }
+        return true;
+    }
+};
+
+} // namespace Kosmic::Math
@@ -147,6 +147,11 @@ inline Vector3 Cross(const Vector3& a, const Vector3& b) {
     };
 }
 
+// Linear interpolation between two vectors
+inline Vector3 Lerp(const Vector3& a, const Vector3& b, float t) {
+    return a + (b - a) * t;
+}
+
 // Translate a matrix
 inline Mat4 Translate(const Mat4& matrix, const Vector3& translation) {
     return glm::translate(matrix, glm::vec3(translation.x, translation.y, translation.z));
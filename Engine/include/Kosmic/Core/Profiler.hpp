@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Kosmic::Profiler {
+
+// Time spent in one zone during the last frame, summed over all threads
+struct ZoneStats {
+    const char* name;
+    uint32_t depth;     // Shallowest nesting level the zone was seen at
+    uint32_t calls;
+    uint64_t totalTime; // ns
+};
+
+// Monotonic timestamp in nanoseconds
+uint64_t Now();
+
+// Names the calling thread in captures
+void SetThreadName(const char* name);
+
+// Drains every thread's event buffer and aggregates the zones of the frame.
+// Call once per frame from the main thread.
+void EndFrame();
+
+// Zones of the last frame, most expensive first
+const std::vector<ZoneStats>& GetFrameStats();
+// Duration of the last frame (between the last two EndFrame calls), ns
+uint64_t GetFrameTime();
+
+// Records every zone until EndCapture, which writes them as Chrome trace JSON
+// (open in chrome://tracing or ui.perfetto.dev)
+void BeginCapture();
+bool EndCapture(const std::string& path);
+bool IsCapturing();
+
+// RAII zone, prefer the KOSMIC_PROFILE_SCOPE macro.
+// The name must outlive the profiler (use string literals).
+class ScopedZone {
+public:
+    explicit ScopedZone(const char* name);
+    ~ScopedZone();
+
+    ScopedZone(const ScopedZone&) = delete;
+    ScopedZone& operator=(const ScopedZone&) = delete;
+
+private:
+    const char* m_Name;
+    uint64_t m_Start;
+};
+
+} // namespace Kosmic::Profiler
+
+// Profiling macros, compiled out unless KOSMIC_ENABLE_PROFILER is defined
+#ifdef KOSMIC_ENABLE_PROFILER
+#define KOSMIC_PROFILE_CONCAT_INNER(a, b) a##b
+#define KOSMIC_PROFILE_CONCAT(a, b) KOSMIC_PROFILE_CONCAT_INNER(a, b)
+#define KOSMIC_PROFILE_SCOPE(name) ::Kosmic::Profiler::ScopedZone KOSMIC_PROFILE_CONCAT(kosmicProfileZone, __LINE__)(name)
+#define KOSMIC_PROFILE_FUNCTION()  KOSMIC_PROFILE_SCOPE(__func__)
+#define KOSMIC_PROFILE_FRAME()     ::Kosmic::Profiler::EndFrame()
+#define KOSMIC_PROFILE_THREAD(name) ::Kosmic::Profiler::SetThreadName(name)
+#else
+#define KOSMIC_PROFILE_SCOPE(name)
+#define KOSMIC_PROFILE_FUNCTION()
+#define KOSMIC_PROFILE_FRAME()
+#define KOSMIC_PROFILE_THREAD(name)
+#endif
@@ -3,6 +3,9 @@
 
 #include "entt/entt.hpp"
 #include "Kosmic/Core/Math/Math.hpp"
+#include "Kosmic/Renderer/Mesh.hpp"
+#include "Kosmic/Assets/Material.hpp"
+#include <memory>
 
 namespace Kosmic {
   namespace ECS {
@@ -23,6 +26,28 @@ namespace Kosmic {
       Math::Vector3 scale;
       Transform() 
         : position{0.0f, 0.0f, 0.0f}, rotation{0.0f, 0.0f, 0.0f}, scale{1.0f, 1.0f, 1.0f} {}
+
+      // Model matrix: translation * rotation (Euler degrees, Z * Y * X) * scale
+      Math::Mat4 GetMatrix() const {
+        float cx = std::cos(Math::Deg2Rad(rotation.x)), sx = std::sin(Math::Deg2Rad(rotation.x));
+        float cy = std::cos(Math::Deg2Rad(rotation.y)), sy = std::sin(Math::Deg2Rad(rotation.y));
+        float cz = std::cos(Math::Deg2Rad(rotation.z)), sz = std::sin(Math::Deg2Rad(rotation.z));
+
+        Math::Mat4 m(1.0f);
+        m[0] = glm::vec4(cy * cz, cy * sz, -sy, 0.0f) * scale.x;
+        m[1] = glm::vec4(sx * sy * cz - cx * sz, sx * sy * sz + cx * cz, sx * cy, 0.0f) * scale.y;
+        m[2] = glm::vec4(cx * sy * cz + sx * sz, cx * sy * sz - sx * cz, cx * cy, 0.0f) * scale.z;
+        m[3] = glm::vec4(position.x, position.y, position.z, 1.0f);
+        return m;
+      }
+    };
+
+    // Draws the entity with its Transform. Entities sharing mesh and
+    // material are drawn together in one instanced call by RenderSystem.
+    struct MeshRenderer {
+      std::shared_ptr<Renderer::Mesh> mesh;
+      std::shared_ptr<Assets::Material> material;
+      Math::Vector4 color{1.0f, 1.0f, 1.0f, 1.0f}; // Multiplied with the material color
     };
 
   } // namespace ECS
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Kosmic/ECS/ECS.hpp"
+#include "Kosmic/Renderer/Mesh.hpp"
+#include "Kosmic/Renderer/Culling.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Kosmic::Renderer { class Renderer3D; }
+
+namespace Kosmic::ECS {
+
+// Draws every entity with a Transform and a MeshRenderer. Entities sharing
+// a mesh and material become one instanced draw, so the cost per entity is
+// building its matrix rather than a draw call.
+class RenderSystem {
+public:
+    // Gathers the entities and queues one instanced draw per mesh/material.
+    // Matrices are built and frustum culled in parallel on the job system
+    // (unless the renderer has culling off, or culls on the GPU). The
+    // instance data stays alive until the next Submit, so render the frame
+    // before that.
+    void Submit(entt::registry& registry, Renderer::Renderer3D& renderer);
+
+    uint32_t GetBatchCount() const { return static_cast<uint32_t>(m_Batches.size()); }
+    uint32_t GetInstanceCount() const { return static_cast<uint32_t>(m_Instances.size()); }
+    // Entities drawn / dropped by culling in the last Submit
+    uint32_t GetVisibleCount() const { return m_VisibleCount; }
+    uint32_t GetCulledCount() const { return m_CulledCount; }
+
+private:
+    struct Batch {
+        std::shared_ptr<Renderer::Mesh> mesh;
+        std::shared_ptr<Assets::Material> material;
+        uint32_t first{0};
+        uint32_t count{0};
+    };
+
+    using BatchKey = std::pair<const Renderer::Mesh*, const Assets::Material*>;
+    struct BatchKeyHash {
+        size_t operator()(const BatchKey& key) const {
+            size_t h = std::hash<const void*>{}(key.first);
+            return h ^ (std::hash<const void*>{}(key.second) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2));
+        }
+    };
+
+    // Kept between frames so steady scenes don't reallocate
+    std::vector<Batch> m_Batches;
+    std::unordered_map<BatchKey, uint32_t, BatchKeyHash> m_BatchLookup;
+    std::vector<entt::entity> m_Entities;
+    std::vector<uint32_t> m_Slots;        // Instance index of each entity in m_Entities
+    std::vector<Renderer::InstanceData> m_Instances;
+    Renderer::Culling::SphereList m_Spheres;   // World bounds, indexed like m_Instances
+    std::vector<uint8_t> m_Visibility;
+    uint32_t m_VisibleCount{0};
+    uint32_t m_CulledCount{0};
+};
+
+} // namespace Kosmic::ECS
@@ -1,5 +1,6 @@
 #pragma once
 #include "Kosmic/Core/Math/Math.hpp"
+#include "Kosmic/Core/Math/Bounds.hpp"
 
 namespace Kosmic::Renderer {
 
@@ -23,6 +24,12 @@ public:
     const Math::Mat4 GetViewMatrixNoTranslation() const;
     const Math::Vector3& GetPosition() const { return m_Position; }
     const Math::Vector3& GetFront() const { return m_Front; }
+    // World-space planes of the current view and projection
+    Math::Frustum GetFrustum() const;
+
+    float GetNearPlane() const { return m_NearPlane; }
+    float GetFarPlane() const { return m_FarPlane; }
+    bool IsOrthographic() const { return m_IsOrthographic; }
 
     float GetPitch() const;
     float GetYaw() const;
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Kosmic/Core/Math/Bounds.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace Kosmic::Renderer::Culling {
+
+// Bounding spheres in structure-of-arrays layout, so the kernels can load
+// several centers and radii with one instruction each
+struct SphereList {
+    std::vector<float> x, y, z, radius;
+
+    void Clear() { x.clear(); y.clear(); z.clear(); radius.clear(); }
+    void Resize(size_t count) { x.resize(count); y.resize(count); z.resize(count); radius.resize(count); }
+    uint32_t Size() const { return static_cast<uint32_t>(x.size()); }
+
+    void Push(const Math::BoundingSphere& sphere) {
+        x.push_back(sphere.center.x);
+        y.push_back(sphere.center.y);
+        z.push_back(sphere.center.z);
+        radius.push_back(sphere.radius);
+    }
+
+    void Set(size_t index, const Math::BoundingSphere& sphere) {
+        x[index] = sphere.center.x;
+        y[index] = sphere.center.y;
+        z[index] = sphere.center.z;
+        radius[index] = sphere.radius;
+    }
+};
+
+// Tests spheres [begin, end) against the frustum and writes 1 (visible) or
+// 0 to visible[i] for each of them. Returns how many are visible. Disjoint
+// ranges may run on different threads.
+uint32_t CullSpheres(const Math::Frustum& frustum, const SphereList& spheres,
+                     uint32_t begin, uint32_t end, uint8_t* visible);
+
+// Kernel compiled in: "AVX", "SSE" or "Scalar"
+const char* GetKernelName();
+
+} // namespace Kosmic::Renderer::Culling
@@ -1,17 +1,77 @@
 #pragma once
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 
 namespace Kosmic::Renderer {
 
+enum class FramebufferFormat : uint8_t {
+    None,
+    // Color
+    RGBA8,
+    RGBA16F,
+    R11G11B10F,     // HDR color in 4 bytes, no alpha
+    // Depth
+    Depth24Stencil8,
+    Depth32F
+};
+
+bool IsDepthFormat(FramebufferFormat format);
+// Bytes per pixel per sample
+uint32_t GetFramebufferFormatSize(FramebufferFormat format);
+
+struct FramebufferSpecification {
+    static constexpr uint32_t MaxColorAttachments = 4;
+
+    uint32_t width{0};
+    uint32_t height{0};
+    // Attachment i is GL_COLOR_ATTACHMENT0 + i; the list ends at the first None
+    std::array<FramebufferFormat, MaxColorAttachments> colorAttachments{FramebufferFormat::RGBA8};
+    FramebufferFormat depthAttachment{FramebufferFormat::Depth24Stencil8};
+    // A texture that can be sampled, instead of a renderbuffer
+    bool depthTexture{false};
+    // Above 1 the framebuffer renders into multisampled renderbuffers and
+    // Resolve copies them into the textures
+    uint32_t samples{1};
+
+    uint32_t GetColorAttachmentCount() const;
+    // Same attachments and sample count, whatever the size
+    bool IsCompatible(const FramebufferSpecification& other) const;
+    // Video memory for the given size, resolve targets included
+    size_t GetSize(uint32_t width, uint32_t height) const;
+    bool operator==(const FramebufferSpecification&) const = default;
+};
+
 class Framebuffer {
 public:
     virtual ~Framebuffer() = default;
     virtual void Bind() const = 0;
     virtual void Unbind() const = 0;
+    // Only reallocates when growing past the allocated size or shrinking to
+    // well below it. In between the textures keep their size and only
+    // GetWidth/GetHeight change, so sample them with UVs scaled by
+    // GetWidth() / GetAllocatedWidth() (and likewise for height).
     virtual void Resize(uint32_t width, uint32_t height) = 0;
-    
-    static std::shared_ptr<Framebuffer> Create(uint32_t width, uint32_t height);
+    // Multisampled attachments -> textures through glBlitFramebuffer. Does
+    // nothing without MSAA.
+    virtual void Resolve() const = 0;
+
+    virtual uint32_t GetID() const = 0;
+    // Textures to sample, resolved ones when multisampled. The depth texture
+    // is 0 unless the specification asks for one.
+    virtual uint32_t GetColorAttachment(uint32_t index = 0) const = 0;
+    virtual uint32_t GetDepthAttachment() const = 0;
+    virtual uint32_t GetWidth() const = 0;
+    virtual uint32_t GetHeight() const = 0;
+    virtual uint32_t GetAllocatedWidth() const = 0;
+    virtual uint32_t GetAllocatedHeight() const = 0;
+    virtual const FramebufferSpecification& GetSpecification() const = 0;
+
+    static std::shared_ptr<Framebuffer> Create(const FramebufferSpecification& specification);
+    // One color attachment and a D24S8 renderbuffer
+    static std::shared_ptr<Framebuffer> Create(uint32_t width, uint32_t height,
+                                               FramebufferFormat format = FramebufferFormat::RGBA8);
 };
 
 } // namespace Kosmic::Renderer
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "Kosmic/Core/Math/Bounds.hpp"
+#include "Kosmic/Renderer/Mesh.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Kosmic::Assets { class Material; }
+
+namespace Kosmic::Renderer {
+
+class Shader;
+
+// Counts from the latest readback, a few frames old
+struct GPUCullingStats {
+    uint32_t batches{0};          // Of the frame being drawn
+    uint32_t instances{0};        // Of the frame being drawn
+    uint32_t tested{0};           // The rest are from the readback
+    uint32_t frustumCulled{0};
+    uint32_t occluded{0};
+    uint32_t visible{0};
+    uint32_t latency{0};          // Frames between dispatch and readback
+};
+
+// Instanced draws culled and compacted on the GPU (GL 4.3). Per frame:
+//   - The instances of every batch (one mesh and material) go to one storage
+//     buffer, the batches' local bounding spheres to another.
+//   - cull.comp tests each instance's sphere against the frustum and against
+//     a depth pyramid of the previous frame, then appends the survivors'
+//     indices to their batch's range and counts them in its draw command.
+//   - Batches sharing a VAO and material go out as one
+//     glMultiDrawElementsIndirect; culled.vert reads the instance index as a
+//     divisor-1 attribute, which the command's base instance offsets.
+//   - After the scene, the depth buffer is copied and reduced into the
+//     pyramid (farthest depth per texel) for the next frame's test.
+// Nothing is read back on the draw path. The counters are copied to a ring
+// of buffers behind fences and read once the GPU is done with them.
+//
+// The occlusion test uses last frame's depth and view, so something that
+// comes out from behind an occluder quickly can show up a frame late.
+class GPUCulling {
+public:
+    // Readback buffers in flight
+    static constexpr uint32_t ReadbackSlots = 3;
+
+    GPUCulling() = default;
+    ~GPUCulling();
+
+    GPUCulling(const GPUCulling&) = delete;
+    GPUCulling& operator=(const GPUCulling&) = delete;
+
+    // GL 4.3 with storage buffers in vertex shaders (true on llvmpipe).
+    // Needs a current context.
+    static bool IsSupported();
+
+    // Queues an instanced draw; the instance array must stay alive until Cull
+    void Submit(Mesh& mesh, const Assets::Material* material, const InstanceData* instances, uint32_t count);
+    bool HasBatches() const { return !m_Batches.empty(); }
+
+    // Uploads the frame's instances and culls them
+    void Cull(const Math::Frustum& frustum);
+    // Draws what Cull kept, with the culled instance shader
+    void Draw();
+    // Builds the depth pyramid from the depth buffer of the bound framebuffer,
+    // for the next Cull. viewProjection is the view it was rendered with.
+    void UpdateDepthPyramid(const Math::Mat4& viewProjection);
+    void Clear();
+
+    const GPUCullingStats& GetStats() const { return m_Stats; }
+
+private:
+    // Same layouts as cull.comp
+    struct BatchData {
+        Math::Vector4 sphere;
+        uint32_t first;
+        uint32_t count;
+        uint32_t command;
+        uint32_t padding;
+    };
+    struct DrawCommand {
+        uint32_t indexCount;
+        uint32_t instanceCount;
+        uint32_t firstIndex;
+        int32_t baseVertex;
+        uint32_t baseInstance;
+    };
+
+    struct Batch {
+        Mesh* mesh;
+        const Assets::Material* material;
+        const InstanceData* instances;
+        uint32_t count;
+    };
+
+    struct Readback {
+        uint32_t buffer{0};
+        void* fence{nullptr};   // GLsync
+        uint32_t frame{0};
+    };
+
+    void CreateResources();
+    // Resizes the buffer to hold bytes, growing with some headroom
+    static void Reserve(uint32_t target, uint32_t buffer, size_t bytes, size_t& capacity);
+    // Depth format of the bound framebuffer, 0 without a depth buffer
+    static uint32_t GetDepthFormat(uint32_t framebuffer);
+    void ResizeDepthPyramid(uint32_t format, uint32_t width, uint32_t height);
+    void CollectReadbacks();
+
+    std::vector<Batch> m_Batches;
+    std::vector<BatchData> m_BatchData;
+    std::vector<DrawCommand> m_Commands;
+    std::vector<uint32_t> m_DrawOrder;          // Batch of each command
+    uint32_t m_InstanceCount{0};
+
+    std::shared_ptr<Shader> m_CullShader;
+    std::shared_ptr<Shader> m_PyramidShader;
+    std::shared_ptr<Shader> m_DrawShader;
+
+    uint32_t m_InstanceBuffer{0};
+    uint32_t m_BatchBuffer{0};
+    uint32_t m_CommandBuffer{0};
+    uint32_t m_VisibleBuffer{0};
+    uint32_t m_CounterBuffer{0};
+    size_t m_InstanceCapacity{0};
+    size_t m_BatchCapacity{0};
+    size_t m_CommandCapacity{0};
+    size_t m_VisibleCapacity{0};
+
+    Readback m_Readbacks[ReadbackSlots];
+    uint32_t m_Frame{0};
+    uint32_t m_ReadFrame{0};    // Frame of the counters in m_Stats
+
+    // Depth copy (matching the bound depth format) and the R32F pyramid,
+    // whose level 0 is the largest power of two under half the viewport
+    uint32_t m_DepthTexture{0};
+    uint32_t m_DepthFramebuffer{0};
+    uint32_t m_DepthFormat{0};
+    uint32_t m_SourceFramebuffer{UINT32_MAX};  // Whose depth format m_DepthFormat is
+    uint32_t m_PyramidTexture{0};
+    uint32_t m_Width{0}, m_Height{0};
+    uint32_t m_PyramidLevels{0};
+    bool m_HasPyramid{false};
+    bool m_PyramidFailed{false};
+    Math::Mat4 m_PyramidViewProjection{1.0f};
+
+    GPUCullingStats m_Stats;
+};
+
+} // namespace Kosmic::Renderer
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Kosmic::Renderer {
+
+// Timing of one named GPU scope (nanoseconds)
+struct GPUTiming {
+    std::string name;
+    uint32_t depth{0};
+    uint64_t time{0};
+};
+
+// All scopes of one finished frame
+struct GPUFrameTimings {
+    uint64_t frameIndex{0};
+    uint64_t frameTime{0};
+    std::vector<GPUTiming> scopes;
+};
+
+// Non-blocking GPU timer.
+// Every frame writes GL_TIMESTAMP queries into its own slot of a ring that is
+// FramesInFlight deep. Slots are read back only once GL_QUERY_RESULT_AVAILABLE
+// reports them ready, so the CPU never waits for the GPU. If the GPU falls so
+// far behind that the next slot is still pending, that frame is not timed.
+class GPUProfiler {
+public:
+    static constexpr uint32_t FramesInFlight = 4;
+    static constexpr uint32_t MaxScopesPerFrame = 64;
+
+    static void Init();
+    static void Shutdown();
+
+    // Returns the index of the frame being recorded
+    static uint64_t BeginFrame();
+    static void EndFrame();
+
+    // Scopes may nest; each one costs two timestamp queries
+    static void BeginScope(const char* name);
+    static void EndScope();
+
+    // Results of the most recently resolved frame (a few frames old)
+    static const GPUFrameTimings& GetLatest();
+
+    // Invoked for every frame as soon as its results are resolved
+    static void SetResolveCallback(std::function<void(const GPUFrameTimings&)> callback);
+
+    // Blocks until all pending frames are resolved (use only at shutdown/benchmark end)
+    static void Flush();
+};
+
+// Times the enclosing block on the GPU
+class GPUScope {
+public:
+    explicit GPUScope(const char* name) { GPUProfiler::BeginScope(name); }
+    ~GPUScope() { GPUProfiler::EndScope(); }
+
+    GPUScope(const GPUScope&) = delete;
+    GPUScope& operator=(const GPUScope&) = delete;
+};
+
+} // namespace Kosmic::Renderer
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Kosmic/Renderer/VertexLayout.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace Kosmic::Renderer {
+
+enum class IndexType : uint32_t;
+
+// Where a mesh lives inside the pool
+struct GeometryAllocation {
+    uint32_t page{UINT32_MAX};
+    uint32_t baseVertex{0};     // In vertices of the page's layout
+    uint32_t firstIndex{0};     // In indices of the page's index type
+    uint32_t vertexCount{0};
+    uint32_t indexCount{0};
+
+    bool IsValid() const { return page != UINT32_MAX; }
+};
+
+struct GeometryPoolStats {
+    uint32_t pages{0};
+    uint32_t allocations{0};
+    size_t usedBytes{0};        // Vertex and index data of live allocations
+    size_t capacityBytes{0};    // Everything the pages have reserved
+};
+
+// Sub-allocates static meshes out of a few large vertex and index buffers,
+// one set per vertex layout and index type, each behind a single VAO. Meshes
+// in the same page draw without rebinding anything, which is what lets the
+// render queue merge them into one glMultiDrawElementsIndirect.
+//
+// Page VAOs also carry the instance attributes (locations 4-8, from one
+// buffer per page) and the draw ID (location 9, divisor 1) that pooled.vert
+// uses to find its per-draw data.
+class GeometryPool {
+public:
+    static constexpr size_t VertexPageSize = 32 * 1024 * 1024;
+    static constexpr size_t IndexPageSize = 16 * 1024 * 1024;
+    // Draw IDs one multi-draw can address through its base instances
+    static constexpr uint32_t MaxDrawIDs = 65536;
+
+    // Meshes created while disabled get their own buffers; on by default
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled();
+    // Multi-draw indirect where GL 4.3 or ARB_multi_draw_indirect is there,
+    // otherwise one glDrawElementsBaseVertex per draw; on by default
+    static void SetMultiDrawIndirect(bool enabled);
+    static bool UseMultiDrawIndirect();
+
+    // Copies the mesh into a page. Invalid when disabled, or when the mesh
+    // would not fit in an empty page.
+    static GeometryAllocation Allocate(const VertexLayout& layout, IndexType indexType, const void* vertices,
+                                       uint32_t vertexCount, const void* indices, uint32_t indexCount);
+    static void Free(const GeometryAllocation& allocation);
+
+    static uint32_t GetVAO(uint32_t page);
+    static uint32_t GetInstanceBuffer(uint32_t page);
+
+    static GeometryPoolStats GetStats();
+    // Deletes every page; allocations still held are ignored when freed
+    static void Shutdown();
+};
+
+} // namespace Kosmic::Renderer
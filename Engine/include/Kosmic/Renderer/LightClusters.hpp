@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Kosmic/Core/Math/Math.hpp"
+#include "Kosmic/Renderer/Culling.hpp"
+#include "Kosmic/Renderer/Lighting.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace Kosmic::Renderer {
+
+class Camera;
+
+// Counts of the last Build
+struct LightClusterStats {
+    uint32_t lights{0};           // Submitted
+    uint32_t visibleLights{0};    // Inside the frustum, the ones uploaded
+    uint32_t lightIndices{0};     // Cluster list entries, summed over clusters
+    uint32_t maxClusterLights{0}; // Longest cluster list
+    uint32_t droppedIndices{0};   // Over MaxLightsPerCluster or the texture buffer size
+};
+
+// Point and spot lights sorted into a grid of view-space clusters: screen
+// tiles, cut into depth slices that grow exponentially with distance. The
+// fragment shader finds its cluster from gl_FragCoord and its view depth
+// and only loops over the lights in that cluster's list (see basic.frag).
+//
+// Build runs on the CPU: lights are frustum culled with the SIMD kernels
+// in Culling.hpp, then every depth slice is filled on its own job. The
+// results go to three texture buffers, since GL 3.3 has no storage buffers:
+//   u_ClusterLights  RG32UI, per cluster: first index and light count
+//   u_LightIndices   R16UI, the cluster lists one after another
+//   u_LightData      RGBA32F, three texels per light: world position and
+//                    range, color * intensity and cos(cutoff), direction and
+//                    cos(outerCutoff)
+// Shaders get these samplers on TextureUnit::ClusterLights etc at link time.
+class LightClusters {
+public:
+    static constexpr uint32_t TilesX = 16;
+    static constexpr uint32_t TilesY = 9;
+    static constexpr uint32_t Slices = 24;
+    static constexpr uint32_t ClusterCount = TilesX * TilesY * Slices;
+    // Light indices are 16-bit
+    static constexpr uint32_t MaxLights = 65535;
+    static constexpr uint32_t MaxLightsPerCluster = 256;
+
+    LightClusters() = default;
+    ~LightClusters();
+
+    LightClusters(const LightClusters&) = delete;
+    LightClusters& operator=(const LightClusters&) = delete;
+
+    // Lights for the next Build, dropped past MaxLights
+    void AddPointLight(const Lighting::PointLight& light);
+    void AddSpotLight(const Lighting::SpotLight& light);
+    void Clear();
+
+    // Assigns the lights to the clusters of the camera's view and uploads
+    // the lists. width and height are the viewport's, in pixels.
+    void Build(const Camera& camera, uint32_t width, uint32_t height);
+    // Binds the three texture buffers to their units
+    void Bind() const;
+
+    // For the Lighting block: x and y turn log(view depth) into a slice,
+    // z and w turn gl_FragCoord.xy into a tile
+    const Math::Vector4& GetClusterScale() const { return m_ClusterScale; }
+
+    uint32_t GetLightCount() const { return static_cast<uint32_t>(m_Lights.size()); }
+    const LightClusterStats& GetStats() const { return m_Stats; }
+
+private:
+    // Three RGBA32F texels, as the shader reads them
+    struct LightData {
+        Math::Vector4 positionRange;
+        Math::Vector4 colorCutoff;
+        Math::Vector4 directionOuterCutoff;
+    };
+
+    // A visible light overlapping a depth slice, and the tiles it covers there
+    struct SliceHit {
+        uint16_t light;
+        uint8_t x0, x1, y0, y1;
+    };
+
+    // One slice's lists, filled by its own job
+    struct Slice {
+        std::vector<SliceHit> hits;
+        std::vector<uint32_t> offsets;   // Per tile, into indices
+        std::vector<uint32_t> counts;
+        std::vector<uint16_t> indices;
+        uint32_t dropped{0};
+    };
+
+    void CreateBuffers();
+    void BuildSlice(uint32_t slice);
+
+    std::vector<LightData> m_Lights;
+
+    // Visible lights in view space, structure-of-arrays for the slice test
+    Culling::SphereList m_Spheres;
+    std::vector<uint8_t> m_Visibility;
+    std::vector<float> m_ViewX, m_ViewY, m_DepthMin, m_DepthMax, m_Radius;
+    std::vector<LightData> m_Upload;
+
+    // View of the current Build
+    Math::Vector4 m_ClusterScale;
+    float m_SliceDepths[Slices + 1]{};
+    float m_NearPlane{0.1f};
+    float m_ProjectionX{1.0f}, m_ProjectionY{1.0f};  // Clip-space scale
+    float m_OffsetX{0.0f}, m_OffsetY{0.0f};          // Off-center projections
+    bool m_Orthographic{false};
+
+    Slice m_Slices[Slices];
+    std::vector<uint32_t> m_ClusterData;   // Offset and count per cluster
+    std::vector<uint16_t> m_Indices;
+    LightClusterStats m_Stats;
+
+    uint32_t m_MaxIndices{0};
+    uint32_t m_MaxLights{0};
+    uint32_t m_UploadedLights{UINT32_MAX};  // Lights in the buffers, UINT32_MAX before the first upload
+    bool m_WarnedDropped{false};
+    uint32_t m_ClusterBuffer{0};
+    uint32_t m_ClusterTexture{0};
+    uint32_t m_IndexBuffer{0};
+    uint32_t m_IndexTexture{0};
+    uint32_t m_LightBuffer{0};
+    uint32_t m_LightTexture{0};
+};
+
+} // namespace Kosmic::Renderer
@@ -17,7 +17,7 @@ struct DirectionalLight {
     float intensity;
 };
 
-// Point light structure
+// Point light structure. Falls off to zero at range.
 struct PointLight {
     Math::Vector3 position;
     Math::Vector3 color;
@@ -25,12 +25,14 @@ struct PointLight {
     float range;
 };
 
-// Spot light structure
+// Spot light structure. The cutoffs are cosines of the cone's half-angles:
+// full intensity inside cutoff, fading to zero at outerCutoff.
 struct SpotLight {
     Math::Vector3 position;
     Math::Vector3 direction;
     Math::Vector3 color;
     float intensity;
+    float range;
     float cutoff;
     float outerCutoff;
 };
@@ -1,40 +1,101 @@
 #pragma once
 
 #include "Kosmic/Core/Math/Math.hpp"
+#include "Kosmic/Core/Math/Bounds.hpp"
+#include "Kosmic/Renderer/VertexLayout.hpp"
+#include "Kosmic/Renderer/GeometryPool.hpp"
 #include <vector>
 #include <memory>
 
 namespace Kosmic::Renderer {
 
-struct Vertex {
-    Math::Vector3 Position;
-    Math::Vector3 Normal;
-    Math::Vector2 TexCoords;
-    Math::Vector3 Color;
+// Index width; the value is the size in bytes
+enum class IndexType : uint32_t {
+    UInt16 = 2,
+    UInt32 = 4
 };
 
+// Per-instance attributes of instanced draws (locations 4-7 and 8)
+struct InstanceData {
+    Math::Mat4 transform;
+    Math::Vector4 color{1.0f, 1.0f, 1.0f, 1.0f};
+};
+
+// Points locations 4-8 of the bound VAO at InstanceData in the bound array buffer
+void ApplyInstanceAttributes();
+
 class Mesh {
 public:
+    // Indices are stored as 16 bit when every vertex fits. Vertices are packed
+    // into VertexLayout::Choose unless a layout is given.
     Mesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+    Mesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const VertexLayout& layout);
+    // Uploads the arrays as they are (e.g. straight out of a mapped file) with
+    // precomputed bounds, so nothing is touched per vertex. Vertices are
+    // already packed in the given layout.
+    //
+    // Either way the data goes into the GeometryPool when it is enabled, and
+    // into buffers of the mesh's own otherwise.
+    Mesh(const void* vertices, uint32_t vertexCount, const VertexLayout& layout, const void* indices,
+         uint32_t indexCount, IndexType indexType, const Math::AABB& bounds, const Math::BoundingSphere& boundingSphere);
     ~Mesh();
 
+    // Binds the VAO, which pooled meshes share with the rest of their page.
+    // Draws leave it bound, see StateManager.
     void Bind() const;
     void Unbind() const;
     void Draw() const;
 
+    // Uploads the per-instance attributes used by DrawInstanced. The buffer
+    // is created on first use, so meshes that are never instanced pay nothing;
+    // pooled meshes use the one of their page.
+    void SetInstanceData(const InstanceData* instances, uint32_t count);
+    void DrawInstanced(uint32_t instanceCount) const;
+
     // Add transform support
     void SetTransform(const Math::Mat4& transform);
 
     const Math::Mat4& GetTransform() const;
 
+    // Unique per mesh, used for sorting draws
+    uint32_t GetID() const { return m_ID; }
+    uint32_t GetIndexCount() const { return m_IndexCount; }
+    IndexType GetIndexType() const { return m_IndexType; }
+    // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, for glDrawElements*
+    uint32_t GetGLIndexType() const;
+    const VertexLayout& GetLayout() const { return m_Layout; }
+    uint32_t GetVAO() const { return m_VAO; }
+
+    // Pool placement; both offsets are 0 for meshes with their own buffers.
+    // Draws need glDrawElementsBaseVertex with these.
+    bool IsPooled() const { return m_Allocation.IsValid(); }
+    uint32_t GetBaseVertex() const { return m_Allocation.baseVertex; }
+    uint32_t GetFirstIndex() const { return m_Allocation.firstIndex; }
+    uint32_t GetVertexCount() const { return m_VertexCount; }
+
+    // Local-space bounds, computed when the mesh is built
+    const Math::AABB& GetBounds() const { return m_Bounds; }
+    const Math::BoundingSphere& GetBoundingSphere() const { return m_BoundingSphere; }
+
+    // Tight box and a sphere around its center covering every vertex
+    static void ComputeBounds(const Vertex* vertices, uint32_t vertexCount,
+                              Math::AABB& bounds, Math::BoundingSphere& boundingSphere);
+
 private:
-    void SetupMesh();
+    void SetupMesh(const void* vertices, const void* indices);
 
-    uint32_t m_VAO, m_VBO, m_EBO;
-    std::vector<Vertex> m_Vertices;
-    std::vector<uint32_t> m_Indices;
+    uint32_t m_ID;
+    uint32_t m_VAO{0}, m_VBO{0}, m_EBO{0};
+    uint32_t m_InstanceVBO{0};
+    uint32_t m_VertexCount;
+    uint32_t m_IndexCount;
+    IndexType m_IndexType{IndexType::UInt32};
+    VertexLayout m_Layout;
+    GeometryAllocation m_Allocation;
 
     Math::Mat4 m_Transform{1.0f}; // Identity matrix
+    Math::AABB m_Bounds;
+    Math::BoundingSphere m_BoundingSphere;
 };
 
 } // namespace Kosmic::Renderer
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Kosmic/Core/Math/Bounds.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace Kosmic::Renderer {
+
+// Occluder geometry: a closed, low-poly stand-in for something large and
+// solid. It should not stick out of what it stands for, anything behind it
+// gets culled.
+struct OccluderMesh {
+    std::vector<Math::Vector3> positions;
+    std::vector<uint32_t> indices;  // Counter-clockwise triangles, seen from outside
+
+    static OccluderMesh Box(const Math::AABB& box);
+};
+
+// Counts and CPU cost of the last frame
+struct OcclusionStats {
+    uint32_t occluders{0};
+    uint32_t triangles{0};    // Front-facing occluder triangles rasterized
+    uint32_t tested{0};       // Boxes tested
+    uint32_t occluded{0};     // Of which hidden
+    double rasterTime{0.0};   // Milliseconds for setup, rasterization and the hierarchy
+    double testTime{0.0};     // Milliseconds of box tests
+};
+
+// CPU occlusion culling. Occluders are rasterized into a small depth buffer
+// (depth in [0, 1], nearest kept), which is then reduced into a hierarchy of
+// max-depth levels. A box is hidden when its nearest point is farther than
+// the farthest occluder depth everywhere it covers on screen; the test picks
+// the level where that is a handful of texels.
+//
+// The screen is cut into tiles, each cleared, rasterized and reduced on its
+// own job. Spans are filled 8 (AVX) or 4 (SSE) pixels at a time. Triangles
+// crossing the near plane are skipped, which only costs culling.
+class OcclusionCuller {
+public:
+    static constexpr uint32_t Width = 256;
+    static constexpr uint32_t Height = 128;
+    static constexpr uint32_t TileWidth = 64;
+    static constexpr uint32_t TileHeight = 32;
+    static constexpr uint32_t TilesX = Width / TileWidth;
+    static constexpr uint32_t TilesY = Height / TileHeight;
+    // Levels down to 1x1, level 0 being the depth buffer itself
+    static constexpr uint32_t LevelCount = std::bit_width(std::max(Width, Height));
+
+    OcclusionCuller();
+
+    // Occluder for the next Render; the mesh must stay alive until then
+    void AddOccluder(const OccluderMesh& mesh, const Math::Mat4& transform);
+    // Rasterizes the occluders as seen through viewProjection and builds the
+    // hierarchy, then forgets them. With none, nothing counts as occluded.
+    void Render(const Math::Mat4& viewProjection);
+    bool HasOccluders() const { return m_Stats.occluders > 0; }
+
+    // True when the world-space box is certainly hidden. Safe to call from
+    // several threads between Renders.
+    bool IsOccluded(const Math::AABB& box) const;
+    // Tests count boxes, writing 1 (visible) or 0 to visible[i], on the job
+    // system. Returns how many are visible and adds to the stats, these and
+    // RenderStats.
+    uint32_t Cull(const Math::AABB* boxes, uint32_t count, uint8_t* visible);
+
+    const OcclusionStats& GetStats() const { return m_Stats; }
+    // Level 0, row by row from the bottom of the screen
+    const float* GetDepthBuffer() const { return m_Levels[0].data(); }
+
+    // Kernel compiled in: "AVX", "SSE" or "Scalar"
+    static const char* GetKernelName();
+
+private:
+    // Screen-space triangle: edge functions a * x + b * y + c, positive
+    // inside, and the depth plane
+    struct Triangle {
+        float a[3], b[3], c[3];
+        float depthX, depthY, depthC;
+        int32_t minX, minY, maxX, maxY; // Pixels, max exclusive
+    };
+
+    struct Occluder {
+        const OccluderMesh* mesh;
+        Math::Mat4 transform;
+    };
+
+    void SetupTriangles(const Occluder& occluder);
+    void RenderTile(uint32_t tile);
+
+    std::vector<Occluder> m_Occluders;
+    std::vector<Triangle> m_Triangles;
+    std::vector<uint32_t> m_Bins[TilesX * TilesY];  // Triangles touching each tile
+    std::vector<glm::vec4> m_Clip;                  // Scratch for transformed vertices
+
+    std::vector<float> m_Levels[LevelCount];
+    Math::Mat4 m_ViewProjection{1.0f};
+    OcclusionStats m_Stats;
+};
+
+} // namespace Kosmic::Renderer
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Kosmic/Core/Math/Bounds.hpp"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace Kosmic::Renderer {
+
+class Mesh;
+class Shader;
+
+// Counts of the last frame
+struct OcclusionQueryStats {
+    uint32_t tested{0};       // Draws classified
+    uint32_t hidden{0};       // Skipped, their last query found them hidden
+    uint32_t conditional{0};  // Drawn under conditional rendering, waiting on a query
+    uint32_t issued{0};       // Queries issued
+    uint32_t inFlight{0};     // Queries without a result at the start of the frame
+};
+
+// Hardware occlusion queries with temporal coherence, after CHC++: every
+// draw keeps its visibility from the last query result that came back, and
+// the CPU never waits for one.
+//   - Visible draws are drawn, and re-queried every VisibleInterval frames
+//     (staggered, so the queries spread over frames).
+//   - Hidden draws are skipped and queried every frame, so they come back
+//     one frame after they become visible.
+//   - Draws whose query is still in flight are drawn inside
+//     glBeginConditionalRender(GL_QUERY_NO_WAIT), the GPU skips them if the
+//     result is in by then.
+// Queries draw the world-space box of the draw against the depth buffer of
+// the opaque scene, with GL_ANY_SAMPLES_PASSED.
+//
+// Draws are told apart by their submission order, so a scene that submits
+// the same things in the same order every frame keeps its history. A slot
+// whose mesh changed, or that was outside the frustum last frame, starts
+// over as visible.
+class OcclusionQueries {
+public:
+    static constexpr uint32_t VisibleInterval = 8;
+
+    enum class Visibility : uint8_t {
+        Visible,
+        Conditional,  // Draw under GetCondition
+        Hidden
+    };
+
+    OcclusionQueries() = default;
+    ~OcclusionQueries();
+
+    OcclusionQueries(const OcclusionQueries&) = delete;
+    OcclusionQueries& operator=(const OcclusionQueries&) = delete;
+
+    // Collects the results that came back, without waiting. cameraPosition
+    // and nearPlane tell which boxes the camera is too close to query.
+    void BeginFrame(const Math::Vector3& cameraPosition, float nearPlane);
+    // Visibility of the draw in submission slot object this frame; schedules
+    // its query when one is due
+    Visibility Classify(uint32_t object, uint32_t meshID, const Math::AABB& box);
+    // Query a Conditional draw is drawn under
+    uint32_t GetCondition(uint32_t object) const { return m_Objects[object].query; }
+    // Draws the boxes of this frame's queries. Needs the opaque scene in the
+    // bound depth buffer and the Camera uniform block uploaded.
+    void IssueQueries();
+    // Forgets every draw's history, for when the scene changes completely
+    void Reset();
+
+    const OcclusionQueryStats& GetStats() const { return m_Stats; }
+
+private:
+    struct Object {
+        uint32_t meshID{0};
+        uint32_t query{0};      // In flight, 0 if none
+        uint32_t lastFrame{0};  // Last frame it was classified
+        uint32_t nextCheck{0};  // Frame a visible draw is queried again
+        bool visible{true};
+    };
+
+    struct Pending {
+        uint32_t object;
+        uint32_t query;
+    };
+
+    struct Test {
+        uint32_t object;
+        Math::AABB box;
+    };
+
+    uint32_t AcquireQuery();
+
+    std::vector<Object> m_Objects;
+    std::deque<Pending> m_Pending;   // Issue order, which is also completion order
+    std::vector<uint32_t> m_FreeQueries;
+    std::vector<Test> m_Tests;       // Queries to issue this frame
+
+    std::shared_ptr<Shader> m_Shader;
+    std::shared_ptr<Mesh> m_Box;
+    Math::Vector3 m_CameraPosition;
+    float m_NearPlane{0.1f};
+    uint32_t m_Frame{1};
+    OcclusionQueryStats m_Stats;
+};
+
+} // namespace Kosmic::Renderer
@@ -1,33 +1,169 @@
 #pragma once
 
-#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Framebuffer.hpp"
+#include "GPUProfiler.hpp"
+#include "RenderTargetPool.hpp"
 
 namespace Kosmic::Renderer {
 
+// Size and attachments of a transient render target. Targets with the
+// same attachments share a framebuffer when their lifetimes don't overlap.
+using RenderTargetDesc = FramebufferSpecification;
+
+enum class LoadOp : uint8_t {
+    Load,   // Keep what earlier passes drew
+    Clear   // Color, depth and stencil cleared before the pass
+};
+
+class RenderGraph;
+
+// Handed to RenderPass::Setup to declare what the pass touches. Resources
+// are matched by name, so a pass may read a target that a pass added after
+// it creates.
+class RenderGraphBuilder {
+public:
+    // A target that only lives for this frame, taken from the graph's pool
+    void Create(std::string_view name, const RenderTargetDesc& desc);
+    // Sampled by the pass, resolved first when multisampled
+    void Read(std::string_view name);
+    // Rendered to by the pass. The graph binds it, and clears it when asked
+    // or when it is a transient's first write. One target per pass.
+    void Write(std::string_view name, LoadOp load = LoadOp::Load);
+    // Keeps the pass even when nothing reads what it writes
+    void SetSideEffect();
+
+private:
+    friend class RenderGraph;
+    RenderGraphBuilder(RenderGraph& graph, uint32_t pass) : m_Graph(graph), m_Pass(pass) {}
+
+    RenderGraph& m_Graph;
+    uint32_t m_Pass;
+};
+
+// What a pass sees while executing
+class RenderGraphContext {
+public:
+    // Textures of a target, 0 for the window. Multisampled targets are
+    // resolved before the first pass that reads them after a write.
+    uint32_t GetTexture(std::string_view name, uint32_t attachment = 0) const;
+    uint32_t GetDepthTexture(std::string_view name) const;
+    std::shared_ptr<Framebuffer> GetFramebuffer(std::string_view name) const;
+
+private:
+    friend class RenderGraph;
+    explicit RenderGraphContext(const RenderGraph& graph) : m_Graph(graph) {}
+
+    const RenderGraph& m_Graph;
+};
+
 class RenderPass {
 public:
     virtual ~RenderPass() = default;
-    // Execute the pass
-    virtual void Execute() = 0;
+    // Declares reads and writes; called every frame before scheduling. The
+    // default declares nothing but a side effect, so the pass always runs
+    // and draws into whatever framebuffer was bound when the graph started.
+    virtual void Setup(RenderGraphBuilder& builder) { builder.SetSideEffect(); }
+    // Execute the pass, with its target bound
+    virtual void Execute(const RenderGraphContext& context) = 0;
+    // Name used for GPU timings
+    virtual const char* GetName() const { return "RenderPass"; }
 };
 
+// Of the last Execute
+struct RenderGraphStats {
+    uint32_t passes{0};
+    uint32_t culledPasses{0};       // Nothing live read what they wrote
+    uint32_t transientTargets{0};   // Declared by live passes
+    uint32_t physicalTargets{0};    // Framebuffers backing them after aliasing
+    uint32_t pooledTargets{0};      // Kept by the pool, idle ones included
+    size_t pooledBytes{0};
+    uint32_t framebufferBinds{0};
+    uint32_t clears{0};
+    uint32_t resolves{0};
+};
+
+// Passes declare the targets they read and write, and every frame the graph
+// orders them by those dependencies (insertion order breaks ties), drops
+// passes whose output nothing uses, and hands transient targets out of a
+// pool so targets whose lifetimes don't overlap alias the same framebuffer.
+// Binds and clears are issued by the graph, only where they change anything.
 class RenderGraph {
 public:
+    using SetupFunction = std::function<void(RenderGraphBuilder&)>;
+    using ExecuteFunction = std::function<void(const RenderGraphContext&)>;
+
     RenderGraph() = default;
     ~RenderGraph() = default;
 
     // Add a render pass to the graph
-    void AddPass(std::shared_ptr<RenderPass> pass) { m_Passes.push_back(pass); }
+    void AddPass(std::shared_ptr<RenderPass> pass);
+    void AddPass(std::string name, SetupFunction setup, ExecuteFunction execute);
 
-    // Execute all added passes sequentially
-    void Execute() {
-        for (auto& pass : m_Passes)
-            pass->Execute();
-    }
+    // A target owned elsewhere, under a name passes can use. Null stands for
+    // whatever framebuffer is bound when Execute starts (the window, or the
+    // application's offscreen target). Writing an import keeps a pass alive.
+    void ImportFramebuffer(std::string_view name, std::shared_ptr<Framebuffer> framebuffer);
+
+    // Runs every live pass in dependency order, each one in its own GPU
+    // timing scope, then restores the framebuffer and viewport bound on entry
+    void Execute();
+
+    const RenderGraphStats& GetStats() const { return m_Stats; }
+    // Frees every pooled target
+    void ReleaseTargets() { m_Pool.Clear(); }
 
 private:
-    std::vector<std::shared_ptr<RenderPass>> m_Passes;
+    friend class RenderGraphBuilder;
+    friend class RenderGraphContext;
+
+    static constexpr uint32_t None = UINT32_MAX;
+
+    struct ResourceNode {
+        std::string name;
+        RenderTargetDesc desc;
+        bool imported{false};
+        std::shared_ptr<Framebuffer> framebuffer; // The import, or the pooled target assigned
+        uint32_t firstUse{None};                  // Schedule positions of live passes
+        uint32_t lastUse{0};
+        bool unresolved{false};                   // Multisampled and written since the last resolve
+    };
+
+    struct PassNode {
+        std::shared_ptr<RenderPass> pass;
+        // Names as declared, resolved to resources once every pass is set up
+        std::vector<std::string> readNames;
+        std::string targetName;
+        std::vector<uint32_t> reads;
+        uint32_t target{None};
+        LoadOp load{LoadOp::Load};
+        bool sideEffect{false};
+        bool live{false};
+        bool clear{false};
+        std::vector<uint32_t> dependents;
+        uint32_t dependencies{0};
+    };
+
+    void SetupPasses();
+    void Schedule();
+    void Cull();
+    void AllocateTargets();
+    uint32_t FindResource(std::string_view name) const;
+
+    std::vector<PassNode> m_Passes;
+    std::vector<uint32_t> m_Schedule;
+    std::vector<ResourceNode> m_Resources;
+    std::map<std::string, uint32_t, std::less<>> m_ResourceIndex;
+    std::map<std::string, std::shared_ptr<Framebuffer>, std::less<>> m_Imports;
+    RenderTargetPool m_Pool;
+    RenderGraphStats m_Stats;
 };
 
 } // namespace Kosmic::Renderer
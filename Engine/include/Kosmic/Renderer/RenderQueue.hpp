@@ -0,0 +1,146 @@
+#pragma once
+
+#include "Kosmic/Core/Math/Math.hpp"
+#include "Kosmic/Renderer/Culling.hpp"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Kosmic::Assets { class Material; }
+
+namespace Kosmic::Renderer {
+
+class Mesh;
+class Shader;
+class OcclusionCuller;
+class OcclusionQueries;
+struct InstanceData;
+
+// Buckets drawn in this order, the top bits of every sort key
+enum class RenderPassType : uint8_t {
+    Opaque = 0,
+    Transparent = 1
+};
+
+struct DrawPacket {
+    Mesh* mesh;
+    const Assets::Material* material; // May be null: plain white
+    Shader* shader;
+    Math::Mat4 transform;
+    // Instanced draws take their transforms from here instead
+    const InstanceData* instances;
+    uint32_t instanceCount; // 0 for a regular draw
+};
+
+// Draw statistics of the last Execute
+struct RenderQueueStats {
+    uint32_t draws{0};
+    uint32_t drawCalls{0};    // glDraw* calls issued for them
+    uint32_t multiDraws{0};   // Of which glMultiDrawElementsIndirect
+    uint32_t pooledDraws{0};  // Draws that took their data from the draw data buffer
+    uint32_t instances{0};    // Objects drawn by instanced draws
+    uint32_t shaderBinds{0};
+    uint32_t materialBinds{0};
+    uint32_t textureBinds{0};
+    uint32_t meshBinds{0};
+    uint32_t visible{0};      // Draws that passed frustum culling
+    uint32_t culled{0};       // Draws dropped by frustum culling
+    uint32_t occluded{0};     // Draws dropped by occlusion culling or queries
+    uint32_t conditional{0};  // Draws issued under conditional rendering
+};
+
+// Per-frame list of draws. Packets are sorted by a 64-bit key so that draws
+// sharing a shader, material and mesh end up next to each other, then issued
+// with every redundant bind skipped.
+//
+// Draws of GeometryPool meshes with a shader that reads u_DrawData (see
+// pooled.vert) get their transform and color from a texture buffer instead
+// of uniforms. Runs of them sharing a pool page, texture and blend state go
+// out as one glMultiDrawElementsIndirect, or one glDrawElementsBaseVertex
+// each without GL 4.3.
+//
+// Packets keep raw pointers: whatever is submitted must stay alive until
+// Execute has run.
+class RenderQueue {
+public:
+    RenderQueue() = default;
+    ~RenderQueue();
+
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+
+    // viewDepth is the distance along the camera's view direction
+    void Submit(Mesh& mesh, const Assets::Material* material, Shader& shader,
+                const Math::Mat4& transform, float viewDepth);
+    // One draw of instanceCount copies; the instance array must stay alive until Execute
+    void SubmitInstanced(Mesh& mesh, const Assets::Material* material, Shader& shader,
+                         const InstanceData* instances, uint32_t instanceCount);
+    // Drops regular draws whose bounding sphere is outside the frustum.
+    // Instanced draws are left alone, their instances are culled upstream.
+    void Cull(const Math::Frustum& frustum);
+    // Drops regular draws whose world-space box is hidden behind the
+    // culler's occluders, which must have been rendered for this view.
+    // Cheapest after Cull, with fewer boxes left to test.
+    void CullOccluded(OcclusionCuller& culler);
+    // Drops regular opaque draws that the last occlusion query result found
+    // hidden, and marks the ones still waiting on a query for conditional
+    // rendering. The submission order is what identifies a draw to queries.
+    void CullQueried(OcclusionQueries& queries);
+    void Sort();
+    // Draws every packet in key order. Camera data comes from the Camera
+    // uniform block, which must be uploaded beforehand.
+    void Execute();
+    void Clear();
+
+    size_t Size() const { return m_Packets.size(); }
+    // Counts since the last Clear
+    const RenderQueueStats& GetStats() const { return m_Stats; }
+
+    // Opaque: pass | shader | material | mesh | depth (front-to-back)
+    // Transparent: pass | inverted depth (back-to-front) | shader | material | mesh
+    static uint64_t MakeKey(RenderPassType pass, uint32_t shaderID, uint32_t materialID,
+                            uint32_t meshID, float viewDepth);
+
+private:
+    // Layout of glMultiDrawElementsIndirect's commands
+    struct DrawCommand {
+        uint32_t indexCount;
+        uint32_t instanceCount;
+        uint32_t firstIndex;
+        int32_t baseVertex;
+        uint32_t baseInstance;  // Draw ID within the uploaded window
+    };
+
+    // Fills the commands and draw data of every pooled draw, in key order
+    void PreparePooledDraws();
+    // Uploads the draw data of the window that holds draw first
+    void UploadDrawData(uint32_t first);
+
+    std::vector<DrawPacket> m_Packets;
+    // Sorted instead of the packets themselves, which carry a whole matrix
+    std::vector<std::pair<uint64_t, uint32_t>> m_Keys;
+    RenderQueueStats m_Stats;
+
+    // Drops the keys at m_Tested[i] whose m_Visibility[i] is 0
+    void EraseHidden();
+    uint32_t GetCondition(uint32_t packet) const { return m_Conditions.empty() ? 0 : m_Conditions[packet]; }
+
+    // Culling scratch, kept to avoid reallocating every frame
+    Culling::SphereList m_Spheres;
+    std::vector<Math::AABB> m_Boxes;
+    std::vector<uint32_t> m_Tested;   // Index into m_Keys of every sphere or box
+    std::vector<uint8_t> m_Visibility;
+    // Per packet, the query a draw is conditional on; empty without queries
+    std::vector<uint32_t> m_Conditions;
+
+    // Pooled draws. The texture buffer holds a window of at most
+    // m_DrawWindow draws (5 RGBA32F texels each) at a time.
+    std::vector<DrawCommand> m_Commands;
+    std::vector<Math::Vector4> m_DrawData;
+    uint32_t m_DrawWindow{0};
+    uint32_t m_DrawDataBuffer{0};
+    uint32_t m_DrawDataTexture{0};
+    uint32_t m_IndirectBuffer{0};
+};
+
+} // namespace Kosmic::Renderer
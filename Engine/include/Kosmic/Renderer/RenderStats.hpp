@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Kosmic::Renderer {
+
+// What the renderer did in one frame
+struct RenderStats {
+    uint32_t drawCalls{0};              // glDraw* and glMultiDraw* calls
+    uint64_t triangles{0};              // Instances included
+    uint32_t instances{0};              // Of instanced draws
+    uint32_t stateChanges{0};           // GL state calls StateManager issued
+    uint32_t redundantStateChanges{0};  // And the ones it skipped
+    uint32_t shaderBinds{0};            // Issued binds, included in stateChanges
+    uint32_t textureBinds{0};
+    uint32_t vaoBinds{0};
+    uint32_t framebufferBinds{0};
+    uint32_t uniformUploads{0};         // glUniform* calls
+    size_t bufferBytes{0};              // Written into GL buffers, texture streaming included
+    uint32_t visibleObjects{0};         // Draws and instances that survived culling
+    uint32_t culledObjects{0};          // By the frustum
+    uint32_t occlusionTested{0};        // Boxes tested against the occluders
+    uint32_t occludedObjects{0};        // Of which hidden
+    uint32_t occlusionQueries{0};       // Hardware occlusion queries issued
+    uint32_t gpuCullTested{0};          // Instances GPU culling tested, from a readback a few frames old
+    uint32_t gpuCullVisible{0};         // Of which kept
+    uint32_t visibleLights{0};          // Point and spot lights in the clusters
+    uint32_t lightIndices{0};           // Entries of the cluster light lists
+};
+
+// Frame counters, added to by the renderer as it goes (main thread only)
+class RenderStatistics {
+public:
+    // Graphs in the profiler window cover this many frames
+    static constexpr uint32_t HistorySize = 240;
+
+    // The frame being recorded
+    static RenderStats& GetCurrent();
+    // Call once per frame, after the last draw
+    static void EndFrame();
+
+    // The last frame EndFrame finished
+    static const RenderStats& GetLast();
+    // framesAgo 0 is GetLast(), up to GetHistoryCount() - 1
+    static const RenderStats& GetHistory(uint32_t framesAgo);
+    static uint32_t GetHistoryCount();
+};
+
+} // namespace Kosmic::Renderer
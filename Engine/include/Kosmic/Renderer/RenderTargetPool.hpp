@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Framebuffer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Kosmic::Renderer {
+
+struct RenderTargetPoolStats {
+    uint32_t targets{0};        // Held by the pool, idle ones included
+    uint32_t acquired{0};       // Acquire calls this frame
+    uint32_t created{0};        // Of those, the ones that needed a new framebuffer
+    uint32_t resized{0};        // Reused after a Resize that had to reallocate
+    size_t bytes{0};            // Video memory of every held target
+};
+
+// Hands out framebuffers for the current frame. Released targets go back to
+// the free list right away, so a later Acquire in the same frame can alias
+// them; whatever is still out is returned by EndFrame. Targets are matched
+// by attachments and sample count. Within a frame only targets of the same
+// size alias. A target left over from earlier frames is resized instead,
+// which keeps its allocation when that is large enough, so a window drag
+// does not create new targets every frame.
+class RenderTargetPool {
+public:
+    // Targets nobody acquired for this many frames are freed
+    static constexpr uint32_t MaxIdleFrames = 8;
+
+    std::shared_ptr<Framebuffer> Acquire(const FramebufferSpecification& specification);
+    void Release(const std::shared_ptr<Framebuffer>& framebuffer);
+    // Returns every acquired target and frees the stale ones
+    void EndFrame();
+    // Frees every target, acquired or not
+    void Clear();
+
+    // Of the last frame EndFrame finished
+    const RenderTargetPoolStats& GetStats() const { return m_Stats; }
+
+private:
+    struct Entry {
+        // As asked for; the framebuffer's own may have fewer samples
+        FramebufferSpecification specification;
+        std::shared_ptr<Framebuffer> framebuffer;
+        uint32_t idleFrames{0};
+        bool acquired{false};
+        bool usedThisFrame{false};
+    };
+
+    std::vector<Entry> m_Entries;
+    RenderTargetPoolStats m_Frame;
+    RenderTargetPoolStats m_Stats;
+};
+
+} // namespace Kosmic::Renderer
@@ -7,8 +7,17 @@
 #include "RenderGraph.hpp"
 #include "Framebuffer.hpp"
 #include "RendererAPI.hpp"
+#include "GPUProfiler.hpp"
+#include "RenderQueue.hpp"
+#include "Lighting.hpp"
+#include "LightClusters.hpp"
+#include "OcclusionCulling.hpp"
+#include "OcclusionQueries.hpp"
+#include "GPUCulling.hpp"
 #include <GL/glew.h>
 
+namespace Kosmic::Assets { class Material; }
+
 namespace Kosmic::Renderer {
 
 class Renderer3D {
@@ -21,17 +30,83 @@ public:
     void RenderSky();
     void SetCamera(const std::shared_ptr<Camera>& camera);
     void SetMesh(const std::shared_ptr<Mesh>& mesh);
+    // Queues a draw for the next Render, which sorts and batches the queue.
+    // The mesh and material must stay alive until then. A null material
+    // draws plain white with the default shader. Meshes in the GeometryPool
+    // use the pooled shader, so runs of them merge into multi-draws.
+    void Submit(const std::shared_ptr<Mesh>& mesh, const std::shared_ptr<Assets::Material>& material,
+                const Math::Mat4& transform);
+    // Queues one instanced draw of count copies of mesh. The instance array
+    // must stay alive until Render. Uses the instanced shader unless the
+    // material has its own.
+    void SubmitInstanced(const std::shared_ptr<Mesh>& mesh, const std::shared_ptr<Assets::Material>& material,
+                         const InstanceData* instances, uint32_t count);
+    // Draw, bind and culling counts of the last Render
+    const RenderQueueStats& GetQueueStats() const;
+    const std::shared_ptr<Camera>& GetCamera() const { return m_Camera; }
+
+    // Frustum culling of submitted draws (and ECS instances), on by default
+    void SetFrustumCulling(bool enabled) { m_FrustumCulling = enabled; }
+    bool IsFrustumCullingEnabled() const { return m_FrustumCulling; }
+    // CPU occlusion culling of submitted draws against the occluders of the
+    // frame, off by default. Only pays off with large occluders in view.
+    void SetOcclusionCulling(bool enabled) { m_OcclusionCulling = enabled; }
+    bool IsOcclusionCullingEnabled() const { return m_OcclusionCulling; }
+    // Occluder for the next Render only; the mesh must stay alive until then
+    void SubmitOccluder(const OccluderMesh& mesh, const Math::Mat4& transform);
+    // Occlusion counts and CPU cost of the last Render
+    const OcclusionStats& GetOcclusionStats() const;
+    // Hardware occlusion queries against the previous frames' results, off by
+    // default. Needs no occluders, but a draw that comes into view appears
+    // a frame late. Switching clears every draw's history.
+    void SetOcclusionQueries(bool enabled);
+    bool IsOcclusionQueriesEnabled() const { return m_OcclusionQueries; }
+    // Query counts of the last Render
+    const OcclusionQueryStats& GetOcclusionQueryStats() const;
+    // Frustum and Hi-Z culling of instanced draws in a compute shader, off by
+    // default. Needs GL 4.3 (see GPUCulling::IsSupported), call after Init;
+    // stays off without it. Draws with their own shader or a transparent
+    // material still go through the queue.
+    void SetGPUCulling(bool enabled);
+    bool IsGPUCullingEnabled() const { return m_GPUCulling; }
+    // Counters read back from the GPU, a few frames old
+    const GPUCullingStats& GetGPUCullingStats() const;
     std::shared_ptr<Shader> GetShader();
+    // Scene lights, uploaded to the Lighting uniform block on the next Render
+    void SetAmbientLight(const Lighting::AmbientLight& light);
+    void SetDirectionalLight(const Lighting::DirectionalLight& light);
+    // Queue a light for the next Render only, like draws. Any number of them
+    // (up to LightClusters::MaxLights) is fine: shaders built on basic.frag
+    // only evaluate the ones whose range reaches their cluster.
+    void SubmitPointLight(const Lighting::PointLight& light);
+    void SubmitSpotLight(const Lighting::SpotLight& light);
+    // Light counts of the last Render
+    const LightClusterStats& GetLightStats() const;
+    // GPU time of Render in the latest resolved frame, in ns (lags a few
+    // frames behind); the whole frame is in GetLastGPUTimings().frameTime
     static uint64_t GetLastGPUTime();
+    // Per-scope/per-pass GPU times of the same frame
+    static const GPUFrameTimings& GetLastGPUTimings();
 
     void SetFramebuffer(const std::shared_ptr<Framebuffer>& framebuffer);
+    // Sky and Scene are its first passes, both writing "Output" (the
+    // framebuffer set above, or the one bound when Render is called).
+    // Passes added here run after them; they draw over the scene by
+    // writing "Output" too, and can read it once the output is a texture.
+    RenderGraph& GetRenderGraph() { return *m_RenderGraph; }
 
 private:
+    void RenderScene();
+
     class Impl;
     std::unique_ptr<Impl> pImpl;
     std::shared_ptr<RenderGraph> m_RenderGraph;
     std::shared_ptr<Camera> m_Camera;
     std::shared_ptr<Framebuffer> m_Framebuffer;
+    bool m_FrustumCulling{true};
+    bool m_OcclusionCulling{false};
+    bool m_OcclusionQueries{false};
+    bool m_GPUCulling{false};
 };
 
 } // namespace Kosmic::Renderer
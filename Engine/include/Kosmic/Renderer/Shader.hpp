@@ -1,35 +1,78 @@
 #pragma once
 #include "Kosmic/Core/Math/Math.hpp"
+#include <initializer_list>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <unordered_map>
 
 // Forward declaration of the GLuint type
 typedef unsigned int GLuint;
 typedef unsigned int GLenum;
+typedef int GLint;
 
 namespace Kosmic::Renderer {
 
 class Shader {
 public:
     Shader(const std::string& vertexSrc, const std::string& fragmentSrc);
+    // Compute program, needs GL 4.3
+    explicit Shader(const std::string& computeSrc);
     ~Shader();
 
     void Bind() const;
     void Unbind() const;
 
+    GLuint GetID() const { return m_ShaderID; }
+
     static std::shared_ptr<Shader> CreateBasicShader();
     static std::shared_ptr<Shader> CreateSkyShader();
+    // Basic shader reading the model matrix and color from instance attributes
+    static std::shared_ptr<Shader> CreateInstancedShader();
+    // Basic shader reading the model matrix and color from the render queue's
+    // draw data, for GeometryPool meshes
+    static std::shared_ptr<Shader> CreatePooledShader();
+    // Depth-only box between u_Center +- u_Size / 2, for occlusion queries
+    static std::shared_ptr<Shader> CreateBoundsShader();
+    // GL 4.3 programs of GPUCulling: the instance culling and depth pyramid
+    // compute shaders, and the basic shader reading instances it kept
+    static std::shared_ptr<Shader> CreateCullShader();
+    static std::shared_ptr<Shader> CreateDepthPyramidShader();
+    static std::shared_ptr<Shader> CreateCulledInstanceShader();
+
+    // Location of an active uniform, -1 if the program doesn't use it.
+    // Every uniform is reflected at link time, so this never calls the driver.
+    GLint GetUniformLocation(std::string_view name) const;
+    // Attaches a uniform block to a binding point. The engine's own blocks
+    // (see UniformBinding) are bound automatically.
+    void BindUniformBlock(std::string_view name, uint32_t binding);
+
+    void SetMat4(std::string_view name, const Math::Mat4& matrix);
+    void SetVec3(std::string_view name, const Math::Vector3& value);
+    void SetVec4(std::string_view name, const Math::Vector4& value);
+    void SetFloat(std::string_view name, float value);
+    void SetInt(std::string_view name, int value);
 
-    void SetMat4(const std::string& name, const Math::Mat4& matrix);
-    void SetVec3(const std::string& name, const Math::Vector3& value);
-    void SetVec4(const std::string& name, const Math::Vector4& value);
-    void SetFloat(const std::string& name, float value);
-    void SetInt(const std::string& name, int value);
+    // Same with a location from GetUniformLocation, for per-draw uniforms
+    void SetMat4(GLint location, const Math::Mat4& matrix);
+    void SetVec3(GLint location, const Math::Vector3& value);
+    void SetVec4(GLint location, const Math::Vector4& value);
+    void SetFloat(GLint location, float value);
+    void SetInt(GLint location, int value);
 
 private:
+    // Lets the uniform map be searched with a string_view without allocating
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+    };
+
+    void Reflect();
+
     GLuint m_ShaderID;
+    std::unordered_map<std::string, GLint, StringHash, std::equal_to<>> m_UniformLocations;
     static GLuint CompileShader(GLenum type, const std::string& source);
-    static GLuint LinkProgram(GLuint vertexShader, GLuint fragmentShader);
+    static GLuint LinkProgram(std::initializer_list<GLuint> shaders);
 };
 
 } // namespace Kosmic::Renderer
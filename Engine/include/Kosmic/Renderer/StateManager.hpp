@@ -1,22 +1,53 @@
 #pragma once
 
 #include <GL/glew.h>
+#include <cstdint>
 
 namespace Kosmic::Renderer {
 
+// Shadows the GL state the engine touches and only forwards calls that
+// change it. Everything starts out unknown, so the first call of each kind
+// always goes through. Bindings are left in place after use; whoever needs
+// something else binds it. Main thread only, like the rest of GL.
+// Issued and skipped calls are counted in RenderStats.
 class StateManager {
 public:
-    // Set the cull face state if needed
-    static void SetCullFace(bool enable) {
-        if (enable) glEnable(GL_CULL_FACE);
-        else glDisable(GL_CULL_FACE);
-    }
-    
-    // Set the depth test state if needed
-    static void SetDepthTest(bool enable) {
-        if (enable) glEnable(GL_DEPTH_TEST);
-        else glDisable(GL_DEPTH_TEST);
-    }
+    static constexpr uint32_t MaxTextureUnits = 16;
+
+    static void UseProgram(uint32_t program);
+    // Binding a VAO marked with SetConstantColor also resets location 1 to
+    // white: current attribute values are context state, and drawing with
+    // a color array enabled leaves location 1's undefined
+    static void BindVertexArray(uint32_t vao);
+    // Marks a VAO whose layout has no color stream (see VertexLayout::Apply)
+    static void SetConstantColor(uint32_t vao, bool constant);
+    // Makes the unit active as well. GL_TEXTURE_2D and GL_TEXTURE_BUFFER are
+    // cached per unit, other targets and units past MaxTextureUnits always
+    // go through.
+    static void BindTexture(uint32_t unit, uint32_t texture, GLenum target = GL_TEXTURE_2D);
+    // Both draw and read
+    static void BindFramebuffer(uint32_t framebuffer);
+    // Asks GL when the binding is not known yet
+    static uint32_t GetFramebuffer();
+
+    static void SetDepthTest(bool enable);
+    static void SetDepthMask(bool enable);
+    static void SetCullFace(bool enable);
+    // GL_BACK or GL_FRONT
+    static void SetCullMode(GLenum face);
+    static void SetBlend(bool enable);
+    static void SetBlendFunc(GLenum source, GLenum destination);
+
+    // Deleting a bound object unbinds it, and its name can come back for a
+    // new object; call these right after the glDelete* call
+    static void OnProgramDeleted(uint32_t program);
+    static void OnVertexArrayDeleted(uint32_t vao);
+    static void OnTextureDeleted(uint32_t texture);
+    static void OnFramebufferDeleted(uint32_t framebuffer);
+
+    // Forgets everything, for after code that changes state without going
+    // through here (and doesn't restore it)
+    static void Invalidate();
 };
 
 } // namespace Kosmic::Renderer
@@ -1,23 +1,104 @@
 #pragma once
+#include "Kosmic/Assets/TextureFile.hpp"
+#include "Kosmic/Core/MappedFile.hpp"
 #include <string>
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 namespace Kosmic::Renderer {
 
+// Video memory taken by all textures, next to what the same levels would
+// take uncompressed (RGB8 counted at 4 bytes, as drivers store it)
+struct TextureMemory {
+    size_t bytes{0};
+    size_t uncompressedBytes{0};
+};
+
+struct TextureCookOptions {
+    bool compress{true};   // BC1, or BC3 when alpha is used
+    bool normalMap{false}; // Compressed as BC5: X and Y only, Z is rebuilt when sampling
+    bool bc7{false};       // BC7 instead of BC1/BC3: twice BC1's size, far fewer artifacts
+};
+
 class Texture {
 public:
+    // Pixels ready for upload. Decoding needs no GL context, so it can run
+    // on any thread; cooked pixels stay in the file mapping.
+    struct Image {
+        Assets::TextureFile::Format format{Assets::TextureFile::Format::RGBA8};
+        std::vector<Assets::TextureFile::MipLevel> levels; // Offsets into GetData()
+        bool generateMips{false};                          // Only level 0 is present
+        MappedFile file;
+        std::vector<uint8_t> pixels;
+
+        const uint8_t* GetData() const { return file.IsOpen() ? file.GetData() : pixels.data(); }
+        // Builds the mip chain on the CPU when only level 0 is present
+        void GenerateMipChain();
+    };
+
+    // Empty texture, bound as the placeholder until Upload or streaming
+    Texture() : m_RendererID(0), m_Width(0), m_Height(0), m_Channels(0) {}
+    // Loads right away. Prefers the cooked "<path>.ktex" when it is up to
+    // date with the image, a .ktex path is loaded directly.
     Texture(const std::string& path);
     ~Texture();
 
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+
     void Bind(uint32_t slot = 0) const;
-    void Unbind() const;
+    void Unbind(uint32_t slot = 0) const;
 
-    inline uint32_t GetID() const { return m_RendererID; }
+    // The placeholder's ID until at least one mip level is resident
+    inline uint32_t GetID() const { return m_Ready ? m_RendererID : GetPlaceholderID(); }
+    // Every level resident; a streamed texture is usable before that
+    bool IsLoaded() const { return m_Ready && m_ResidentLevel == 0; }
+    uint32_t GetResidentLevel() const { return m_ResidentLevel; }
+    Assets::TextureFile::Format GetFormat() const { return m_Format; }
+    size_t GetMemorySize() const { return m_MemorySize; }
+    static TextureMemory GetTotalMemory();
+
+    // Whether the GL implementation can sample a format; cooked files in
+    // other formats are skipped in favour of the source image
+    static bool IsFormatSupported(Assets::TextureFile::Format format);
+
+    // Reads the cooked file or decodes the image, on any thread
+    static bool Decode(const std::string& path, Image& image);
+    // Creates the GL texture, on the GL thread
+    void Upload(const Image& image);
+
+    // 1x1 white, shown while a texture is still loading
+    static uint32_t GetPlaceholderID();
+    static void ReleasePlaceholder();
+
+    // Decodes an image, builds its mip chain, compresses it and writes it as
+    // a .ktex. Needs no GL context.
+    static bool Cook(const std::string& sourcePath, const std::string& cookedPath, const TextureCookOptions& options = {});
 
 private:
+    friend class TextureStreamer;
+
+    // Storage for every level, filled in later by the streamer
+    void AllocateLevels(const Image& image);
+    // Sampling starts at this level, the ones below it are not filled yet
+    void SetResidentLevel(uint32_t level);
+    // Fills rows of a level from pixels, or from an offset into the bound
+    // unpack buffer. Row units are pixel rows, or block rows when compressed.
+    void UploadRows(const Image& image, uint32_t level, uint32_t row, uint32_t rows, const void* pixels);
+    void CreateStorage(const Image& image);
+
+    static bool DecodeCooked(const std::string& cookedPath, const Assets::SourceStamp* source, Image& image);
+    static bool DecodeImage(const std::string& path, Image& image);
+
     std::string m_Path;
     uint32_t m_RendererID;
     int m_Width, m_Height, m_Channels;
+    bool m_Ready{false};
+    uint32_t m_ResidentLevel{0};
+    Assets::TextureFile::Format m_Format{Assets::TextureFile::Format::RGBA8};
+    size_t m_MemorySize{0};
+    size_t m_UncompressedSize{0};
 };
 
 } // namespace Kosmic::Renderer
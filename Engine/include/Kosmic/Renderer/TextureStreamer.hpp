@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Kosmic/Renderer/Texture.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Kosmic::Renderer {
+
+struct TextureStreamerStats {
+    uint32_t pendingTextures{0};     // Queued or partly uploaded
+    size_t bytesInFlight{0};         // Written to the ring, not yet consumed by the GPU
+    size_t bytesLastFrame{0};
+    uint32_t completed{0};           // Textures fully resident since Init
+    double lastLatencyMs{0.0};       // Enqueue to fully resident
+    double averageLatencyMs{0.0};
+    double maxLatencyMs{0.0};
+};
+
+// Uploads decoded textures a slice at a time through a ring of pixel unpack
+// buffer memory; compressed ones go by whole rows of blocks. Levels are filled from the smallest upwards, and each one
+// becomes the texture's base level as soon as it is complete, so a blurry
+// version shows up within a frame or two and sharpens as the rest arrives.
+//
+// The ring is mapped once and kept mapped where ARB_buffer_storage exists;
+// otherwise each slice maps its range unsynchronized. Either way, fences
+// keep the CPU from overwriting memory the GPU has not read yet.
+class TextureStreamer {
+public:
+    static constexpr size_t DefaultRingSize = 16 * 1024 * 1024;
+
+    static void Init(size_t ringSize = DefaultRingSize);
+    static void Shutdown();
+
+    // Takes over the image; the texture keeps its placeholder until the first level lands
+    static void Enqueue(const std::shared_ptr<Texture>& texture, std::shared_ptr<Texture::Image> image);
+    // Uploads up to budgetBytes (at least one row so nothing starves); GL thread only
+    static void Update(size_t budgetBytes);
+
+    static TextureStreamerStats GetStats();
+};
+
+} // namespace Kosmic::Renderer
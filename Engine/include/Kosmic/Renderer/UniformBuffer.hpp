@@ -0,0 +1,65 @@
+#pragma once
+#include "Kosmic/Core/Math/Math.hpp"
+#include <cstdint>
+
+namespace Kosmic::Renderer {
+
+// Binding points of the engine's shared uniform blocks. Shaders that declare
+// a block with one of these names get it bound automatically at link time.
+namespace UniformBinding {
+    constexpr uint32_t Camera   = 0;
+    constexpr uint32_t Lighting = 1;
+}
+
+// Texture units of the engine's shared texture buffers. Samplers with these
+// names (u_DrawData, u_ClusterLights, ...) are set to them at link time.
+namespace TextureUnit {
+    constexpr uint32_t DrawData      = 1; // See RenderQueue
+    constexpr uint32_t ClusterLights = 2; // See LightClusters
+    constexpr uint32_t LightIndices  = 3;
+    constexpr uint32_t LightData     = 4;
+    constexpr uint32_t DepthPyramid  = 5; // See GPUCulling
+}
+
+// std140 "Camera" block, see basic.vert and sky.vert
+struct CameraUniforms {
+    Math::Mat4 view;
+    Math::Mat4 projection;
+    Math::Mat4 skyProjection; // Always perspective, even for orthographic cameras
+    Math::Vector4 position;   // w unused
+};
+static_assert(sizeof(CameraUniforms) == 3 * 64 + 16, "CameraUniforms must match the std140 layout");
+
+// std140 "Lighting" block, see basic.frag
+struct LightingUniforms {
+    Math::Vector4 ambient;          // rgb color, a intensity
+    Math::Vector4 lightDirection;   // xyz direction, w unused
+    Math::Vector4 lightColor;       // rgb color, a intensity
+    Math::Vector4 clusterScale;     // See LightClusters::GetClusterScale
+    uint32_t clusterGrid[4];        // Tiles across, tiles down, depth slices, unused
+};
+static_assert(sizeof(LightingUniforms) == 5 * 16, "LightingUniforms must match the std140 layout");
+
+// Uniform buffer object attached to a fixed binding point
+class UniformBuffer {
+public:
+    UniformBuffer(uint32_t size, uint32_t binding);
+    ~UniformBuffer();
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    // Replaces size bytes at offset. A full update orphans the old storage so
+    // the driver doesn't stall on draws still reading it.
+    void SetData(const void* data, uint32_t size, uint32_t offset = 0);
+
+    uint32_t GetBinding() const { return m_Binding; }
+    uint32_t GetID() const { return m_RendererID; }
+
+private:
+    uint32_t m_RendererID;
+    uint32_t m_Size;
+    uint32_t m_Binding;
+};
+
+} // namespace Kosmic::Renderer
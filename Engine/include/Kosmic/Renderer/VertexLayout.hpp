@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Kosmic/Core/Math/Math.hpp"
+#include <cstdint>
+#include <type_traits>
+
+namespace Kosmic::Renderer {
+
+// Full precision vertex that meshes are built from; what ends up in the
+// vertex buffer is described by a VertexLayout
+struct Vertex {
+    Math::Vector3 Position;
+    Math::Vector3 Normal;
+    Math::Vector2 TexCoords;
+    Math::Vector3 Color;
+};
+
+// Shader input locations, the same in every program
+enum class VertexAttribute : uint32_t {
+    Position = 0,
+    Color = 1,
+    TexCoord = 2,
+    Normal = 3
+};
+
+enum class VertexFormat : uint32_t {
+    Float2,
+    Float3,
+    Half2,         // GL_HALF_FLOAT
+    Int2_10_10_10, // GL_INT_2_10_10_10_REV, normalized xyz, w unused
+    UByte4         // Normalized, alpha 255
+};
+
+uint32_t GetVertexFormatSize(VertexFormat format);
+
+struct VertexElement {
+    VertexAttribute attribute{VertexAttribute::Position};
+    VertexFormat format{VertexFormat::Float3};
+    uint32_t offset{0};
+
+    bool operator==(const VertexElement&) const = default;
+};
+
+// Which streams a vertex buffer carries and how each one is packed.
+// Trivially copyable, cooked meshes store it as is.
+struct VertexLayout {
+    static constexpr uint32_t MaxElements = 8;
+
+    VertexElement elements[MaxElements]{};
+    uint32_t elementCount{0};
+    uint32_t stride{0};
+
+    // Appends an element, 4 byte aligned
+    VertexLayout& Add(VertexAttribute attribute, VertexFormat format);
+    bool Has(VertexAttribute attribute) const;
+    bool IsValid() const;
+    bool operator==(const VertexLayout&) const = default;
+
+    // Points the bound VAO at the bound vertex buffer. Without a color
+    // stream the shader reads constant white.
+    void Apply() const;
+    // Converts to this layout; out holds stride * count bytes
+    void Pack(const Vertex* vertices, uint32_t count, uint8_t* out) const;
+
+    // All float, color included (44 bytes)
+    static VertexLayout Standard();
+    // Float position, 2_10_10_10 normal, half UVs: 20 bytes, 24 with colors
+    static VertexLayout Compact(bool colors = false);
+    // Compact, with float UVs where half floats would lose texel precision
+    // and colors only when some vertex is not white
+    static VertexLayout Choose(const Vertex* vertices, uint32_t count);
+};
+
+static_assert(std::is_trivially_copyable_v<VertexLayout>, "VertexLayout is stored in cooked files");
+
+} // namespace Kosmic::Renderer
@@ -0,0 +1,193 @@
+#include "Kosmic/Assets/AssetManager.hpp"
+#include "Kosmic/Core/Jobs.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include "Kosmic/Core/Profiler.hpp"
+#include "Kosmic/Renderer/TextureStreamer.hpp"
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+
+namespace Kosmic::Assets {
+
+namespace {
+
+struct State {
+    std::mutex mutex; // Guards everything but counter
+    std::unordered_map<std::string, std::weak_ptr<Renderer::Texture>> textures;
+    std::unordered_map<std::string, std::weak_ptr<Model>> models;
+    std::deque<std::function<void()>> uploads;
+    Jobs::Counter counter; // Decode jobs in flight
+    uint32_t uploadsLastFrame{0};
+    uint32_t updates{0};
+};
+
+State& GetState() {
+    static State state;
+    return state;
+}
+
+// Entries of freed assets linger until swept, cheap enough every few seconds
+constexpr uint32_t SweepInterval = 256;
+
+template <typename T>
+void SweepExpired(std::unordered_map<std::string, std::weak_ptr<T>>& assets) {
+    std::erase_if(assets, [](const auto& entry) { return entry.second.expired(); });
+}
+
+// Finds a live asset or registers a new one; true when the caller must load it
+template <typename T>
+bool Acquire(std::unordered_map<std::string, std::weak_ptr<T>>& assets, const std::string& path,
+             std::shared_ptr<T>& asset) {
+    std::weak_ptr<T>& entry = assets[path];
+    asset = entry.lock();
+    if (asset) return false;
+    asset = std::make_shared<T>();
+    entry = asset;
+    return true;
+}
+
+// Decodes on a worker and queues the upload. Only weak references cross
+// threads: the last reference must not die on a worker, as the destructor
+// deletes GL objects. Textures go on to the streamer rather than uploading
+// in one go, with their mips built here instead of on the GPU.
+template <typename T, typename Data>
+void LoadAsync(const std::shared_ptr<T>& asset, const std::string& path) {
+    State& state = GetState();
+    std::weak_ptr<T> weak = asset;
+    Jobs::Run([weak, path] {
+        if (weak.expired()) return; // Dropped before we got to it
+        auto data = std::make_shared<Data>();
+        if (!T::Decode(path, *data)) return;
+        if constexpr (std::is_same_v<T, Renderer::Texture>)
+            data->GenerateMipChain();
+
+        State& state = GetState();
+        std::lock_guard lock(state.mutex);
+        state.uploads.push_back([weak, data] {
+            std::shared_ptr<T> asset = weak.lock();
+            if (!asset) return;
+            if constexpr (std::is_same_v<T, Renderer::Texture>)
+                Renderer::TextureStreamer::Enqueue(asset, data);
+            else
+                asset->Upload(*data);
+        });
+    }, &state.counter);
+}
+
+} // namespace
+
+std::shared_ptr<Renderer::Texture> AssetManager::LoadTexture(const std::string& path) {
+    State& state = GetState();
+    std::shared_ptr<Renderer::Texture> texture;
+    {
+        std::lock_guard lock(state.mutex);
+        if (!Acquire(state.textures, path, texture)) return texture;
+    }
+
+    if (!Jobs::IsInitialized()) {
+        Renderer::Texture::Image image;
+        if (Renderer::Texture::Decode(path, image))
+            texture->Upload(image);
+        return texture;
+    }
+    LoadAsync<Renderer::Texture, Renderer::Texture::Image>(texture, path);
+    return texture;
+}
+
+std::shared_ptr<Model> AssetManager::LoadModel(const std::string& path) {
+    State& state = GetState();
+    std::shared_ptr<Model> model;
+    {
+        std::lock_guard lock(state.mutex);
+        if (!Acquire(state.models, path, model)) return model;
+    }
+
+    if (!Jobs::IsInitialized()) {
+        Model::Data data;
+        if (Model::Decode(path, data))
+            model->Upload(data);
+        return model;
+    }
+    LoadAsync<Model, Model::Data>(model, path);
+    return model;
+}
+
+void AssetManager::Update(double budgetMs) {
+    KOSMIC_PROFILE_SCOPE("AssetManager::Update");
+    State& state = GetState();
+    auto start = std::chrono::steady_clock::now();
+    auto budget = std::chrono::duration<double, std::milli>(budgetMs);
+
+    uint32_t uploaded = 0;
+    for (;;) {
+        std::function<void()> upload;
+        {
+            std::lock_guard lock(state.mutex);
+            if (state.uploads.empty()) break;
+            upload = std::move(state.uploads.front());
+            state.uploads.pop_front();
+        }
+        // Not under the lock: model uploads request their textures
+        upload();
+        ++uploaded;
+        if (std::chrono::steady_clock::now() - start >= budget) break;
+    }
+
+    std::lock_guard lock(state.mutex);
+    state.uploadsLastFrame = uploaded;
+    if (++state.updates % SweepInterval == 0) {
+        SweepExpired(state.textures);
+        SweepExpired(state.models);
+    }
+}
+
+void AssetManager::WaitAll() {
+    KOSMIC_PROFILE_SCOPE("AssetManager::WaitAll");
+    State& state = GetState();
+    // Uploads can start more loads (a model's textures), so go until all is idle
+    for (;;) {
+        if (Jobs::IsInitialized()) Jobs::Wait(state.counter);
+        {
+            std::lock_guard lock(state.mutex);
+            if (state.uploads.empty() && state.counter.IsDone() &&
+                Renderer::TextureStreamer::GetStats().pendingTextures == 0)
+                break;
+        }
+        Update(std::numeric_limits<double>::infinity());
+        Renderer::TextureStreamer::Update(std::numeric_limits<size_t>::max());
+    }
+}
+
+void AssetManager::Shutdown() {
+    State& state = GetState();
+    if (Jobs::IsInitialized()) Jobs::Wait(state.counter);
+    {
+        std::lock_guard lock(state.mutex);
+        state.uploads.clear();
+        SweepExpired(state.textures);
+        SweepExpired(state.models);
+        if (!state.textures.empty() || !state.models.empty())
+            KOSMIC_WARN("AssetManager: {} textures and {} models still referenced at shutdown",
+                        state.textures.size(), state.models.size());
+    }
+    Renderer::TextureStreamer::Shutdown();
+    Renderer::Texture::ReleasePlaceholder();
+}
+
+AssetManagerStats AssetManager::GetStats() {
+    State& state = GetState();
+    std::lock_guard lock(state.mutex);
+    AssetManagerStats stats;
+    for (const auto& [path, texture] : state.textures) stats.textures += !texture.expired();
+    for (const auto& [path, model] : state.models) stats.models += !model.expired();
+    stats.decoding = state.counter.GetPending();
+    stats.pendingUploads = static_cast<uint32_t>(state.uploads.size());
+    stats.uploadsLastFrame = state.uploadsLastFrame;
+    return stats;
+}
+
+} // namespace Kosmic::Assets
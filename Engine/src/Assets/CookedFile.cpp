@@ -0,0 +1,30 @@
+#include "Kosmic/Assets/CookedFile.hpp"
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+
+namespace Kosmic::Assets {
+
+SourceStamp GetSourceStamp(const std::string& sourcePath) {
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(sourcePath, error);
+    if (error) return {};
+    auto writeTime = std::filesystem::last_write_time(sourcePath, error);
+    if (error) return {};
+    return {size, static_cast<int64_t>(writeTime.time_since_epoch().count())};
+}
+
+bool ReadCookedHeader(const std::string& cookedPath, CookedHeader& header) {
+    std::ifstream in(cookedPath, std::ios::binary);
+    return in && in.read(reinterpret_cast<char*>(&header), sizeof(CookedHeader));
+}
+
+bool WriteSourceStamp(const std::string& cookedPath, const SourceStamp& source) {
+    std::fstream file(cookedPath, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file) return false;
+    file.seekp(offsetof(CookedHeader, source));
+    file.write(reinterpret_cast<const char*>(&source), sizeof(SourceStamp));
+    return static_cast<bool>(file);
+}
+
+} // namespace Kosmic::Assets
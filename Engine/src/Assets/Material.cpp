@@ -1,19 +1,23 @@
 #include "Kosmic/Assets/Material.hpp"
+#include "Kosmic/Assets/AssetManager.hpp"
+#include <atomic>
 
 namespace Kosmic::Assets {
 
-Material::Material() = default;
+static std::atomic<uint32_t> s_NextMaterialID{1};
+
+Material::Material() : m_ID(s_NextMaterialID++) {}
 
 void Material::SetDiffuseMap(const std::string& path) {
-    diffuseMap = std::make_shared<Renderer::Texture>(path);
+    diffuseMap = AssetManager::LoadTexture(path);
 }
 
 void Material::SetSpecularMap(const std::string& path) {
-    specularMap = std::make_shared<Renderer::Texture>(path);
+    specularMap = AssetManager::LoadTexture(path);
 }
 
 void Material::SetNormalMap(const std::string& path) {
-    normalMap = std::make_shared<Renderer::Texture>(path);
+    normalMap = AssetManager::LoadTexture(path);
 }
 
 } // namespace Kosmic::Assets
@@ -0,0 +1,121 @@
+#include "Kosmic/Assets/MeshFile.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include <filesystem>
+#include <fstream>
+
+namespace Kosmic::Assets::MeshFile {
+
+namespace {
+
+constexpr uint64_t Alignment = 16;
+
+uint64_t Align(uint64_t offset) {
+    return (offset + Alignment - 1) & ~(Alignment - 1);
+}
+
+// Lays the sections out after the header, filling in the offsets
+uint64_t Layout(Header& header) {
+    uint64_t offset = Align(sizeof(Header));
+    header.submeshOffset = offset;
+    offset = Align(offset + uint64_t(header.submeshCount) * sizeof(Submesh));
+    header.materialOffset = offset;
+    offset = Align(offset + uint64_t(header.materialCount) * sizeof(MaterialRecord));
+    header.vertexOffset = offset;
+    offset = Align(offset + uint64_t(header.vertexCount) * header.layout.stride);
+    header.indexOffset = offset;
+    return offset + header.indexSize;
+}
+
+bool InRange(uint64_t offset, uint64_t count, size_t elementSize, size_t fileSize) {
+    return offset % Alignment == 0 && offset <= fileSize && count <= (fileSize - offset) / elementSize;
+}
+
+} // namespace
+
+std::optional<View> Parse(const uint8_t* data, size_t size) {
+    if (!data || size < sizeof(Header)) return std::nullopt;
+
+    const auto* header = reinterpret_cast<const Header*>(data);
+    if (header->cooked.magic != Magic || header->cooked.version != Version || !header->layout.IsValid())
+        return std::nullopt;
+
+    if (!InRange(header->submeshOffset, header->submeshCount, sizeof(Submesh), size) ||
+        !InRange(header->materialOffset, header->materialCount, sizeof(MaterialRecord), size) ||
+        !InRange(header->vertexOffset, header->vertexCount, header->layout.stride, size) ||
+        !InRange(header->indexOffset, header->indexSize, 1, size))
+        return std::nullopt;
+
+    View view;
+    view.header = header;
+    view.submeshes = reinterpret_cast<const Submesh*>(data + header->submeshOffset);
+    view.materials = reinterpret_cast<const MaterialRecord*>(data + header->materialOffset);
+    view.vertices = data + header->vertexOffset;
+    view.indices = data + header->indexOffset;
+
+    // Submeshes index into the blobs, a bad range would read past them on upload
+    for (uint32_t i = 0; i < header->submeshCount; ++i) {
+        const Submesh& submesh = view.submeshes[i];
+        uint32_t indexSize = static_cast<uint32_t>(submesh.indexType);
+        if (uint64_t(submesh.firstVertex) + submesh.vertexCount > header->vertexCount ||
+            (indexSize != 2 && indexSize != 4) || submesh.indexOffset % indexSize != 0 ||
+            submesh.indexOffset + uint64_t(submesh.indexCount) * indexSize > header->indexSize ||
+            (submesh.material >= header->materialCount && header->materialCount > 0))
+            return std::nullopt;
+    }
+    return view;
+}
+
+View MakeView(const MeshData& data, const Header& header) {
+    return {&header, data.submeshes.data(), data.materials.data(), data.vertices.data(), data.indices.data()};
+}
+
+bool Write(const std::string& path, const MeshData& data, const SourceStamp& source) {
+    Header header;
+    header.submeshCount = static_cast<uint32_t>(data.submeshes.size());
+    header.materialCount = static_cast<uint32_t>(data.materials.size());
+    header.layout = data.layout;
+    header.vertexCount = data.layout.stride ? static_cast<uint32_t>(data.vertices.size() / data.layout.stride) : 0;
+    header.indexSize = static_cast<uint32_t>(data.indices.size());
+    header.cooked.source = source;
+    uint64_t fileSize = Layout(header);
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            KOSMIC_ERROR("Failed to write cooked mesh: {}", path);
+            return false;
+        }
+
+        auto section = [&](uint64_t offset, const void* bytes, size_t size) {
+            // Zero the alignment gap before the section
+            static constexpr char padding[Alignment]{};
+            out.write(padding, static_cast<std::streamsize>(offset - static_cast<uint64_t>(out.tellp())));
+            out.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+        };
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        section(header.submeshOffset, data.submeshes.data(), data.submeshes.size() * sizeof(Submesh));
+        section(header.materialOffset, data.materials.data(), data.materials.size() * sizeof(MaterialRecord));
+        section(header.vertexOffset, data.vertices.data(), data.vertices.size());
+        section(header.indexOffset, data.indices.data(), data.indices.size());
+
+        if (!out || static_cast<uint64_t>(out.tellp()) != fileSize) {
+            KOSMIC_ERROR("Failed to write cooked mesh: {}", path);
+            out.close();
+            std::filesystem::remove(temporary);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        KOSMIC_ERROR("Failed to write cooked mesh: {} ({})", path, error.message());
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+} // namespace Kosmic::Assets::MeshFile
@@ -0,0 +1,253 @@
+#include "Kosmic/Assets/MeshOptimizer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <string_view>
+#include <unordered_map>
+
+namespace Kosmic::Assets::MeshOptimizer {
+
+namespace {
+
+// Triangles around each vertex, as offsets into one flat array
+struct Adjacency {
+    std::vector<uint32_t> offsets;   // vertexCount + 1
+    std::vector<uint32_t> triangles;
+
+    Adjacency(const std::vector<uint32_t>& indices, uint32_t vertexCount)
+        : offsets(vertexCount + 1, 0), triangles(indices.size()) {
+        for (uint32_t index : indices) offsets[index + 1]++;
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i) triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    uint32_t Count(uint32_t vertex) const { return offsets[vertex + 1] - offsets[vertex]; }
+    const uint32_t* Begin(uint32_t vertex) const { return triangles.data() + offsets[vertex]; }
+};
+
+// Triangles where the FIFO cache misses all three vertices: the list can be
+// cut there without costing any extra transforms
+std::vector<uint32_t> FindHardBoundaries(const std::vector<uint32_t>& indices, uint32_t vertexCount) {
+    std::vector<uint32_t> boundaries;
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t time = CacheSize + 1;
+    for (size_t triangle = 0; triangle < indices.size() / 3; ++triangle) {
+        uint32_t misses = 0;
+        for (int corner = 0; corner < 3; ++corner) {
+            uint32_t vertex = indices[triangle * 3 + corner];
+            if (time - timestamps[vertex] > CacheSize) {
+                timestamps[vertex] = time++;
+                misses++;
+            }
+        }
+        if (misses == 3) boundaries.push_back(static_cast<uint32_t>(triangle));
+    }
+    return boundaries;
+}
+
+} // namespace
+
+uint32_t WeldVertices(std::vector<Renderer::Vertex>& vertices, std::vector<uint32_t>& indices) {
+    // Hashing the raw bytes: only exact duplicates merge, so nothing visible changes
+    auto bytes = [](const Renderer::Vertex& vertex) {
+        return std::string_view(reinterpret_cast<const char*>(&vertex), sizeof(Renderer::Vertex));
+    };
+    std::unordered_map<std::string_view, uint32_t> unique;
+    unique.reserve(vertices.size());
+
+    std::vector<uint32_t> remap(vertices.size());
+    uint32_t count = 0;
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        auto [it, inserted] = unique.try_emplace(bytes(vertices[i]), count);
+        if (inserted) {
+            // Moving down never overwrites a vertex still to be read, but the
+            // key points at the old slot, so re-key it at its new place
+            if (count != i) {
+                unique.erase(it);
+                vertices[count] = vertices[i];
+                unique.emplace(bytes(vertices[count]), count);
+            }
+            count++;
+        }
+        remap[i] = inserted ? count - 1 : it->second;
+    }
+
+    vertices.resize(count);
+    for (uint32_t& index : indices) index = remap[index];
+    return count;
+}
+
+void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    Adjacency adjacency(indices, vertexCount);
+    std::vector<uint32_t> live(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; ++v) live[v] = adjacency.Count(v);
+
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnds; // Recently used vertices, to fall back on
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+
+    uint32_t time = CacheSize + 1;
+    uint32_t cursor = 0;            // Next vertex to try once the dead end stack is empty
+    int64_t fan = 0;                // Vertex whose triangles are emitted next
+
+    while (fan >= 0) {
+        candidates.clear();
+        const uint32_t* triangles = adjacency.Begin(static_cast<uint32_t>(fan));
+        for (uint32_t i = 0; i < adjacency.Count(static_cast<uint32_t>(fan)); ++i) {
+            uint32_t triangle = triangles[i];
+            if (emitted[triangle]) continue;
+            emitted[triangle] = true;
+            for (int corner = 0; corner < 3; ++corner) {
+                uint32_t vertex = indices[triangle * 3 + corner];
+                output.push_back(vertex);
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                live[vertex]--;
+                if (time - timestamps[vertex] > CacheSize) timestamps[vertex] = time++;
+            }
+        }
+
+        // Prefer the candidate that stays in the cache while its remaining
+        // triangles are emitted, and among those the oldest one
+        fan = -1;
+        int64_t best = -1;
+        for (uint32_t vertex : candidates) {
+            if (live[vertex] == 0) continue;
+            int64_t priority = 0;
+            if (time - timestamps[vertex] + 2 * live[vertex] <= CacheSize) priority = time - timestamps[vertex];
+            if (priority > best) {
+                best = priority;
+                fan = vertex;
+            }
+        }
+        if (fan >= 0) continue;
+
+        while (!deadEnds.empty() && fan < 0) {
+            uint32_t vertex = deadEnds.back();
+            deadEnds.pop_back();
+            if (live[vertex] > 0) fan = vertex;
+        }
+        while (fan < 0 && cursor < vertexCount) {
+            if (live[cursor] > 0) fan = cursor;
+            cursor++;
+        }
+    }
+    indices = std::move(output);
+}
+
+void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Renderer::Vertex>& vertices, float threshold) {
+    size_t triangleCount = indices.size() / 3;
+    uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+    if (triangleCount < 2) return;
+
+    std::vector<uint32_t> boundaries = FindHardBoundaries(indices, vertexCount);
+    // A first triangle with a repeated index never misses three times, and
+    // the triangles before the first boundary would be left out
+    if (boundaries.empty() || boundaries.front() != 0) boundaries.insert(boundaries.begin(), 0);
+    if (boundaries.size() < 2) return;
+    boundaries.push_back(static_cast<uint32_t>(triangleCount));
+
+    // Area weighted centroid of the whole mesh and per cluster
+    struct Cluster {
+        uint32_t first, last;
+        Math::Vector3 centroid, normal;
+        float sort;
+    };
+    std::vector<Cluster> clusters;
+    Math::Vector3 meshCentroid;
+    float meshArea = 0.0f;
+    for (size_t c = 0; c + 1 < boundaries.size(); ++c) {
+        Cluster cluster{boundaries[c], boundaries[c + 1], {}, {}, 0.0f};
+        float area = 0.0f;
+        for (uint32_t t = cluster.first; t < cluster.last; ++t) {
+            const Math::Vector3& a = vertices[indices[t * 3]].Position;
+            const Math::Vector3& b = vertices[indices[t * 3 + 1]].Position;
+            const Math::Vector3& p = vertices[indices[t * 3 + 2]].Position;
+            Math::Vector3 normal = (b - a).Cross(p - a); // Length is twice the area
+            float weight = std::sqrt(normal.Dot(normal));
+            cluster.centroid += (a + b + p) * (weight / 3.0f);
+            cluster.normal += normal;
+            area += weight;
+        }
+        meshCentroid += cluster.centroid;
+        meshArea += area;
+        if (area > 0.0f) cluster.centroid = cluster.centroid / area;
+        float length = std::sqrt(cluster.normal.Dot(cluster.normal));
+        if (length > 0.0f) cluster.normal = cluster.normal / length;
+        clusters.push_back(cluster);
+    }
+    if (meshArea > 0.0f) meshCentroid = meshCentroid / meshArea;
+
+    // Clusters facing away from the center tend to occlude the rest
+    for (Cluster& cluster : clusters) cluster.sort = (cluster.centroid - meshCentroid).Dot(cluster.normal);
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.sort > b.sort; });
+
+    std::vector<uint32_t> sorted;
+    sorted.reserve(indices.size());
+    for (const Cluster& cluster : clusters)
+        sorted.insert(sorted.end(), indices.begin() + cluster.first * 3, indices.begin() + cluster.last * 3);
+
+    float before = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount).GetACMR();
+    float after = AnalyzeVertexCache(sorted.data(), sorted.size(), vertexCount).GetACMR();
+    if (sorted.size() == indices.size() && after <= before * threshold) indices = std::move(sorted);
+}
+
+void OptimizeVertexFetch(std::vector<Renderer::Vertex>& vertices, std::vector<uint32_t>& indices) {
+    constexpr uint32_t Unused = UINT32_MAX;
+    std::vector<uint32_t> remap(vertices.size(), Unused);
+    std::vector<Renderer::Vertex> ordered;
+    ordered.reserve(vertices.size());
+    for (uint32_t& index : indices) {
+        if (remap[index] == Unused) {
+            remap[index] = static_cast<uint32_t>(ordered.size());
+            ordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices = std::move(ordered);
+}
+
+VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, uint32_t vertexCount,
+                                    uint32_t cacheSize) {
+    VertexCacheStats stats;
+    if (indexCount < 3 || vertexCount == 0) return stats;
+
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    std::vector<bool> used(vertexCount, false);
+    uint32_t time = cacheSize + 1;
+    stats.triangles = static_cast<uint32_t>(indexCount / 3);
+    for (size_t i = 0; i < stats.triangles * size_t(3); ++i) {
+        uint32_t vertex = indices[i];
+        if (time - timestamps[vertex] > cacheSize) {
+            timestamps[vertex] = time++;
+            stats.transforms++;
+        }
+        if (!used[vertex]) {
+            used[vertex] = true;
+            stats.vertices++;
+        }
+    }
+    return stats;
+}
+
+Result Optimize(std::vector<Renderer::Vertex>& vertices, std::vector<uint32_t>& indices, const Options& options) {
+    Result result;
+    result.before = AnalyzeVertexCache(indices.data(), indices.size(), static_cast<uint32_t>(vertices.size()));
+
+    uint32_t vertexCount = WeldVertices(vertices, indices);
+    OptimizeVertexCache(indices, vertexCount);
+    if (options.overdraw) OptimizeOverdraw(indices, vertices, options.overdrawThreshold);
+    OptimizeVertexFetch(vertices, indices);
+
+    result.after = AnalyzeVertexCache(indices.data(), indices.size(), static_cast<uint32_t>(vertices.size()));
+    return result;
+}
+
+} // namespace Kosmic::Assets::MeshOptimizer
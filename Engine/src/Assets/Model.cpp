@@ -1,14 +1,116 @@
 #include "Kosmic/Assets/Model.hpp"
 #include "Kosmic/Core/Logging.hpp"
+#include "Kosmic/Core/Profiler.hpp"
+#include "Kosmic/Core/MappedFile.hpp"
+#include "Kosmic/Renderer/Renderer3D.hpp"
+#include <cstring>
 #include <filesystem>
+#include <string_view>
 
 namespace Kosmic::Assets {
 
 Model::Model(const std::string& path) {
-    LoadModel(path);
+    KOSMIC_PROFILE_SCOPE("Model::Load");
+    Data data;
+    if (Decode(path, data))
+        Upload(data);
 }
 
-void Model::LoadModel(const std::string& path) {
+bool Model::Decode(const std::string& path, Data& data) {
+    KOSMIC_PROFILE_SCOPE("Model::Decode");
+    data.directory = std::filesystem::path(path).parent_path().string();
+
+    if (std::filesystem::path(path).extension() == MeshFile::Extension) {
+        if (DecodeCooked(path, nullptr, data)) return true;
+        KOSMIC_ERROR("Failed to load cooked mesh: {}", path);
+        return false;
+    }
+
+    // A cooked file without its source is fine, e.g. when only cooked assets ship
+    std::string cookedPath = GetCookedPath(path, MeshFile::Extension);
+    SourceStamp source = GetSourceStamp(path);
+    if (DecodeCooked(cookedPath, source.IsValid() ? &source : nullptr, data))
+        return true;
+
+    if (!Import(path, data.imported)) return false;
+    if (MeshFile::Write(cookedPath, data.imported, source))
+        KOSMIC_INFO("Cooked {} -> {}", path, cookedPath);
+
+    data.header.submeshCount = static_cast<uint32_t>(data.imported.submeshes.size());
+    data.header.materialCount = static_cast<uint32_t>(data.imported.materials.size());
+    data.header.layout = data.imported.layout;
+    data.view = MeshFile::MakeView(data.imported, data.header);
+    return true;
+}
+
+bool Model::DecodeCooked(const std::string& cookedPath, const SourceStamp* source, Data& data) {
+    if (!data.file.Open(cookedPath)) return false;
+
+    std::optional<MeshFile::View> view = MeshFile::Parse(data.file.GetData(), data.file.GetSize());
+    if (!view) {
+        KOSMIC_WARN("Ignoring invalid or outdated cooked mesh: {}", cookedPath);
+        data.file.Close();
+        return false;
+    }
+    if (source && view->header->cooked.source != *source) {
+        KOSMIC_INFO("Cooked mesh is stale, reimporting: {}", cookedPath);
+        data.file.Close();
+        return false;
+    }
+
+    data.view = *view;
+    return true;
+}
+
+void Model::Upload(const Data& data) {
+    KOSMIC_PROFILE_SCOPE("Model::Upload");
+    const MeshFile::View& view = data.view;
+    m_Directory = data.directory;
+
+    std::vector<std::shared_ptr<Material>> materials;
+    materials.reserve(view.header->materialCount);
+    for (uint32_t i = 0; i < view.header->materialCount; ++i) {
+        const MeshFile::MaterialRecord& record = view.materials[i];
+        auto material = std::make_shared<Material>();
+        material->ambient = record.ambient;
+        material->diffuse = record.diffuse;
+        material->specular = record.specular;
+        material->shininess = record.shininess;
+        material->opacity = record.opacity;
+        if (record.diffuseMap[0] != '\0') {
+            std::string_view map(record.diffuseMap, strnlen(record.diffuseMap, MeshFile::MaxPath));
+            material->SetDiffuseMap(m_Directory + "/" + std::string(map));
+        }
+        if (record.normalMap[0] != '\0') {
+            std::string_view map(record.normalMap, strnlen(record.normalMap, MeshFile::MaxPath));
+            material->SetNormalMap(m_Directory + "/" + std::string(map));
+        }
+        materials.push_back(std::move(material));
+    }
+
+    // Meshes sharing a source material share the Material too
+    m_Meshes.reserve(view.header->submeshCount);
+    for (uint32_t i = 0; i < view.header->submeshCount; ++i) {
+        const MeshFile::Submesh& submesh = view.submeshes[i];
+        m_Meshes.push_back(std::make_shared<Renderer::Mesh>(
+            view.vertices + size_t(submesh.firstVertex) * view.header->layout.stride, submesh.vertexCount,
+            view.header->layout,
+            view.indices + submesh.indexOffset, submesh.indexCount, submesh.indexType,
+            submesh.bounds, submesh.boundingSphere));
+        m_Materials.push_back(materials.empty() ? std::make_shared<Material>() : materials[submesh.material]);
+        m_Bounds.Expand(submesh.bounds);
+    }
+    m_Loaded = true;
+}
+
+bool Model::Cook(const std::string& sourcePath, const std::string& cookedPath) {
+    MeshFile::MeshData data;
+    if (!Import(sourcePath, data)) return false;
+    return MeshFile::Write(cookedPath, data, GetSourceStamp(sourcePath));
+}
+
+bool Model::Import(const std::string& path, MeshFile::MeshData& data) {
+    KOSMIC_PROFILE_SCOPE("Model::Import");
     Assimp::Importer importer;
     const aiScene* scene = importer.ReadFile(path, 
         aiProcess_Triangulate | 
@@ -18,39 +120,47 @@ void Model::LoadModel(const std::string& path) {
 
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
         KOSMIC_ERROR("ASSIMP ERROR: {}", importer.GetErrorString());
-        return;
+        return false;
     }
 
-    m_Directory = std::filesystem::path(path).parent_path().string();
-    ProcessNode(scene->mRootNode, scene);
+    data.materials.reserve(scene->mNumMaterials);
+    for (unsigned int i = 0; i < scene->mNumMaterials; i++)
+        data.materials.push_back(ProcessMaterial(scene->mMaterials[i]));
+
+    MeshOptimizer::Result stats;
+    std::vector<Renderer::Vertex> vertices;
+    ProcessNode(scene->mRootNode, scene, data, vertices, stats);
+    KOSMIC_INFO("Optimized {}: {} -> {} vertices, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", path,
+                stats.before.vertices, stats.after.vertices, stats.before.GetACMR(), stats.after.GetACMR(),
+                stats.before.GetATVR(), stats.after.GetATVR());
+
+    data.layout = Renderer::VertexLayout::Choose(vertices.data(), static_cast<uint32_t>(vertices.size()));
+    data.vertices.resize(vertices.size() * data.layout.stride);
+    data.layout.Pack(vertices.data(), static_cast<uint32_t>(vertices.size()), data.vertices.data());
+    KOSMIC_INFO("Packed {}: {} byte vertices ({} as floats)", path, data.layout.stride, sizeof(Renderer::Vertex));
+    return true;
 }
 
-void Model::ProcessNode(aiNode* node, const aiScene* scene) {
+void Model::ProcessNode(aiNode* node, const aiScene* scene, MeshFile::MeshData& data,
+                        std::vector<Renderer::Vertex>& vertices, MeshOptimizer::Result& stats) {
     // Process meshes in current node
-    for(unsigned int i = 0; i < node->mNumMeshes; i++) {
-        aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-        m_Meshes.push_back(ProcessMesh(mesh, scene));
-        
-        // Process material
-        if (mesh->mMaterialIndex >= 0) {
-            aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-            m_Materials.push_back(ProcessMaterial(material, scene));
-        }
-    }
+    for(unsigned int i = 0; i < node->mNumMeshes; i++)
+        stats += ProcessMesh(scene->mMeshes[node->mMeshes[i]], data, vertices);
 
     // Process child nodes
     for(unsigned int i = 0; i < node->mNumChildren; i++) {
-        ProcessNode(node->mChildren[i], scene);
+        ProcessNode(node->mChildren[i], scene, data, vertices, stats);
     }
 }
 
-std::shared_ptr<Renderer::Mesh> Model::ProcessMesh(aiMesh* mesh, const aiScene* scene) {
-    std::vector<Renderer::Vertex> vertices;
-    std::vector<uint32_t> indices;
+MeshOptimizer::Result Model::ProcessMesh(aiMesh* mesh, MeshFile::MeshData& data,
+                                         std::vector<Renderer::Vertex>& allVertices) {
+    MeshFile::Submesh submesh;
+    submesh.material = mesh->mMaterialIndex;
 
-    // Process vertices
+    std::vector<Renderer::Vertex> vertices(mesh->mNumVertices);
     for(unsigned int i = 0; i < mesh->mNumVertices; i++) {
-        Renderer::Vertex vertex;
+        Renderer::Vertex& vertex = vertices[i];
         
         // > Convert Assimp positions to mesh vertices
         vertex.Position = {
@@ -59,64 +169,105 @@ std::shared_ptr<Renderer::Mesh> Model::ProcessMesh(aiMesh* mesh, const aiScene*
             mesh->mVertices[i].z
         };
 
-        if(mesh->mNormals)
-            vertex.Normal = {
-                mesh->mNormals[i].x,
-                mesh->mNormals[i].y,
-                mesh->mNormals[i].z
-            };
-
-        if(mesh->mTextureCoords[0])
-            vertex.TexCoords = {
-                mesh->mTextureCoords[0][i].x,
-                mesh->mTextureCoords[0][i].y
-            };
-
-        vertex.Color = {1.0f, 1.0f, 1.0f};
-        vertices.push_back(vertex);
+        vertex.Normal = mesh->mNormals
+            ? Math::Vector3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z)
+            : Math::Vector3(0.0f);
+
+        vertex.TexCoords = mesh->mTextureCoords[0]
+            ? Math::Vector2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y)
+            : Math::Vector2();
+
+        // White unless the model has vertex colors, which then get their own stream
+        vertex.Color = mesh->mColors[0]
+            ? Math::Vector3(mesh->mColors[0][i].r, mesh->mColors[0][i].g, mesh->mColors[0][i].b)
+            : Math::Vector3(1.0f);
     }
 
-    // Process indices
+    // Process indices, triangulated so every face has three. Points and
+    // lines that slipped through would throw the optimizer off, skip them.
+    std::vector<uint32_t> indices;
+    indices.reserve(size_t(mesh->mNumFaces) * 3);
     for(unsigned int i = 0; i < mesh->mNumFaces; i++) {
-        aiFace face = mesh->mFaces[i];
-        for(unsigned int j = 0; j < face.mNumIndices; j++)
-            indices.push_back(face.mIndices[j]);
+        const aiFace& face = mesh->mFaces[i];
+        if (face.mNumIndices == 3)
+            indices.insert(indices.end(), face.mIndices, face.mIndices + 3);
+    }
+
+    // Every face corner is its own vertex coming out of Assimp
+    MeshOptimizer::Result stats = MeshOptimizer::Optimize(vertices, indices);
+    // Reordering must never drop a triangle, degenerate ones included
+    if (stats.after.triangles != stats.before.triangles)
+        KOSMIC_ERROR("Optimizing {} lost triangles: {} -> {}", mesh->mName.C_Str(), stats.before.triangles,
+                     stats.after.triangles);
+
+    submesh.firstVertex = static_cast<uint32_t>(allVertices.size());
+    submesh.vertexCount = static_cast<uint32_t>(vertices.size());
+    submesh.indexCount = static_cast<uint32_t>(indices.size());
+    submesh.indexType = vertices.size() <= 65536 ? Renderer::IndexType::UInt16 : Renderer::IndexType::UInt32;
+    allVertices.insert(allVertices.end(), vertices.begin(), vertices.end());
+
+    // Written in place at the index size's alignment
+    size_t indexSize = static_cast<size_t>(submesh.indexType);
+    size_t offset = (data.indices.size() + indexSize - 1) & ~(indexSize - 1);
+    submesh.indexOffset = static_cast<uint32_t>(offset);
+    data.indices.resize(offset + indices.size() * indexSize);
+    if (submesh.indexType == Renderer::IndexType::UInt16) {
+        for (size_t i = 0; i < indices.size(); ++i) {
+            uint16_t index = static_cast<uint16_t>(indices[i]);
+            std::memcpy(data.indices.data() + offset + i * 2, &index, 2);
+        }
+    } else {
+        std::memcpy(data.indices.data() + offset, indices.data(), indices.size() * 4);
     }
 
-    return std::make_shared<Renderer::Mesh>(vertices, indices);
+    Renderer::Mesh::ComputeBounds(vertices.data(), submesh.vertexCount, submesh.bounds, submesh.boundingSphere);
+    data.submeshes.push_back(submesh);
+    return stats;
 }
 
-std::shared_ptr<Material> Model::ProcessMaterial(aiMaterial* material, const aiScene* scene) {
-    auto mat = std::make_shared<Material>();
+MeshFile::MaterialRecord Model::ProcessMaterial(aiMaterial* material) {
+    MeshFile::MaterialRecord record;
 
     aiColor3D color(0.f);
     float shininess;
 
     if(material->Get(AI_MATKEY_COLOR_AMBIENT, color) == AI_SUCCESS)
-        mat->ambient = {color.r, color.g, color.b};
+        record.ambient = {color.r, color.g, color.b};
     if(material->Get(AI_MATKEY_COLOR_DIFFUSE, color) == AI_SUCCESS)
-        mat->diffuse = {color.r, color.g, color.b};
+        record.diffuse = {color.r, color.g, color.b};
     if(material->Get(AI_MATKEY_COLOR_SPECULAR, color) == AI_SUCCESS)
-        mat->specular = {color.r, color.g, color.b};
+        record.specular = {color.r, color.g, color.b};
     if(material->Get(AI_MATKEY_SHININESS, shininess) == AI_SUCCESS)
-        mat->shininess = shininess;
+        record.shininess = shininess;
 
-    // Load textures
-    aiString str;
-    if(material->GetTextureCount(aiTextureType_DIFFUSE) > 0) {
-        material->GetTexture(aiTextureType_DIFFUSE, 0, &str);
-        mat->SetDiffuseMap(m_Directory + "/" + str.C_Str());
-    }
+    // Texture paths stay relative, they are resolved against the model directory on load
+    auto copyTexture = [&](aiTextureType type, char* path) {
+        if (material->GetTextureCount(type) == 0) return false;
+        aiString str;
+        material->GetTexture(type, 0, &str);
+        size_t length = std::strlen(str.C_Str());
+        if (length < MeshFile::MaxPath)
+            std::memcpy(path, str.C_Str(), length);
+        else
+            KOSMIC_WARN("Texture path too long, skipped: {}", str.C_Str());
+        return true;
+    };
+    copyTexture(aiTextureType_DIFFUSE, record.diffuseMap);
+    // OBJ's map_bump/bump comes in as a height map, but is a normal map in practice
+    if (!copyTexture(aiTextureType_NORMALS, record.normalMap))
+        copyTexture(aiTextureType_HEIGHT, record.normalMap);
 
-    return mat;
+    return record;
 }
 
 void Model::Draw(const std::shared_ptr<Renderer::Shader>& shader) {
+    KOSMIC_PROFILE_SCOPE("Model::Draw");
     shader->Bind();
+    GLint modelLocation = shader->GetUniformLocation("model");
     // Draw each mesh with its material
     for(size_t i = 0; i < m_Meshes.size(); i++) {
         // Set model matrix for this mesh
-        shader->SetMat4("model", m_Meshes[i]->GetTransform());
+        shader->SetMat4(modelLocation, m_Meshes[i]->GetTransform());
         
         if(i < m_Materials.size() && m_Materials[i]->diffuseMap)
             m_Materials[i]->diffuseMap->Bind(0);
@@ -129,4 +280,11 @@ void Model::Draw(const std::shared_ptr<Renderer::Shader>& shader) {
     shader->Unbind();
 }
 
+void Model::Submit(Renderer::Renderer3D& renderer, const Math::Mat4& transform) const {
+    for (size_t i = 0; i < m_Meshes.size(); i++) {
+        std::shared_ptr<Material> material = i < m_Materials.size() ? m_Materials[i] : nullptr;
+        renderer.Submit(m_Meshes[i], material, transform * m_Meshes[i]->GetTransform());
+    }
+}
+
 } // namespace Kosmic::Assets
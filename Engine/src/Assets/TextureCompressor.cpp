@@ -0,0 +1,463 @@
+#include "Kosmic/Assets/TextureCompressor.hpp"
+#include "Kosmic/Core/Jobs.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Kosmic::Assets::TextureCompressor {
+
+namespace {
+
+struct Color {
+    float r{0.0f}, g{0.0f}, b{0.0f};
+};
+
+uint16_t Pack565(const Color& color) {
+    auto quantize = [](float value, float levels) {
+        return static_cast<uint16_t>(std::clamp(value, 0.0f, 255.0f) * levels / 255.0f + 0.5f);
+    };
+    return static_cast<uint16_t>(quantize(color.r, 31.0f) << 11 | quantize(color.g, 63.0f) << 5 | quantize(color.b, 31.0f));
+}
+
+// Expanded the way the hardware does it, so the palette matches what gets sampled
+Color Unpack565(uint16_t packed) {
+    uint32_t r = packed >> 11 & 31, g = packed >> 5 & 63, b = packed & 31;
+    return {float(r << 3 | r >> 2), float(g << 2 | g >> 4), float(b << 3 | b >> 2)};
+}
+
+float Distance(const Color& a, const uint8_t* texel) {
+    float dr = a.r - texel[0], dg = a.g - texel[1], db = a.b - texel[2];
+    return dr * dr + dg * dg + db * db;
+}
+
+// Picks the nearest of the four palette entries per texel, returns the squared error
+float SelectIndices(uint16_t c0, uint16_t c1, const uint8_t* rgba, uint32_t& indices) {
+    Color a = Unpack565(c0), b = Unpack565(c1);
+    Color palette[4] = {
+        a, b,
+        {(2 * a.r + b.r) / 3, (2 * a.g + b.g) / 3, (2 * a.b + b.b) / 3},
+        {(a.r + 2 * b.r) / 3, (a.g + 2 * b.g) / 3, (a.b + 2 * b.b) / 3},
+    };
+
+    indices = 0;
+    float error = 0.0f;
+    for (int i = 0; i < 16; ++i) {
+        uint32_t best = 0;
+        float bestDistance = Distance(palette[0], rgba + i * 4);
+        for (uint32_t p = 1; p < 4; ++p) {
+            float distance = Distance(palette[p], rgba + i * 4);
+            if (distance < bestDistance) {
+                best = p;
+                bestDistance = distance;
+            }
+        }
+        indices |= best << (i * 2);
+        error += bestDistance;
+    }
+    return error;
+}
+
+// Least squares endpoints for the given indices
+bool RefineEndpoints(const uint8_t* rgba, uint32_t indices, Color& a, Color& b) {
+    static constexpr float Weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+    float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+    Color ax, bx;
+    for (int i = 0; i < 16; ++i) {
+        float wa = Weights[indices >> (i * 2) & 3], wb = 1.0f - wa;
+        const uint8_t* texel = rgba + i * 4;
+        aa += wa * wa;
+        bb += wb * wb;
+        ab += wa * wb;
+        ax.r += wa * texel[0]; ax.g += wa * texel[1]; ax.b += wa * texel[2];
+        bx.r += wb * texel[0]; bx.g += wb * texel[1]; bx.b += wb * texel[2];
+    }
+
+    float determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) < 1e-6f) return false;
+    float inverse = 1.0f / determinant;
+    a = {(ax.r * bb - bx.r * ab) * inverse, (ax.g * bb - bx.g * ab) * inverse, (ax.b * bb - bx.b * ab) * inverse};
+    b = {(bx.r * aa - ax.r * ab) * inverse, (bx.g * aa - ax.g * ab) * inverse, (bx.b * aa - ax.b * ab) * inverse};
+    return true;
+}
+
+// Four colour mode needs color0 > color1; equal endpoints use index 0 throughout
+float EncodeEndpoints(const uint8_t* rgba, const Color& a, const Color& b,
+                      uint16_t& c0, uint16_t& c1, uint32_t& indices) {
+    c0 = Pack565(a);
+    c1 = Pack565(b);
+    if (c0 < c1) std::swap(c0, c1);
+    if (c0 == c1) {
+        indices = 0;
+        float error = 0.0f;
+        Color color = Unpack565(c0);
+        for (int i = 0; i < 16; ++i) error += Distance(color, rgba + i * 4);
+        return error;
+    }
+    return SelectIndices(c0, c1, rgba, indices);
+}
+
+void EncodeColorBlock(const uint8_t* rgba, uint8_t* block) {
+    // Principal axis of the colours by power iteration on their covariance
+    Color mean, low{255, 255, 255}, high;
+    for (int i = 0; i < 16; ++i) {
+        const uint8_t* texel = rgba + i * 4;
+        mean.r += texel[0]; mean.g += texel[1]; mean.b += texel[2];
+        low = {std::min(low.r, float(texel[0])), std::min(low.g, float(texel[1])), std::min(low.b, float(texel[2]))};
+        high = {std::max(high.r, float(texel[0])), std::max(high.g, float(texel[1])), std::max(high.b, float(texel[2]))};
+    }
+    mean = {mean.r / 16, mean.g / 16, mean.b / 16};
+
+    float covariance[6]{}; // rr rg rb gg gb bb
+    for (int i = 0; i < 16; ++i) {
+        float r = rgba[i * 4] - mean.r, g = rgba[i * 4 + 1] - mean.g, b = rgba[i * 4 + 2] - mean.b;
+        covariance[0] += r * r; covariance[1] += r * g; covariance[2] += r * b;
+        covariance[3] += g * g; covariance[4] += g * b; covariance[5] += b * b;
+    }
+
+    Color axis{high.r - low.r, high.g - low.g, high.b - low.b};
+    for (int iteration = 0; iteration < 4; ++iteration) {
+        Color next{
+            covariance[0] * axis.r + covariance[1] * axis.g + covariance[2] * axis.b,
+            covariance[1] * axis.r + covariance[3] * axis.g + covariance[4] * axis.b,
+            covariance[2] * axis.r + covariance[4] * axis.g + covariance[5] * axis.b,
+        };
+        float length = std::max({std::fabs(next.r), std::fabs(next.g), std::fabs(next.b)});
+        if (length < 1e-4f) break;
+        axis = {next.r / length, next.g / length, next.b / length};
+    }
+
+    // Endpoints at the extreme projections onto the axis
+    float minDot = 1e30f, maxDot = -1e30f;
+    const uint8_t* minTexel = rgba;
+    const uint8_t* maxTexel = rgba;
+    for (int i = 0; i < 16; ++i) {
+        const uint8_t* texel = rgba + i * 4;
+        float dot = texel[0] * axis.r + texel[1] * axis.g + texel[2] * axis.b;
+        if (dot < minDot) { minDot = dot; minTexel = texel; }
+        if (dot > maxDot) { maxDot = dot; maxTexel = texel; }
+    }
+
+    uint16_t c0 = 0, c1 = 0;
+    uint32_t indices = 0;
+    Color a{float(maxTexel[0]), float(maxTexel[1]), float(maxTexel[2])};
+    Color b{float(minTexel[0]), float(minTexel[1]), float(minTexel[2])};
+    float error = EncodeEndpoints(rgba, a, b, c0, c1, indices);
+
+    // One least squares pass usually shaves a good part off the error
+    if (c0 != c1 && RefineEndpoints(rgba, indices, a, b)) {
+        uint16_t r0 = 0, r1 = 0;
+        uint32_t refined = 0;
+        if (EncodeEndpoints(rgba, a, b, r0, r1, refined) < error) {
+            c0 = r0;
+            c1 = r1;
+            indices = refined;
+        }
+    }
+
+    std::memcpy(block, &c0, 2);
+    std::memcpy(block + 2, &c1, 2);
+    std::memcpy(block + 4, &indices, 4);
+}
+
+// BC7 mode 6: one subset, RGBA endpoints of 7 bits plus a shared low bit
+// (p-bit) each, and 4-bit indices into 16 interpolated colours
+constexpr uint32_t BC7Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+struct Endpoints {
+    uint8_t low[2][4];  // 7-bit values of both endpoints
+    uint8_t pbit[2];
+};
+
+uint8_t ExpandBC7(const Endpoints& endpoints, int e, int channel) {
+    return static_cast<uint8_t>(endpoints.low[e][channel] << 1 | endpoints.pbit[e]);
+}
+
+// Nearest 7-bit value for the given p-bit
+void QuantizeBC7(const float* color, uint8_t pbit, uint8_t* low) {
+    for (int c = 0; c < 4; ++c)
+        low[c] = static_cast<uint8_t>(std::clamp((color[c] - pbit) * 0.5f + 0.5f, 0.0f, 127.0f));
+}
+
+// Picks the nearest of the 16 palette entries per texel, returns the squared error
+float SelectBC7Indices(const uint8_t* rgba, const Endpoints& endpoints, uint8_t* indices) {
+    int palette[16][4];
+    for (int c = 0; c < 4; ++c) {
+        int a = ExpandBC7(endpoints, 0, c), b = ExpandBC7(endpoints, 1, c);
+        for (int w = 0; w < 16; ++w)
+            palette[w][c] = (a * int(64 - BC7Weights[w]) + b * int(BC7Weights[w]) + 32) >> 6;
+    }
+
+    float error = 0.0f;
+    for (int i = 0; i < 16; ++i) {
+        const uint8_t* texel = rgba + i * 4;
+        int bestDistance = INT32_MAX;
+        for (int w = 0; w < 16; ++w) {
+            int distance = 0;
+            for (int c = 0; c < 4; ++c) distance += (palette[w][c] - texel[c]) * (palette[w][c] - texel[c]);
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                indices[i] = static_cast<uint8_t>(w);
+            }
+        }
+        error += float(bestDistance);
+    }
+    return error;
+}
+
+// Tries the four p-bit pairs for the endpoints a and b, keeps the best
+float FitBC7(const uint8_t* rgba, const float* a, const float* b, Endpoints& best, uint8_t* bestIndices) {
+    float bestError = 1e30f;
+    for (uint8_t pbits = 0; pbits < 4; ++pbits) {
+        Endpoints endpoints;
+        endpoints.pbit[0] = pbits & 1;
+        endpoints.pbit[1] = pbits >> 1;
+        QuantizeBC7(a, endpoints.pbit[0], endpoints.low[0]);
+        QuantizeBC7(b, endpoints.pbit[1], endpoints.low[1]);
+
+        uint8_t indices[16];
+        float error = SelectBC7Indices(rgba, endpoints, indices);
+        if (error < bestError) {
+            bestError = error;
+            best = endpoints;
+            std::memcpy(bestIndices, indices, 16);
+        }
+    }
+    return bestError;
+}
+
+// Least squares endpoints for the given indices
+bool RefineBC7Endpoints(const uint8_t* rgba, const uint8_t* indices, float* a, float* b) {
+    float aa = 0.0f, bb = 0.0f, ab = 0.0f, ax[4]{}, bx[4]{};
+    for (int i = 0; i < 16; ++i) {
+        float wb = BC7Weights[indices[i]] / 64.0f, wa = 1.0f - wb;
+        aa += wa * wa;
+        bb += wb * wb;
+        ab += wa * wb;
+        for (int c = 0; c < 4; ++c) {
+            ax[c] += wa * rgba[i * 4 + c];
+            bx[c] += wb * rgba[i * 4 + c];
+        }
+    }
+
+    float determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) < 1e-6f) return false;
+    float inverse = 1.0f / determinant;
+    for (int c = 0; c < 4; ++c) {
+        a[c] = (ax[c] * bb - bx[c] * ab) * inverse;
+        b[c] = (bx[c] * aa - ax[c] * ab) * inverse;
+    }
+    return true;
+}
+
+// Appends count bits of value, least significant first
+void WriteBits(uint8_t* block, uint32_t& position, uint32_t value, uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i, ++position)
+        if (value >> i & 1) block[position / 8] |= static_cast<uint8_t>(1 << (position % 8));
+}
+
+// Copies a 4x4 block out of a level, clamping at the edges, alpha 255 for RGB
+void FetchBlock(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t bpp,
+                uint32_t blockX, uint32_t blockY, uint8_t* rgba) {
+    for (uint32_t y = 0; y < 4; ++y) {
+        uint32_t sy = std::min(blockY * 4 + y, height - 1);
+        for (uint32_t x = 0; x < 4; ++x) {
+            uint32_t sx = std::min(blockX * 4 + x, width - 1);
+            const uint8_t* texel = pixels + (size_t(sy) * width + sx) * bpp;
+            uint8_t* out = rgba + (y * 4 + x) * 4;
+            out[0] = texel[0];
+            out[1] = texel[1];
+            out[2] = texel[2];
+            out[3] = bpp == 4 ? texel[3] : 255;
+        }
+    }
+}
+
+} // namespace
+
+void EncodeBC1Block(const uint8_t* rgba, uint8_t* block) {
+    EncodeColorBlock(rgba, block);
+}
+
+void EncodeBC3Block(const uint8_t* rgba, uint8_t* block) {
+    uint8_t alpha[16];
+    for (int i = 0; i < 16; ++i) alpha[i] = rgba[i * 4 + 3];
+    EncodeBC4Block(alpha, block);
+    EncodeColorBlock(rgba, block + 8);
+}
+
+void EncodeBC4Block(const uint8_t* values, uint8_t* block) {
+    uint8_t high = *std::max_element(values, values + 16);
+    uint8_t low = *std::min_element(values, values + 16);
+
+    // Eight value mode (a0 > a1): a0, a1 and six steps between them. Equal
+    // endpoints leave every index at 0.
+    uint64_t indices = 0;
+    if (high > low) {
+        float scale = 7.0f / float(high - low);
+        for (int i = 0; i < 16; ++i) {
+            uint32_t step = static_cast<uint32_t>((high - values[i]) * scale + 0.5f); // 0 at a0, 7 at a1
+            uint64_t index = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+            indices |= index << (i * 3);
+        }
+    }
+
+    block[0] = high;
+    block[1] = low;
+    for (int i = 0; i < 6; ++i) block[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+}
+
+void EncodeBC5Block(const uint8_t* rgba, uint8_t* block) {
+    uint8_t red[16], green[16];
+    for (int i = 0; i < 16; ++i) {
+        red[i] = rgba[i * 4];
+        green[i] = rgba[i * 4 + 1];
+    }
+    EncodeBC4Block(red, block);
+    EncodeBC4Block(green, block + 8);
+}
+
+void EncodeBC7Block(const uint8_t* rgba, uint8_t* block) {
+    // Principal axis of the RGBA values by power iteration on their covariance
+    float mean[4]{}, low[4] = {255, 255, 255, 255}, high[4]{};
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < 4; ++c) {
+            mean[c] += rgba[i * 4 + c] / 16.0f;
+            low[c] = std::min(low[c], float(rgba[i * 4 + c]));
+            high[c] = std::max(high[c], float(rgba[i * 4 + c]));
+        }
+
+    float covariance[4][4]{};
+    for (int i = 0; i < 16; ++i)
+        for (int r = 0; r < 4; ++r)
+            for (int c = 0; c < 4; ++c)
+                covariance[r][c] += (rgba[i * 4 + r] - mean[r]) * (rgba[i * 4 + c] - mean[c]);
+
+    float axis[4];
+    for (int c = 0; c < 4; ++c) axis[c] = high[c] - low[c];
+    for (int iteration = 0; iteration < 4; ++iteration) {
+        float next[4]{};
+        for (int r = 0; r < 4; ++r)
+            for (int c = 0; c < 4; ++c) next[r] += covariance[r][c] * axis[c];
+        float length = std::max({std::fabs(next[0]), std::fabs(next[1]), std::fabs(next[2]), std::fabs(next[3])});
+        if (length < 1e-4f) break;
+        for (int c = 0; c < 4; ++c) axis[c] = next[c] / length;
+    }
+
+    // Endpoints at the extreme projections onto the axis
+    float minDot = 1e30f, maxDot = -1e30f;
+    const uint8_t* minTexel = rgba;
+    const uint8_t* maxTexel = rgba;
+    for (int i = 0; i < 16; ++i) {
+        const uint8_t* texel = rgba + i * 4;
+        float dot = texel[0] * axis[0] + texel[1] * axis[1] + texel[2] * axis[2] + texel[3] * axis[3];
+        if (dot < minDot) { minDot = dot; minTexel = texel; }
+        if (dot > maxDot) { maxDot = dot; maxTexel = texel; }
+    }
+
+    float a[4], b[4];
+    for (int c = 0; c < 4; ++c) {
+        a[c] = minTexel[c];
+        b[c] = maxTexel[c];
+    }
+    Endpoints endpoints;
+    uint8_t indices[16];
+    float error = FitBC7(rgba, a, b, endpoints, indices);
+
+    if (RefineBC7Endpoints(rgba, indices, a, b)) {
+        Endpoints refined;
+        uint8_t refinedIndices[16];
+        if (FitBC7(rgba, a, b, refined, refinedIndices) < error) {
+            endpoints = refined;
+            std::memcpy(indices, refinedIndices, 16);
+        }
+    }
+
+    // The first index is stored without its top bit, which must be 0
+    if (indices[0] & 8) {
+        std::swap(endpoints.low[0], endpoints.low[1]);
+        std::swap(endpoints.pbit[0], endpoints.pbit[1]);
+        for (uint8_t& index : indices) index = static_cast<uint8_t>(15 - index);
+    }
+
+    std::memset(block, 0, 16);
+    uint32_t position = 0;
+    WriteBits(block, position, 1 << 6, 7);
+    for (int c = 0; c < 4; ++c) {
+        WriteBits(block, position, endpoints.low[0][c], 7);
+        WriteBits(block, position, endpoints.low[1][c], 7);
+    }
+    WriteBits(block, position, endpoints.pbit[0], 1);
+    WriteBits(block, position, endpoints.pbit[1], 1);
+    WriteBits(block, position, indices[0], 3);
+    for (int i = 1; i < 16; ++i) WriteBits(block, position, indices[i], 4);
+}
+
+TextureFile::Format ChooseFormat(const TextureFile::TextureData& data, bool normalMap, bool bc7) {
+    using TextureFile::Format;
+    if (normalMap) return Format::BC5;
+    if (bc7) return Format::BC7;
+    if (data.format != Format::RGBA8 || data.levels.empty()) return Format::BC1;
+
+    // BC1 has no real alpha, only keep BC3's extra 8 bytes when it is used
+    const TextureFile::MipLevel& level = data.levels[0];
+    const uint8_t* pixels = data.pixels.data() + level.offset;
+    for (uint64_t i = 3; i < level.size; i += 4)
+        if (pixels[i] != 255) return Format::BC3;
+    return Format::BC1;
+}
+
+bool Compress(TextureFile::TextureData& data, TextureFile::Format format) {
+    using TextureFile::Format;
+    if (TextureFile::IsCompressed(data.format)) {
+        KOSMIC_ERROR("Texture is already compressed ({})", TextureFile::GetFormatName(data.format));
+        return false;
+    }
+    void (*encode)(const uint8_t*, uint8_t*) = nullptr;
+    switch (format) {
+        case Format::BC1: encode = EncodeBC1Block; break;
+        case Format::BC3: encode = EncodeBC3Block; break;
+        case Format::BC5: encode = EncodeBC5Block; break;
+        case Format::BC7: encode = EncodeBC7Block; break;
+        default:
+            KOSMIC_ERROR("No encoder for {}", TextureFile::GetFormatName(format));
+            return false;
+    }
+    uint32_t bpp = TextureFile::GetBytesPerPixel(data.format);
+    uint32_t blockBytes = format == Format::BC1 ? 8 : 16;
+
+    std::vector<TextureFile::MipLevel> levels;
+    std::vector<uint8_t> pixels;
+    for (const TextureFile::MipLevel& source : data.levels) {
+        TextureFile::MipLevel level;
+        level.width = source.width;
+        level.height = source.height;
+        level.offset = pixels.size();
+        level.size = TextureFile::GetLevelSize(format, source.width, source.height);
+        pixels.resize(pixels.size() + level.size);
+        levels.push_back(level);
+    }
+
+    for (size_t i = 0; i < levels.size(); ++i) {
+        const uint8_t* src = data.pixels.data() + data.levels[i].offset;
+        uint8_t* dst = pixels.data() + levels[i].offset;
+        uint32_t width = levels[i].width, height = levels[i].height;
+        uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+
+        Jobs::ParallelFor(blocksY, 8, [&](uint32_t begin, uint32_t end) {
+            uint8_t rgba[64];
+            for (uint32_t by = begin; by < end; ++by)
+                for (uint32_t bx = 0; bx < blocksX; ++bx) {
+                    FetchBlock(src, width, height, bpp, bx, by, rgba);
+                    encode(rgba, dst + (size_t(by) * blocksX + bx) * blockBytes);
+                }
+        });
+    }
+
+    data.format = format;
+    data.levels = std::move(levels);
+    data.pixels = std::move(pixels);
+    return true;
+}
+
+} // namespace Kosmic::Assets::TextureCompressor
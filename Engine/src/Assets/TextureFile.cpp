@@ -0,0 +1,164 @@
+#include "Kosmic/Assets/TextureFile.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace Kosmic::Assets::TextureFile {
+
+namespace {
+
+constexpr uint64_t Alignment = 16;
+
+uint64_t Align(uint64_t offset) {
+    return (offset + Alignment - 1) & ~(Alignment - 1);
+}
+
+} // namespace
+
+bool IsCompressed(Format format) {
+    return format != Format::RGB8 && format != Format::RGBA8;
+}
+
+uint32_t GetBytesPerPixel(Format format) {
+    return format == Format::RGB8 ? 3 : 4;
+}
+
+uint32_t GetRowHeight(Format format) {
+    return IsCompressed(format) ? 4 : 1;
+}
+
+uint64_t GetRowPitch(Format format, uint32_t width) {
+    if (!IsCompressed(format)) return uint64_t(width) * GetBytesPerPixel(format);
+    uint64_t blockBytes = format == Format::BC1 ? 8 : 16;
+    return (uint64_t(width) + 3) / 4 * blockBytes;
+}
+
+uint64_t GetLevelSize(Format format, uint32_t width, uint32_t height) {
+    uint32_t rowHeight = GetRowHeight(format);
+    return GetRowPitch(format, width) * ((uint64_t(height) + rowHeight - 1) / rowHeight);
+}
+
+const char* GetFormatName(Format format) {
+    switch (format) {
+        case Format::RGB8:  return "RGB8";
+        case Format::RGBA8: return "RGBA8";
+        case Format::BC1:   return "BC1";
+        case Format::BC3:   return "BC3";
+        case Format::BC5:   return "BC5";
+        case Format::BC7:   return "BC7";
+    }
+    return "unknown";
+}
+
+void GenerateMips(TextureData& data) {
+    if (data.levels.empty() || IsCompressed(data.format)) return;
+    uint32_t bpp = GetBytesPerPixel(data.format);
+
+    while (data.levels.back().width > 1 || data.levels.back().height > 1) {
+        MipLevel source = data.levels.back();
+        MipLevel level;
+        level.width = std::max(1u, source.width / 2);
+        level.height = std::max(1u, source.height / 2);
+        level.offset = data.pixels.size();
+        level.size = uint64_t(level.width) * level.height * bpp;
+        data.pixels.resize(data.pixels.size() + level.size);
+
+        // Odd sizes drop the last row/column, like glGenerateMipmap usually does
+        const uint8_t* src = data.pixels.data() + source.offset;
+        uint8_t* dst = data.pixels.data() + level.offset;
+        uint32_t sourceRow = source.width * bpp;
+        for (uint32_t y = 0; y < level.height; ++y) {
+            uint32_t y0 = std::min(y * 2, source.height - 1), y1 = std::min(y * 2 + 1, source.height - 1);
+            for (uint32_t x = 0; x < level.width; ++x) {
+                uint32_t x0 = std::min(x * 2, source.width - 1), x1 = std::min(x * 2 + 1, source.width - 1);
+                for (uint32_t c = 0; c < bpp; ++c) {
+                    uint32_t sum = src[y0 * sourceRow + x0 * bpp + c] + src[y0 * sourceRow + x1 * bpp + c] +
+                                   src[y1 * sourceRow + x0 * bpp + c] + src[y1 * sourceRow + x1 * bpp + c];
+                    dst[(y * level.width + x) * bpp + c] = static_cast<uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
+        data.levels.push_back(level);
+    }
+}
+
+std::optional<View> Parse(const uint8_t* data, size_t size) {
+    if (!data || size < sizeof(Header)) return std::nullopt;
+
+    const auto* header = reinterpret_cast<const Header*>(data);
+    if (header->cooked.magic != Magic || header->cooked.version != Version ||
+        static_cast<uint32_t>(header->format) > static_cast<uint32_t>(Format::BC7) ||
+        header->mipCount == 0 || header->mipCount > 32 ||
+        header->levelOffset % alignof(MipLevel) != 0 ||
+        header->levelOffset > size || header->mipCount > (size - header->levelOffset) / sizeof(MipLevel))
+        return std::nullopt;
+
+    View view{header, reinterpret_cast<const MipLevel*>(data + header->levelOffset), data};
+    for (uint32_t i = 0; i < header->mipCount; ++i) {
+        const MipLevel& level = view.levels[i];
+        if (level.size != GetLevelSize(header->format, level.width, level.height) ||
+            level.offset > size || level.size > size - level.offset)
+            return std::nullopt;
+    }
+    return view;
+}
+
+bool Write(const std::string& path, const TextureData& data, const SourceStamp& source) {
+    if (data.levels.empty()) return false;
+
+    Header header;
+    header.cooked.source = source;
+    header.format = data.format;
+    header.width = data.levels[0].width;
+    header.height = data.levels[0].height;
+    header.mipCount = static_cast<uint32_t>(data.levels.size());
+    header.levelOffset = Align(sizeof(Header));
+
+    // Level offsets in the file rather than in data.pixels
+    std::vector<MipLevel> levels = data.levels;
+    uint64_t offset = Align(header.levelOffset + levels.size() * sizeof(MipLevel));
+    for (MipLevel& level : levels) {
+        level.offset = offset;
+        offset = Align(offset + level.size);
+    }
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            KOSMIC_ERROR("Failed to write cooked texture: {}", path);
+            return false;
+        }
+
+        auto section = [&](uint64_t offset, const void* bytes, size_t size) {
+            // Zero the alignment gap before the section
+            static constexpr char padding[Alignment]{};
+            out.write(padding, static_cast<std::streamsize>(offset - static_cast<uint64_t>(out.tellp())));
+            out.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+        };
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        section(header.levelOffset, levels.data(), levels.size() * sizeof(MipLevel));
+        for (size_t i = 0; i < levels.size(); ++i)
+            section(levels[i].offset, data.pixels.data() + data.levels[i].offset, levels[i].size);
+
+        if (!out) {
+            KOSMIC_ERROR("Failed to write cooked texture: {}", path);
+            out.close();
+            std::filesystem::remove(temporary);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        KOSMIC_ERROR("Failed to write cooked texture: {} ({})", path, error.message());
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+} // namespace Kosmic::Assets::TextureFile
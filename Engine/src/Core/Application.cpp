@@ -6,17 +6,135 @@
 #include "imgui_impl_sdl2.h"
 #include "imgui_impl_opengl3.h"
 #include <iostream>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
 #include "Kosmic/Renderer/Renderer3D.hpp"
+#include "Kosmic/Renderer/Framebuffer.hpp"
+#include "Kosmic/Renderer/RenderStats.hpp"
+#include "Kosmic/Renderer/GPUProfiler.hpp"
+#include "Kosmic/Renderer/GeometryPool.hpp"
+#include "Kosmic/Renderer/StateManager.hpp"
 #include "Kosmic/Core/Input.hpp"
+#include "Kosmic/Core/HeadlessContext.hpp"
+#include "Kosmic/Core/Benchmark.hpp"
+#include "Kosmic/Core/Profiler.hpp"
+#include "Kosmic/Core/Jobs.hpp"
+#include "Kosmic/Assets/AssetManager.hpp"
+#include "Kosmic/Renderer/TextureStreamer.hpp"
 
 namespace Kosmic {
 
-Application::Application(const std::string& title, int width, int height)
-    : m_Running(false), m_Window(nullptr), m_LastFrameTime(0) {
-    
+ApplicationSettings ApplicationSettings::FromCommandLine(int argc, char** argv) {
+    ApplicationSettings settings;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--headless") == 0) {
+            settings.headless = true;
+        } else if (std::strcmp(arg, "--frames") == 0 && hasValue) {
+            settings.benchmarkFrames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--warmup") == 0 && hasValue) {
+            settings.warmupFrames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--output") == 0 && hasValue) {
+            settings.benchmarkOutput = argv[++i];
+        } else if (std::strcmp(arg, "--trace") == 0 && hasValue) {
+            settings.traceOutput = argv[++i];
+        } else if (std::strcmp(arg, "--workers") == 0 && hasValue) {
+            settings.workerThreads = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--tick-rate") == 0 && hasValue) {
+            float hz = std::strtof(argv[++i], nullptr);
+            settings.fixedTimestep = hz > 0.0f ? 1.0f / hz : 0.0f;
+        } else if (std::strcmp(arg, "--max-steps") == 0 && hasValue) {
+            settings.maxUpdateSteps = std::max(1u, static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)));
+        } else if (std::strcmp(arg, "--fps-limit") == 0 && hasValue) {
+            settings.frameLimit = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--swap-interval") == 0 && hasValue) {
+            settings.swapInterval = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--upload-budget") == 0 && hasValue) {
+            settings.assetUploadBudget = std::max(0.0f, std::strtof(argv[++i], nullptr));
+        } else if (std::strcmp(arg, "--texture-budget") == 0 && hasValue) {
+            settings.textureStreamBudget = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            KOSMIC_WARN("Ignoring unknown argument: {}", arg);
+        }
+    }
+    return settings;
+}
+
+Application::Application(const std::string& title, int width, int height, const ApplicationSettings& settings)
+    : m_Title(title), m_Settings(settings), m_Width(width), m_Height(height),
+      m_Running(false), m_Initialized(false), m_Window(nullptr), m_GLContext(nullptr),
+      m_LastFrameTime(0), m_TimerFrequency(1) {
+
+    Jobs::Init(m_Settings.workerThreads);
+
+    bool ok = m_Settings.headless ? InitHeadless() : InitWindow(title);
+    if (!ok || !InitGL()) return;
+
+    if (m_Settings.headless) {
+        // Everything the scene draws lands in this target, nothing is presented
+        m_OffscreenTarget = Renderer::Framebuffer::Create(width, height);
+    } else {
+        ApplySwapInterval();
+
+        // Initialize ImGui
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext();
+        ImGui_ImplSDL2_InitForOpenGL(m_Window, m_GLContext);
+        ImGui_ImplOpenGL3_Init("#version 330");
+
+        SDL_SetRelativeMouseMode(SDL_TRUE);
+    }
+
+    if (m_Settings.headless && m_Settings.benchmarkFrames == 0)
+        KOSMIC_WARN("Headless mode without --frames will run until the process is killed");
+
+    Renderer::GPUProfiler::Init();
+
+    if (m_Settings.benchmarkFrames > 0) {
+        m_Benchmark = std::make_unique<FrameBenchmark>(m_Settings.warmupFrames, m_Settings.benchmarkFrames);
+        Renderer::GPUProfiler::SetResolveCallback([this](const Renderer::GPUFrameTimings& timings) {
+            m_Benchmark->RecordGPUTime(timings.frameIndex, timings.frameTime / 1e6);
+        });
+    }
+
+    m_Initialized = true;
+}
+
+Application::~Application() {
+    // Drain outstanding jobs while everything they might touch is still alive
+    Jobs::Shutdown();
+    Assets::AssetManager::Shutdown();
+
+    // Shutdown ImGui
+    if (m_Window && m_Initialized) {
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui_ImplSDL2_Shutdown();
+        ImGui::DestroyContext();
+    }
+
+    // GL objects must go before their context
+    Renderer::GPUProfiler::SetResolveCallback(nullptr);
+    Renderer::GPUProfiler::Shutdown();
+    Renderer::GeometryPool::Shutdown();
+    m_OffscreenTarget.reset();
+    m_HeadlessContext.reset();
+
+    if (m_GLContext) SDL_GL_DeleteContext(m_GLContext);
+    if (m_Window) SDL_DestroyWindow(m_Window);
+
+    SDL_Quit();
+}
+
+bool Application::InitWindow(const std::string& title) {
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         KOSMIC_ERROR("Error initializing SDL: {}", SDL_GetError());
-        return;
+        return false;
     }
 
     // OpenGL 3.3 Core Profile Configuration
@@ -28,67 +146,199 @@ Application::Application(const std::string& title, int width, int height)
     m_Window = SDL_CreateWindow(
         title.c_str(),
         SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-        width, height,
+        m_Width, m_Height,
         SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN
     );
 
     if (!m_Window) {
         KOSMIC_ERROR("Error creating window: {}", SDL_GetError());
-        return;
+        return false;
     }
 
     // Create OpenGL context
     m_GLContext = SDL_GL_CreateContext(m_Window);
     if (!m_GLContext) {
         KOSMIC_ERROR("Error creating OpenGL context: {}", SDL_GetError());
-        return;
+        return false;
     }
+    return true;
+}
+
+bool Application::InitHeadless() {
+    // No video subsystem: the build farm has no display server
+    if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS) < 0) {
+        KOSMIC_ERROR("Error initializing SDL: {}", SDL_GetError());
+        return false;
+    }
+
+    m_HeadlessContext = HeadlessContext::Create(3, 3);
+    return m_HeadlessContext != nullptr;
+}
 
+bool Application::InitGL() {
     // Initialize GLEW
     GLenum err = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // GLX builds of GLEW report this under EGL after the core entry points were loaded
+    if (err == GLEW_ERROR_NO_GLX_DISPLAY && m_HeadlessContext)
+        err = GLEW_OK;
+#endif
     if (err != GLEW_OK) {
         KOSMIC_ERROR("Error initializing GLEW: {}", reinterpret_cast<const char*>(glewGetErrorString(err)));
-        return;
+        return false;
     }
 
-    SDL_GL_SetSwapInterval(1); // VSync
+    KOSMIC_INFO("OpenGL {} ({})",
+                reinterpret_cast<const char*>(glGetString(GL_VERSION)),
+                reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    return true;
+}
 
-    // Initialize ImGui
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    ImGui_ImplSDL2_InitForOpenGL(m_Window, m_GLContext);
-    ImGui_ImplOpenGL3_Init("#version 330");
+void Application::ApplySwapInterval() {
+    // Benchmarks measure frame cost, so never wait for the display
+    int interval = m_Settings.benchmarkFrames > 0 ? 0 : m_Settings.swapInterval;
+    if (SDL_GL_SetSwapInterval(interval) == 0) return;
 
-    SDL_SetRelativeMouseMode(SDL_TRUE);
+    if (interval == -1) {
+        KOSMIC_WARN("Adaptive VSync is not supported ({}), using regular VSync", SDL_GetError());
+        if (SDL_GL_SetSwapInterval(1) == 0) return;
+    }
+    KOSMIC_WARN("Could not set swap interval {}: {}", interval, SDL_GetError());
 }
 
-Application::~Application() {
-    if (m_GLContext) SDL_GL_DeleteContext(m_GLContext);
-    if (m_Window) SDL_DestroyWindow(m_Window);
-    
-    // Shutdown ImGui
-    ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplSDL2_Shutdown();
-    ImGui::DestroyContext();
-    
-    SDL_Quit();
+// Sleeps most of the remaining frame time, then spins for the last stretch
+// because SDL_Delay can overshoot by a millisecond or more
+void Application::WaitForFrameLimit(uint64_t frameStart) {
+    KOSMIC_PROFILE_SCOPE("FrameLimit");
+    uint64_t target = frameStart + m_TimerFrequency / m_Settings.frameLimit;
+    for (uint64_t now = SDL_GetPerformanceCounter(); now < target; now = SDL_GetPerformanceCounter()) {
+        uint64_t remainingMs = (target - now) * 1000 / m_TimerFrequency;
+        if (remainingMs > 2)
+            SDL_Delay(static_cast<uint32_t>(remainingMs - 2));
+    }
+}
+
+// Rolling graph of one RenderStats value, oldest frame on the left
+static void PlotRenderStat(const char* label, float (*value)(const Renderer::RenderStats&)) {
+    int count = static_cast<int>(Renderer::RenderStatistics::GetHistoryCount());
+    if (count == 0) return;
+    auto getter = [](void* data, int index) {
+        auto value = *static_cast<float (**)(const Renderer::RenderStats&)>(data);
+        int count = static_cast<int>(Renderer::RenderStatistics::GetHistoryCount());
+        return value(Renderer::RenderStatistics::GetHistory(static_cast<uint32_t>(count - 1 - index)));
+    };
+    char overlay[32];
+    std::snprintf(overlay, sizeof(overlay), "%.0f", value(Renderer::RenderStatistics::GetLast()));
+    ImGui::PlotLines(label, getter, &value, count, 0, overlay, 0.0f, FLT_MAX, ImVec2(0.0f, 40.0f));
+}
+
+void Application::DrawProfilerWindow(float deltaTime) {
+    ImGui::Begin("Profiler"); // ImGui window for profiler
+    ImGui::Text("FPS: %.1f", 1.0f / deltaTime);
+    ImGui::Text("CPU Frame Time: %.2f ms", deltaTime * 1000.0f);
+    ImGui::Text("GPU Time: %.2f ms", Kosmic::Renderer::Renderer3D::GetLastGPUTime() / 1e6);
+    if (m_Settings.fixedTimestep > 0.0f)
+        ImGui::Text("Simulation: %.0f Hz, %u step(s) this frame", 1.0f / m_Settings.fixedTimestep, m_UpdateSteps);
+    Assets::AssetManagerStats assets = Assets::AssetManager::GetStats();
+    if (assets.decoding > 0 || assets.pendingUploads > 0)
+        ImGui::Text("Loading: %u decoding, %u to upload", assets.decoding, assets.pendingUploads);
+    Renderer::TextureStreamerStats streaming = Renderer::TextureStreamer::GetStats();
+    if (streaming.pendingTextures > 0 || streaming.bytesInFlight > 0)
+        ImGui::Text("Streaming: %u textures, %.1f KB this frame, %.1f KB in flight", streaming.pendingTextures,
+                    streaming.bytesLastFrame / 1024.0, streaming.bytesInFlight / 1024.0);
+    if (streaming.completed > 0)
+        ImGui::Text("Texture latency: %.1f ms avg, %.1f ms max (%u streamed)", streaming.averageLatencyMs,
+                    streaming.maxLatencyMs, streaming.completed);
+    Renderer::TextureMemory textureMemory = Renderer::Texture::GetTotalMemory();
+    if (textureMemory.uncompressedBytes > 0)
+        ImGui::Text("Texture memory: %.1f MB (%.1f MB uncompressed)", textureMemory.bytes / 1048576.0,
+                    textureMemory.uncompressedBytes / 1048576.0);
+
+    // Counters of the previous frame, with a few seconds of history
+    if (ImGui::CollapsingHeader("Render Stats", ImGuiTreeNodeFlags_DefaultOpen)) {
+        const Renderer::RenderStats& stats = Renderer::RenderStatistics::GetLast();
+        ImGui::Text("Draw calls: %u, triangles: %llu, instances: %u", stats.drawCalls,
+                    static_cast<unsigned long long>(stats.triangles), stats.instances);
+        ImGui::Text("Objects: %u visible, %u culled", stats.visibleObjects, stats.culledObjects);
+        if (stats.occlusionTested > 0)
+            ImGui::Text("Occlusion: %u of %u tested hidden (%.1f%%)", stats.occludedObjects, stats.occlusionTested,
+                        100.0 * stats.occludedObjects / stats.occlusionTested);
+        if (stats.occlusionQueries > 0)
+            ImGui::Text("Occlusion queries: %u issued", stats.occlusionQueries);
+        if (stats.gpuCullTested > 0)
+            ImGui::Text("GPU culling: %u of %u instances kept", stats.gpuCullVisible, stats.gpuCullTested);
+        ImGui::Text("Lights: %u visible, %u cluster entries", stats.visibleLights, stats.lightIndices);
+        ImGui::Text("State changes: %u (%u redundant skipped)", stats.stateChanges, stats.redundantStateChanges);
+        ImGui::Text("Binds: %u shader, %u texture, %u VAO, %u framebuffer", stats.shaderBinds, stats.textureBinds,
+                    stats.vaoBinds, stats.framebufferBinds);
+        ImGui::Text("Uniform uploads: %u, buffer uploads: %.1f KB", stats.uniformUploads,
+                    stats.bufferBytes / 1024.0);
+        PlotRenderStat("Draw calls", [](const Renderer::RenderStats& s) { return float(s.drawCalls); });
+        PlotRenderStat("Triangles", [](const Renderer::RenderStats& s) { return float(s.triangles); });
+        PlotRenderStat("State changes", [](const Renderer::RenderStats& s) { return float(s.stateChanges); });
+        PlotRenderStat("Upload KB", [](const Renderer::RenderStats& s) { return float(s.bufferBytes / 1024.0); });
+    }
+
+    // Per-scope GPU times of the latest resolved frame
+    const auto& gpuTimings = Kosmic::Renderer::Renderer3D::GetLastGPUTimings();
+    if (ImGui::CollapsingHeader("GPU Passes", ImGuiTreeNodeFlags_DefaultOpen)) {
+        for (const auto& timing : gpuTimings.scopes) {
+            if (timing.depth == 0) continue; // Whole frame, shown above
+            ImGui::Text("%*s%s: %.3f ms", static_cast<int>(timing.depth - 1) * 2, "",
+                        timing.name.c_str(), timing.time / 1e6);
+        }
+    }
+
+    // CPU zones of the previous frame, summed over all threads
+    if (ImGui::CollapsingHeader("CPU Zones", ImGuiTreeNodeFlags_DefaultOpen)) {
+        for (const auto& zone : Profiler::GetFrameStats()) {
+            ImGui::Text("%*s%s: %.3f ms (%u)", static_cast<int>(zone.depth) * 2, "",
+                        zone.name, zone.totalTime / 1e6, zone.calls);
+        }
+        if (Profiler::IsCapturing()) {
+            ImGui::Text("Capturing... %u frames left", m_CaptureFramesLeft);
+        } else if (ImGui::Button("Capture 120 frames")) {
+            m_CaptureFramesLeft = 120;
+            Profiler::BeginCapture();
+        }
+    }
+    ImGui::End();
 }
 
 void Application::Run() {
+    if (!m_Initialized) {
+        KOSMIC_ERROR("Application was not initialized, aborting run.");
+        return;
+    }
+
     m_Running = true;
     KOSMIC_INFO("Application starting...");
-    OnInit();
+    KOSMIC_PROFILE_THREAD("Main");
+    {
+        KOSMIC_PROFILE_SCOPE("OnInit");
+        OnInit();
+    }
 
+    m_TimerFrequency = SDL_GetPerformanceFrequency();
+    m_LastFrameTime = SDL_GetPerformanceCounter();
+    m_Accumulator = 0.0;
+    uint64_t frameCounter = 0;
     while (m_Running) {
+        auto frameStart = std::chrono::steady_clock::now();
+
+        // Trace the measured frames only, warmup is not interesting
+        if (!m_Settings.traceOutput.empty() && frameCounter++ == m_Settings.warmupFrames)
+            Profiler::BeginCapture();
+
         // Calculate delta time
-        uint32_t currentTime = SDL_GetTicks();
-        float deltaTime = (currentTime - m_LastFrameTime) / 1000.0f;
+        uint64_t currentTime = SDL_GetPerformanceCounter();
+        float deltaTime = static_cast<float>(static_cast<double>(currentTime - m_LastFrameTime) / m_TimerFrequency);
         m_LastFrameTime = currentTime;
 
         // Process events
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
-            ImGui_ImplSDL2_ProcessEvent(&event);
+            if (m_Window) ImGui_ImplSDL2_ProcessEvent(&event);
             // Process input events
             Kosmic::Input::ProcessEvent(event);
             if (event.type == SDL_QUIT) {
@@ -96,31 +346,109 @@ void Application::Run() {
             }
         }
 
+        if (m_OffscreenTarget) {
+            m_OffscreenTarget->Bind();
+            glViewport(0, 0, m_Width, m_Height);
+        }
+
         // Update and render
-        OnUpdate(deltaTime);
-        OnRender();
-        
-        // Start ImGui new frame
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplSDL2_NewFrame();
-        ImGui::NewFrame();
-
-        // Profiler window
+        float alpha = 1.0f;
         {
-            ImGui::Begin("Profiler"); // ImGui window for profiler
-            ImGui::Text("FPS: %.1f", 1.0f / deltaTime);
-            ImGui::Text("CPU Frame Time: %.2f ms", deltaTime * 1000.0f);
-            ImGui::Text("GPU Time: %.2f ms", Kosmic::Renderer::Renderer3D::GetLastGPUTime() / 1e6);
-            ImGui::End();
+            KOSMIC_PROFILE_SCOPE("OnUpdate");
+            const double step = m_Settings.fixedTimestep;
+            if (step > 0.0) {
+                m_Accumulator += deltaTime;
+                m_UpdateSteps = 0;
+                while (m_Accumulator >= step && m_UpdateSteps < m_Settings.maxUpdateSteps) {
+                    OnUpdate(m_Settings.fixedTimestep);
+                    m_Accumulator -= step;
+                    ++m_UpdateSteps;
+                }
+                // Too far behind to catch up (stall, breakpoint): drop the backlog
+                // instead of trying ever more steps per frame
+                if (m_Accumulator >= step)
+                    m_Accumulator = std::fmod(m_Accumulator, step);
+                alpha = static_cast<float>(m_Accumulator / step);
+            } else {
+                OnUpdate(deltaTime);
+                m_UpdateSteps = 1;
+            }
+        }
+
+        uint64_t frameIndex = Renderer::GPUProfiler::BeginFrame();
+        // Finish background loads, a bounded slice per frame to avoid hitches
+        Assets::AssetManager::Update(m_Settings.assetUploadBudget);
+        Renderer::TextureStreamer::Update(size_t(m_Settings.textureStreamBudget) * 1024);
+        {
+            KOSMIC_PROFILE_SCOPE("OnRender");
+            Renderer::GPUScope gpuScope("OnRender");
+            OnRender(alpha);
+        }
+
+        if (m_Window) {
+            {
+                KOSMIC_PROFILE_SCOPE("ImGui");
+                Renderer::GPUScope gpuScope("ImGui");
+                // Start ImGui new frame
+                ImGui_ImplOpenGL3_NewFrame();
+                ImGui_ImplSDL2_NewFrame();
+                ImGui::NewFrame();
+
+                DrawProfilerWindow(deltaTime);
+
+                // Render ImGui
+                ImGui::Render();
+                ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+                // It restores the bindings it changed, but not the current
+                // vertex attribute values StateManager re-sets on a VAO bind
+                Renderer::StateManager::Invalidate();
+            }
+            Renderer::GPUProfiler::EndFrame();
+            Renderer::RenderStatistics::EndFrame();
+
+            KOSMIC_PROFILE_SCOPE("SwapWindow");
+            SDL_GL_SwapWindow(m_Window);
+        } else {
+            Renderer::GPUProfiler::EndFrame();
+            Renderer::RenderStatistics::EndFrame();
+            // Nothing is presented; make sure the frame is actually submitted
+            m_OffscreenTarget->Unbind();
+            glFlush();
         }
 
-        // Render ImGui
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        KOSMIC_PROFILE_FRAME();
+        if (m_CaptureFramesLeft > 0 && --m_CaptureFramesLeft == 0)
+            Profiler::EndCapture("kosmic_trace.json");
 
-        SDL_GL_SwapWindow(m_Window);
+        if (m_Benchmark) {
+            std::chrono::duration<double, std::milli> cpuTime = std::chrono::steady_clock::now() - frameStart;
+            const Renderer::RenderStats& stats = Renderer::RenderStatistics::GetLast();
+            m_Benchmark->RecordCounter("drawCalls", frameIndex, stats.drawCalls);
+            m_Benchmark->RecordCounter("triangles", frameIndex, static_cast<double>(stats.triangles));
+            m_Benchmark->RecordCounter("stateChanges", frameIndex, stats.stateChanges);
+            m_Benchmark->RecordCounter("uniformUploads", frameIndex, stats.uniformUploads);
+            m_Benchmark->RecordCounter("bufferBytes", frameIndex, static_cast<double>(stats.bufferBytes));
+            m_Benchmark->RecordCounter("visibleObjects", frameIndex, stats.visibleObjects);
+            m_Benchmark->RecordCounter("visibleLights", frameIndex, stats.visibleLights);
+            m_Benchmark->RecordCounter("occludedObjects", frameIndex, stats.occludedObjects);
+            m_Benchmark->RecordCounter("occlusionQueries", frameIndex, stats.occlusionQueries);
+            m_Benchmark->RecordCounter("gpuCullVisible", frameIndex, stats.gpuCullVisible);
+            m_Benchmark->RecordCPUTime(frameIndex, cpuTime.count());
+            if (m_Benchmark->IsComplete()) {
+                // Collect the GPU times still in flight; waiting is fine at this point
+                Renderer::GPUProfiler::Flush();
+                m_Benchmark->WriteJSON(m_Settings.benchmarkOutput, m_Title);
+                m_Running = false;
+            }
+        }
+
+        if (m_Settings.frameLimit > 0)
+            WaitForFrameLimit(currentTime);
     }
 
+    if (Profiler::IsCapturing())
+        Profiler::EndCapture(m_Settings.traceOutput.empty() ? "kosmic_trace.json" : m_Settings.traceOutput);
+
     OnCleanup();
     KOSMIC_INFO("Application terminated.");
 }
@@ -0,0 +1,131 @@
+#include "Kosmic/Core/Benchmark.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include "Json.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+
+namespace Kosmic {
+
+namespace {
+
+void WriteSummary(std::ofstream& out, const char* key, const FrameBenchmark::Summary& s) {
+    out << "    \"";
+    Json::WriteEscaped(out, key);
+    out << "\": { "
+        << "\"min\": " << s.min << ", "
+        << "\"median\": " << s.median << ", "
+        << "\"p99\": " << s.p99 << ", "
+        << "\"mean\": " << s.mean << ", "
+        << "\"max\": " << s.max << " }";
+}
+
+void WriteSamples(std::ofstream& out, const char* key, const std::vector<double>& samples) {
+    out << "    \"";
+    Json::WriteEscaped(out, key);
+    out << "\": [";
+    for (size_t i = 0; i < samples.size(); ++i) {
+        out << (i ? ", " : "");
+        // Frames the GPU timer had to drop are reported as null
+        if (samples[i] < 0.0) out << "null";
+        else out << samples[i];
+    }
+    out << "]";
+}
+
+} // namespace
+
+FrameBenchmark::FrameBenchmark(uint32_t warmupFrames, uint32_t measuredFrames)
+    : m_WarmupFrames(warmupFrames), m_MeasuredFrames(measuredFrames),
+      m_CpuTimes(measuredFrames, -1.0), m_GpuTimes(measuredFrames, -1.0) {}
+
+void FrameBenchmark::RecordCPUTime(uint64_t frame, double ms) {
+    if (frame < m_WarmupFrames || frame - m_WarmupFrames >= m_MeasuredFrames) return;
+    m_CpuTimes[frame - m_WarmupFrames] = ms;
+    ++m_RecordedFrames;
+}
+
+void FrameBenchmark::RecordGPUTime(uint64_t frame, double ms) {
+    if (frame < m_WarmupFrames || frame - m_WarmupFrames >= m_MeasuredFrames) return;
+    m_GpuTimes[frame - m_WarmupFrames] = ms;
+}
+
+void FrameBenchmark::RecordCounter(const std::string& name, uint64_t frame, double value) {
+    if (frame < m_WarmupFrames || frame - m_WarmupFrames >= m_MeasuredFrames) return;
+    auto it = std::find_if(m_Counters.begin(), m_Counters.end(),
+                           [&](const auto& counter) { return counter.first == name; });
+    if (it == m_Counters.end()) {
+        m_Counters.emplace_back(name, std::vector<double>(m_MeasuredFrames, -1.0));
+        it = m_Counters.end() - 1;
+    }
+    it->second[frame - m_WarmupFrames] = value;
+}
+
+FrameBenchmark::Summary FrameBenchmark::Summarize(std::vector<double> samples) {
+    Summary summary;
+    std::erase_if(samples, [](double sample) { return sample < 0.0; });
+    if (samples.empty()) return summary;
+
+    std::sort(samples.begin(), samples.end());
+    // Nearest-rank percentile
+    auto percentile = [&](double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p * samples.size()));
+        return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+    };
+
+    summary.min = samples.front();
+    summary.max = samples.back();
+    summary.median = percentile(0.5);
+    summary.p99 = percentile(0.99);
+    summary.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    return summary;
+}
+
+bool FrameBenchmark::WriteJSON(const std::string& path, const std::string& name) const {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        KOSMIC_ERROR("Benchmark: failed to open {} for writing", path);
+        return false;
+    }
+
+    Summary cpu = Summarize(m_CpuTimes);
+    Summary gpu = Summarize(m_GpuTimes);
+
+    out << "{\n";
+    out << "  \"application\": \"";
+    Json::WriteEscaped(out, name);
+    out << "\",\n";
+    out << "  \"warmupFrames\": " << m_WarmupFrames << ",\n";
+    out << "  \"frames\": " << m_RecordedFrames << ",\n";
+    out << "  \"unit\": \"ms\",\n";
+    out << "  \"summary\": {\n";
+    WriteSummary(out, "cpu", cpu);
+    out << ",\n";
+    WriteSummary(out, "gpu", gpu);
+    out << "\n  },\n";
+    if (!m_Counters.empty()) {
+        out << "  \"counters\": {\n";
+        for (size_t i = 0; i < m_Counters.size(); ++i) {
+            out << (i ? ",\n" : "");
+            WriteSummary(out, m_Counters[i].first.c_str(), Summarize(m_Counters[i].second));
+        }
+        out << "\n  },\n";
+    }
+    out << "  \"perFrame\": {\n";
+    WriteSamples(out, "cpu", m_CpuTimes);
+    out << ",\n";
+    WriteSamples(out, "gpu", m_GpuTimes);
+    for (const auto& [counter, samples] : m_Counters) {
+        out << ",\n";
+        WriteSamples(out, counter.c_str(), samples);
+    }
+    out << "\n  }\n";
+    out << "}\n";
+
+    KOSMIC_INFO("Benchmark: {} frames, CPU median {:.3f} ms (p99 {:.3f}), GPU median {:.3f} ms (p99 {:.3f}) -> {}",
+                m_RecordedFrames, cpu.median, cpu.p99, gpu.median, gpu.p99, path);
+    return true;
+}
+
+} // namespace Kosmic
@@ -0,0 +1,145 @@
+#include "Kosmic/Core/HeadlessContext.hpp"
+#include "Kosmic/Core/Logging.hpp"
+
+#ifdef KOSMIC_HAS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+#endif
+
+namespace Kosmic {
+
+#ifdef KOSMIC_HAS_EGL
+
+namespace {
+
+bool HasExtension(const char* extensions, const char* name) {
+    if (!extensions) return false;
+    const size_t length = std::strlen(name);
+    for (const char* p = std::strstr(extensions, name); p; p = std::strstr(p + length, name)) {
+        bool startsWord = p == extensions || p[-1] == ' ';
+        bool endsWord = p[length] == ' ' || p[length] == '\0';
+        if (startsWord && endsWord) return true;
+    }
+    return false;
+}
+
+EGLDisplay OpenDisplay() {
+    // Mesa's surfaceless platform needs neither X11 nor a DRM master
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (HasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay) {
+            EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr))
+                return display;
+        }
+    }
+
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr))
+        return display;
+    return EGL_NO_DISPLAY;
+}
+
+} // namespace
+
+HeadlessContext::~HeadlessContext() {
+    if (!m_Display) return;
+    eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (m_Surface) eglDestroySurface(m_Display, m_Surface);
+    if (m_Context) eglDestroyContext(m_Display, m_Context);
+    eglTerminate(m_Display);
+}
+
+std::unique_ptr<HeadlessContext> HeadlessContext::Create(int majorVersion, int minorVersion) {
+    EGLDisplay display = OpenDisplay();
+    if (display == EGL_NO_DISPLAY) {
+        KOSMIC_ERROR("Headless: no EGL display available");
+        return nullptr;
+    }
+
+    std::unique_ptr<HeadlessContext> context(new HeadlessContext());
+    context->m_Display = display;
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        KOSMIC_ERROR("Headless: EGL implementation does not support desktop OpenGL");
+        return nullptr;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs == 0) {
+        // Surfaceless displays may expose configs without any surface type
+        const EGLint fallbackAttribs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+        if (!eglChooseConfig(display, fallbackAttribs, &config, 1, &numConfigs) || numConfigs == 0) {
+            KOSMIC_ERROR("Headless: no EGL config with OpenGL support");
+            return nullptr;
+        }
+    }
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, majorVersion,
+        EGL_CONTEXT_MINOR_VERSION, minorVersion,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context->m_Context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (context->m_Context == EGL_NO_CONTEXT) {
+        KOSMIC_ERROR("Headless: failed to create OpenGL {}.{} context (0x{:x})",
+                     majorVersion, minorVersion, eglGetError());
+        context->m_Context = nullptr;
+        return nullptr;
+    }
+
+    // Without surfaceless support bind a tiny pbuffer, rendering goes to a Framebuffer anyway
+    if (!HasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context")) {
+        const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        context->m_Surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+        if (context->m_Surface == EGL_NO_SURFACE) {
+            KOSMIC_ERROR("Headless: failed to create pbuffer surface (0x{:x})", eglGetError());
+            context->m_Surface = nullptr;
+            return nullptr;
+        }
+    }
+
+    if (!context->MakeCurrent()) {
+        KOSMIC_ERROR("Headless: eglMakeCurrent failed (0x{:x})", eglGetError());
+        return nullptr;
+    }
+
+    KOSMIC_INFO("Headless: EGL {} context created ({})",
+                eglQueryString(display, EGL_VERSION),
+                context->m_Surface ? "pbuffer" : "surfaceless");
+    return context;
+}
+
+bool HeadlessContext::MakeCurrent() const {
+    EGLSurface surface = m_Surface ? m_Surface : EGL_NO_SURFACE;
+    return eglMakeCurrent(m_Display, surface, surface, m_Context) == EGL_TRUE;
+}
+
+#else
+
+HeadlessContext::~HeadlessContext() = default;
+
+std::unique_ptr<HeadlessContext> HeadlessContext::Create(int, int) {
+    KOSMIC_ERROR("Headless: engine was built without EGL support");
+    return nullptr;
+}
+
+bool HeadlessContext::MakeCurrent() const {
+    return false;
+}
+
+#endif
+
+} // namespace Kosmic
@@ -0,0 +1,333 @@
+#include "Kosmic/Core/Jobs.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include "Kosmic/Core/Profiler.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace Kosmic::Jobs {
+
+struct Job {
+    JobFunction function;
+    Counter* counter;
+};
+
+namespace {
+
+// Chase-Lev work-stealing deque with a fixed capacity.
+// The owner pushes and pops at the bottom, thieves steal from the top.
+class WorkStealingDeque {
+public:
+    static constexpr int64_t Capacity = 4096;
+    static constexpr int64_t Mask = Capacity - 1;
+
+    bool Push(Job* job) {
+        int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+        int64_t top = m_Top.load(std::memory_order_acquire);
+        if (bottom - top >= Capacity) return false;
+        m_Buffer[bottom & Mask].store(job, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Job* Pop() {
+        int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+        m_Bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_Top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            // Empty
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job* job = m_Buffer[bottom & Mask].load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // Last element, race against thieves for it
+            if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                job = nullptr;
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* Steal() {
+        int64_t top = m_Top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+        if (top >= bottom) return nullptr;
+
+        Job* job = m_Buffer[top & Mask].load(std::memory_order_acquire);
+        if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr; // Lost the race, caller may retry elsewhere
+        return job;
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> m_Top{0};
+    alignas(64) std::atomic<int64_t> m_Bottom{0};
+    std::unique_ptr<std::atomic<Job*>[]> m_Buffer{new std::atomic<Job*>[Capacity]};
+};
+
+constexpr uint32_t ForeignThread = UINT32_MAX;
+thread_local uint32_t t_ThreadIndex = ForeignThread;
+thread_local uint32_t t_StealSeed = 0;
+
+} // namespace
+
+struct Scheduler {
+    // Deque 0 belongs to the thread that called Init, the others to workers
+    std::vector<std::unique_ptr<WorkStealingDeque>> deques;
+    std::vector<std::thread> workers;
+
+    // Jobs from threads without a deque, or overflow of a full deque
+    std::mutex injectionMutex;
+    std::deque<Job*> injectionQueue;
+
+    // Idle workers sleep here
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+    std::atomic<int64_t> queuedJobs{0};
+    std::atomic<uint32_t> sleepingWorkers{0};
+    std::atomic<bool> running{false};
+
+    static Scheduler& Get() {
+        static Scheduler scheduler;
+        return scheduler;
+    }
+
+    static void Increment(Counter& counter) {
+        counter.m_Pending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Releases the continuations once the last job of the counter finishes.
+    // The final decrement happens under the lock so a waiter that observed
+    // zero (and then synchronized on the lock) may safely destroy the counter.
+    static void Decrement(Counter& counter) {
+        std::vector<Job*> continuations;
+        {
+            std::lock_guard<std::mutex> lock(counter.m_Mutex);
+            if (counter.m_Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                continuations.swap(counter.m_Continuations);
+        }
+        for (Job* job : continuations)
+            Get().Submit(job);
+    }
+
+    // Waits for a decrementing thread to leave the counter's critical section
+    static void Release(Counter& counter) {
+        std::lock_guard<std::mutex> lock(counter.m_Mutex);
+    }
+
+    // Adds job to counter's continuations, or returns false if it is already done
+    static bool Defer(Counter& counter, Job* job) {
+        std::lock_guard<std::mutex> lock(counter.m_Mutex);
+        if (counter.m_Pending.load(std::memory_order_acquire) == 0) return false;
+        counter.m_Continuations.push_back(job);
+        return true;
+    }
+
+    void Submit(Job* job) {
+        bool pushed = t_ThreadIndex != ForeignThread && deques[t_ThreadIndex]->Push(job);
+        if (!pushed) {
+            std::lock_guard<std::mutex> lock(injectionMutex);
+            injectionQueue.push_back(job);
+        }
+
+        queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+        if (sleepingWorkers.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            sleepCondition.notify_one();
+        }
+    }
+
+    Job* TakeInjected() {
+        std::lock_guard<std::mutex> lock(injectionMutex);
+        if (injectionQueue.empty()) return nullptr;
+        Job* job = injectionQueue.front();
+        injectionQueue.pop_front();
+        return job;
+    }
+
+    // Own deque first, then the injection queue, then steal from a random victim
+    Job* FindJob() {
+        Job* job = nullptr;
+        if (t_ThreadIndex != ForeignThread)
+            job = deques[t_ThreadIndex]->Pop();
+        if (!job)
+            job = TakeInjected();
+        if (!job) {
+            size_t count = deques.size();
+            t_StealSeed = t_StealSeed * 1664525u + 1013904223u;
+            size_t start = t_StealSeed % count;
+            for (size_t i = 0; i < count && !job; ++i) {
+                size_t victim = (start + i) % count;
+                if (victim != t_ThreadIndex)
+                    job = deques[victim]->Steal();
+            }
+        }
+        if (job)
+            queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        return job;
+    }
+
+    static void Execute(Job* job) {
+        job->function();
+        if (job->counter)
+            Decrement(*job->counter);
+        delete job;
+    }
+
+    void WorkerLoop(uint32_t index) {
+        t_ThreadIndex = index;
+        t_StealSeed = index * 2654435761u;
+        std::string name = "Worker " + std::to_string(index);
+        KOSMIC_PROFILE_THREAD(name.c_str());
+
+        constexpr int SpinsBeforeSleep = 64;
+        int idleSpins = 0;
+        while (running.load(std::memory_order_acquire)) {
+            if (Job* job = FindJob()) {
+                Execute(job);
+                idleSpins = 0;
+                continue;
+            }
+            if (++idleSpins < SpinsBeforeSleep) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+            sleepCondition.wait(lock, [this] {
+                return queuedJobs.load(std::memory_order_seq_cst) > 0 || !running.load(std::memory_order_acquire);
+            });
+            sleepingWorkers.fetch_sub(1, std::memory_order_seq_cst);
+            idleSpins = 0;
+        }
+    }
+};
+
+void Init(uint32_t workerCount) {
+    Scheduler& scheduler = Scheduler::Get();
+    if (scheduler.running) return;
+
+    if (workerCount == 0) {
+        uint32_t cores = std::max(1u, std::thread::hardware_concurrency());
+        workerCount = cores - 1;
+    }
+
+    t_ThreadIndex = 0;
+    scheduler.deques.clear();
+    for (uint32_t i = 0; i <= workerCount; ++i)
+        scheduler.deques.push_back(std::make_unique<WorkStealingDeque>());
+
+    scheduler.running = true;
+    for (uint32_t i = 1; i <= workerCount; ++i)
+        scheduler.workers.emplace_back([&scheduler, i] { scheduler.WorkerLoop(i); });
+
+    KOSMIC_INFO("Jobs: started {} worker thread(s)", workerCount);
+}
+
+void Shutdown() {
+    Scheduler& scheduler = Scheduler::Get();
+    if (!scheduler.running) return;
+
+    // Finish whatever is still queued on this thread before stopping
+    while (Job* job = scheduler.FindJob())
+        Scheduler::Execute(job);
+
+    {
+        std::lock_guard<std::mutex> lock(scheduler.sleepMutex);
+        scheduler.running = false;
+    }
+    scheduler.sleepCondition.notify_all();
+    for (std::thread& worker : scheduler.workers)
+        worker.join();
+    scheduler.workers.clear();
+
+    while (Job* job = scheduler.FindJob())
+        Scheduler::Execute(job);
+    scheduler.deques.clear();
+    t_ThreadIndex = ForeignThread;
+}
+
+bool IsInitialized() {
+    return Scheduler::Get().running;
+}
+
+uint32_t GetWorkerCount() {
+    return static_cast<uint32_t>(Scheduler::Get().workers.size());
+}
+
+uint32_t GetThreadIndex() {
+    return t_ThreadIndex;
+}
+
+void Run(JobFunction function, Counter* counter) {
+    Scheduler& scheduler = Scheduler::Get();
+    if (!scheduler.running || scheduler.workers.empty()) {
+        // Nobody else could pick it up
+        function();
+        return;
+    }
+
+    if (counter) Scheduler::Increment(*counter);
+    scheduler.Submit(new Job{std::move(function), counter});
+}
+
+void RunAfter(Counter& dependency, JobFunction function, Counter* counter) {
+    Scheduler& scheduler = Scheduler::Get();
+    if (!scheduler.running || scheduler.workers.empty()) {
+        Wait(dependency);
+        function();
+        return;
+    }
+
+    if (counter) Scheduler::Increment(*counter);
+    Job* job = new Job{std::move(function), counter};
+    if (!Scheduler::Defer(dependency, job))
+        scheduler.Submit(job);
+}
+
+void Wait(Counter& counter) {
+    Scheduler& scheduler = Scheduler::Get();
+    while (!counter.IsDone()) {
+        if (scheduler.running) {
+            if (Job* job = scheduler.FindJob()) {
+                Scheduler::Execute(job);
+                continue;
+            }
+        }
+        std::this_thread::yield();
+    }
+    Scheduler::Release(counter);
+}
+
+void ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& body) {
+    if (count == 0) return;
+    grainSize = std::max(1u, grainSize);
+
+    Scheduler& scheduler = Scheduler::Get();
+    if (!scheduler.running || scheduler.workers.empty() || count <= grainSize) {
+        body(0, count);
+        return;
+    }
+
+    Counter counter;
+    // Keep the last chunk for this thread instead of queueing and then stealing it back
+    uint32_t begin = 0;
+    for (; begin + grainSize < count; begin += grainSize) {
+        uint32_t end = begin + grainSize;
+        Run([&body, begin, end] { body(begin, end); }, &counter);
+    }
+    body(begin, count);
+    Wait(counter);
+}
+
+} // namespace Kosmic::Jobs
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <ostream>
+#include <string_view>
+
+// Engine internal: helpers for the JSON files written by the profiler and
+// the benchmark driver
+namespace Kosmic::Json {
+
+// Writes text as the inside of a JSON string: quotes and backslashes
+// escaped, control characters as \u00XX
+inline void WriteEscaped(std::ostream& out, std::string_view text) {
+    constexpr char Hex[] = "0123456789abcdef";
+    for (char c : text) {
+        if (c == '"' || c == '\\') out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20) out << "\\u00" << Hex[c >> 4] << Hex[c & 15];
+        else out << c;
+    }
+}
+
+} // namespace Kosmic::Json
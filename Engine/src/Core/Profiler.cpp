@@ -0,0 +1,236 @@
+#include "Kosmic/Core/Profiler.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include "Json.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace Kosmic::Profiler {
+
+namespace {
+
+struct Event {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+    uint32_t depth;
+};
+
+// Single-producer/single-consumer ring: the owning thread writes zones,
+// EndFrame on the main thread drains them. No locks on either side.
+struct ThreadBuffer {
+    static constexpr uint64_t Capacity = 1 << 16;
+
+    std::unique_ptr<Event[]> events{new Event[Capacity]};
+    std::atomic<uint64_t> head{0}; // Next slot to write (owner)
+    std::atomic<uint64_t> tail{0}; // Next slot to read (collector)
+    std::atomic<uint64_t> dropped{0};
+    uint32_t depth{0};             // Only touched by the owner
+    uint32_t threadID{0};
+    std::string name;
+};
+
+struct CapturedEvent {
+    Event event;
+    uint32_t threadID;
+};
+
+struct ProfilerState {
+    std::mutex registryMutex; // Guards thread registration only
+    std::vector<std::shared_ptr<ThreadBuffer>> threads;
+
+    // Touched only by the thread calling EndFrame/Capture
+    std::vector<ZoneStats> frameStats;
+    std::unordered_map<std::string_view, size_t> statIndex;
+    uint64_t lastFrameEnd{0};
+    uint64_t frameTime{0};
+    std::atomic<bool> capturing{false};
+    uint64_t captureStart{0};
+    std::vector<CapturedEvent> capture;
+};
+
+ProfilerState& State() {
+    static ProfilerState state;
+    return state;
+}
+
+ThreadBuffer& LocalBuffer() {
+    // Buffers are owned by the registry so they outlive their threads
+    thread_local ThreadBuffer* buffer = [] {
+        auto created = std::make_shared<ThreadBuffer>();
+        ProfilerState& state = State();
+        std::lock_guard<std::mutex> lock(state.registryMutex);
+        created->threadID = static_cast<uint32_t>(state.threads.size());
+        created->name = created->threadID == 0 ? "Main" : "Thread " + std::to_string(created->threadID);
+        state.threads.push_back(created);
+        return created.get();
+    }();
+    return *buffer;
+}
+
+void Push(ThreadBuffer& buffer, const Event& event) {
+    uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    if (head - buffer.tail.load(std::memory_order_acquire) >= ThreadBuffer::Capacity) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer.events[head % ThreadBuffer::Capacity] = event;
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+// Moves every finished zone out of the thread buffers
+template<typename Fn>
+void Drain(Fn&& consume) {
+    ProfilerState& state = State();
+    std::vector<std::shared_ptr<ThreadBuffer>> threads;
+    {
+        std::lock_guard<std::mutex> lock(state.registryMutex);
+        threads = state.threads;
+    }
+    for (auto& buffer : threads) {
+        uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        for (uint64_t i = tail; i < head; ++i)
+            consume(*buffer, buffer->events[i % ThreadBuffer::Capacity]);
+        buffer->tail.store(head, std::memory_order_release);
+    }
+}
+
+} // namespace
+
+uint64_t Now() {
+    using namespace std::chrono;
+    return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+void SetThreadName(const char* name) {
+    ThreadBuffer& buffer = LocalBuffer();
+    std::lock_guard<std::mutex> lock(State().registryMutex);
+    buffer.name = name;
+}
+
+ScopedZone::ScopedZone(const char* name) : m_Name(name) {
+    ++LocalBuffer().depth;
+    m_Start = Now();
+}
+
+ScopedZone::~ScopedZone() {
+    uint64_t end = Now();
+    ThreadBuffer& buffer = LocalBuffer();
+    --buffer.depth;
+    Push(buffer, {m_Name, m_Start, end, buffer.depth});
+}
+
+void EndFrame() {
+    ProfilerState& state = State();
+    uint64_t now = Now();
+    state.frameTime = state.lastFrameEnd ? now - state.lastFrameEnd : 0;
+    state.lastFrameEnd = now;
+
+    state.frameStats.clear();
+    state.statIndex.clear();
+    bool capturing = state.capturing.load(std::memory_order_relaxed);
+
+    Drain([&](const ThreadBuffer& buffer, const Event& event) {
+        auto [it, inserted] = state.statIndex.try_emplace(event.name, state.frameStats.size());
+        if (inserted)
+            state.frameStats.push_back({event.name, event.depth, 0, 0});
+        ZoneStats& stats = state.frameStats[it->second];
+        stats.depth = std::min(stats.depth, event.depth);
+        stats.calls++;
+        stats.totalTime += event.end - event.start;
+
+        if (capturing)
+            state.capture.push_back({event, buffer.threadID});
+    });
+
+    std::sort(state.frameStats.begin(), state.frameStats.end(),
+              [](const ZoneStats& a, const ZoneStats& b) { return a.totalTime > b.totalTime; });
+}
+
+const std::vector<ZoneStats>& GetFrameStats() {
+    return State().frameStats;
+}
+
+uint64_t GetFrameTime() {
+    return State().frameTime;
+}
+
+void BeginCapture() {
+    ProfilerState& state = State();
+    if (state.capturing) return;
+    // Discard zones recorded before the capture started
+    Drain([](const ThreadBuffer&, const Event&) {});
+    state.capture.clear();
+    state.captureStart = Now();
+    state.capturing = true;
+    KOSMIC_INFO("Profiler: capture started");
+}
+
+bool EndCapture(const std::string& path) {
+    ProfilerState& state = State();
+    if (!state.capturing) return false;
+
+    Drain([&](const ThreadBuffer& buffer, const Event& event) {
+        state.capture.push_back({event, buffer.threadID});
+    });
+    state.capturing = false;
+
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        KOSMIC_ERROR("Profiler: failed to open {} for writing", path);
+        return false;
+    }
+
+    std::vector<std::pair<uint32_t, std::string>> threadNames;
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(state.registryMutex);
+        for (auto& buffer : state.threads) {
+            threadNames.emplace_back(buffer->threadID, buffer->name);
+            dropped += buffer->dropped.exchange(0);
+        }
+    }
+
+    // Chrome trace format: complete ("X") events with microsecond timestamps
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& [threadID, name] : threadNames) {
+        out << (first ? "" : ",\n")
+            << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":0,\"tid\":" << threadID
+            << ",\"args\":{\"name\":\"";
+        Json::WriteEscaped(out, name);
+        out << "\"}}";
+        first = false;
+    }
+    out.precision(3);
+    out << std::fixed;
+    for (const CapturedEvent& captured : state.capture) {
+        const Event& event = captured.event;
+        if (event.start < state.captureStart) continue;
+        out << (first ? "" : ",\n") << "{\"ph\":\"X\",\"name\":\"";
+        Json::WriteEscaped(out, event.name);
+        out << "\",\"pid\":0,\"tid\":" << captured.threadID
+            << ",\"ts\":" << (event.start - state.captureStart) / 1000.0
+            << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+        first = false;
+    }
+    out << "\n]}\n";
+
+    KOSMIC_INFO("Profiler: wrote {} zones to {}", state.capture.size(), path);
+    if (dropped)
+        KOSMIC_WARN("Profiler: {} zones were dropped because a thread buffer was full", dropped);
+    state.capture.clear();
+    return true;
+}
+
+bool IsCapturing() {
+    return State().capturing;
+}
+
+} // namespace Kosmic::Profiler
@@ -0,0 +1,101 @@
+#include "Kosmic/ECS/RenderSystem.hpp"
+#include "Kosmic/Renderer/Renderer3D.hpp"
+#include "Kosmic/Renderer/RenderStats.hpp"
+#include "Kosmic/Core/Jobs.hpp"
+#include "Kosmic/Core/Profiler.hpp"
+#include <atomic>
+
+namespace Kosmic::ECS {
+
+void RenderSystem::Submit(entt::registry& registry, Renderer::Renderer3D& renderer) {
+    KOSMIC_PROFILE_SCOPE("RenderSystem::Submit");
+    m_Batches.clear();
+    m_BatchLookup.clear();
+    m_Entities.clear();
+    m_Slots.clear();
+
+    // Group entities by mesh and material, counting the size of each group
+    auto view = registry.view<const Transform, const MeshRenderer>();
+    for (auto entity : view) {
+        const MeshRenderer& meshRenderer = view.get<const MeshRenderer>(entity);
+        if (!meshRenderer.mesh) continue;
+
+        BatchKey key{meshRenderer.mesh.get(), meshRenderer.material.get()};
+        auto [it, inserted] = m_BatchLookup.try_emplace(key, static_cast<uint32_t>(m_Batches.size()));
+        if (inserted)
+            m_Batches.push_back({meshRenderer.mesh, meshRenderer.material, 0, 0});
+        m_Batches[it->second].count++;
+
+        m_Entities.push_back(entity);
+        m_Slots.push_back(it->second);
+    }
+
+    // Lay the groups out back to back, then give each entity its slot
+    uint32_t total = 0;
+    for (Batch& batch : m_Batches) {
+        batch.first = total;
+        total += batch.count;
+        batch.count = 0;
+    }
+    for (uint32_t& slot : m_Slots) {
+        Batch& batch = m_Batches[slot];
+        slot = batch.first + batch.count++;
+    }
+
+    // Matrix building dominates with many entities, spread it over the workers
+    const auto& camera = renderer.GetCamera();
+    // With GPU culling the renderer culls them itself
+    bool cull = camera && renderer.IsFrustumCullingEnabled() && !renderer.IsGPUCullingEnabled();
+    Math::Frustum frustum = cull ? camera->GetFrustum() : Math::Frustum{};
+
+    m_Instances.resize(total);
+    m_Spheres.Resize(cull ? total : 0);
+    m_Visibility.resize(cull ? total : 0);
+    std::atomic<uint32_t> visibleCount{0};
+
+    Jobs::ParallelFor(static_cast<uint32_t>(m_Entities.size()), 2048, [&](uint32_t begin, uint32_t end) {
+        KOSMIC_PROFILE_SCOPE("RenderSystem::BuildInstances");
+        for (uint32_t i = begin; i < end; ++i) {
+            const Transform& transform = view.get<const Transform>(m_Entities[i]);
+            const MeshRenderer& meshRenderer = view.get<const MeshRenderer>(m_Entities[i]);
+            Math::Mat4 matrix = transform.GetMatrix();
+            m_Instances[m_Slots[i]] = {matrix, meshRenderer.color};
+            if (cull)
+                m_Spheres.Set(m_Slots[i], meshRenderer.mesh->GetBoundingSphere().Transformed(matrix));
+        }
+    });
+
+    if (cull) {
+        // A chunk's slots are scattered, so cull contiguous slot ranges in a second pass
+        Jobs::ParallelFor(total, 4096, [&](uint32_t begin, uint32_t end) {
+            KOSMIC_PROFILE_SCOPE("RenderSystem::Cull");
+            visibleCount += Renderer::Culling::CullSpheres(frustum, m_Spheres, begin, end, m_Visibility.data());
+        });
+
+        // Squeeze the visible instances of every batch to its front
+        Jobs::ParallelFor(static_cast<uint32_t>(m_Batches.size()), 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t b = begin; b < end; ++b) {
+                Batch& batch = m_Batches[b];
+                uint32_t write = batch.first;
+                for (uint32_t i = batch.first; i < batch.first + batch.count; ++i) {
+                    if (m_Visibility[i]) {
+                        if (write != i) m_Instances[write] = m_Instances[i];
+                        ++write;
+                    }
+                }
+                batch.count = write - batch.first;
+            }
+        });
+    } else {
+        visibleCount = total;
+    }
+    m_VisibleCount = visibleCount;
+    m_CulledCount = total - m_VisibleCount;
+    // The visible ones are counted when the queue draws them
+    Renderer::RenderStatistics::GetCurrent().culledObjects += m_CulledCount;
+
+    for (const Batch& batch : m_Batches)
+        renderer.SubmitInstanced(batch.mesh, batch.material, m_Instances.data() + batch.first, batch.count);
+}
+
+} // namespace Kosmic::ECS
@@ -81,6 +81,10 @@ const Math::Mat4 Camera::GetViewMatrixNoTranslation() const {
     return view;
 }
 
+Math::Frustum Camera::GetFrustum() const {
+    return Math::Frustum::FromMatrix(m_ProjectionMatrix * m_ViewMatrix);
+}
+
 const Math::Mat4 Camera::GetSkyboxProjectionMatrix() const {
     // Always use perspective projection for the skybox
     return glm::perspective(glm::radians(m_FOV), m_AspectRatio, m_NearPlane, m_FarPlane);
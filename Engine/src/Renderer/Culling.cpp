@@ -0,0 +1,123 @@
+#include "Kosmic/Renderer/Culling.hpp"
+#include <bit>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+    #define KOSMIC_CULL_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define KOSMIC_CULL_SSE
+#endif
+
+namespace Kosmic::Renderer::Culling {
+
+namespace {
+
+// Reference version, also handles the tail of the SIMD loops
+uint32_t CullScalar(const Math::Frustum& frustum, const SphereList& spheres,
+                    uint32_t begin, uint32_t end, uint8_t* visible) {
+    uint32_t visibleCount = 0;
+    for (uint32_t i = begin; i < end; ++i) {
+        bool inside = true;
+        for (const Math::Vector4& plane : frustum.planes) {
+            float distance = plane.x * spheres.x[i] + plane.y * spheres.y[i] + plane.z * spheres.z[i] + plane.w;
+            inside &= distance >= -spheres.radius[i];
+        }
+        visible[i] = inside;
+        visibleCount += inside;
+    }
+    return visibleCount;
+}
+
+} // namespace
+
+#if defined(KOSMIC_CULL_AVX)
+
+uint32_t CullSpheres(const Math::Frustum& frustum, const SphereList& spheres,
+                     uint32_t begin, uint32_t end, uint8_t* visible) {
+    __m256 planeX[Math::Frustum::Count], planeY[Math::Frustum::Count];
+    __m256 planeZ[Math::Frustum::Count], planeW[Math::Frustum::Count];
+    for (int p = 0; p < Math::Frustum::Count; ++p) {
+        planeX[p] = _mm256_set1_ps(frustum.planes[p].x);
+        planeY[p] = _mm256_set1_ps(frustum.planes[p].y);
+        planeZ[p] = _mm256_set1_ps(frustum.planes[p].z);
+        planeW[p] = _mm256_set1_ps(frustum.planes[p].w);
+    }
+
+    uint32_t visibleCount = 0;
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 x = _mm256_loadu_ps(&spheres.x[i]);
+        __m256 y = _mm256_loadu_ps(&spheres.y[i]);
+        __m256 z = _mm256_loadu_ps(&spheres.z[i]);
+        __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&spheres.radius[i]));
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < Math::Frustum::Count; ++p) {
+            __m256 distance = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(planeX[p], x), _mm256_mul_ps(planeY[p], y)),
+                _mm256_add_ps(_mm256_mul_ps(planeZ[p], z), planeW[p]));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+        }
+
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+        for (uint32_t k = 0; k < 8; ++k)
+            visible[i + k] = (mask >> k) & 1;
+        visibleCount += std::popcount(mask);
+    }
+    return visibleCount + CullScalar(frustum, spheres, i, end, visible);
+}
+
+const char* GetKernelName() { return "AVX"; }
+
+#elif defined(KOSMIC_CULL_SSE)
+
+uint32_t CullSpheres(const Math::Frustum& frustum, const SphereList& spheres,
+                     uint32_t begin, uint32_t end, uint8_t* visible) {
+    __m128 planeX[Math::Frustum::Count], planeY[Math::Frustum::Count];
+    __m128 planeZ[Math::Frustum::Count], planeW[Math::Frustum::Count];
+    for (int p = 0; p < Math::Frustum::Count; ++p) {
+        planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+        planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+        planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+        planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+    }
+
+    uint32_t visibleCount = 0;
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 x = _mm_loadu_ps(&spheres.x[i]);
+        __m128 y = _mm_loadu_ps(&spheres.y[i]);
+        __m128 z = _mm_loadu_ps(&spheres.z[i]);
+        __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&spheres.radius[i]));
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < Math::Frustum::Count; ++p) {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y)),
+                _mm_add_ps(_mm_mul_ps(planeZ[p], z), planeW[p]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+        }
+
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(inside));
+        for (uint32_t k = 0; k < 4; ++k)
+            visible[i + k] = (mask >> k) & 1;
+        visibleCount += std::popcount(mask);
+    }
+    return visibleCount + CullScalar(frustum, spheres, i, end, visible);
+}
+
+const char* GetKernelName() { return "SSE"; }
+
+#else
+
+uint32_t CullSpheres(const Math::Frustum& frustum, const SphereList& spheres,
+                     uint32_t begin, uint32_t end, uint8_t* visible) {
+    return CullScalar(frustum, spheres, begin, end, visible);
+}
+
+const char* GetKernelName() { return "Scalar"; }
+
+#endif
+
+} // namespace Kosmic::Renderer::Culling
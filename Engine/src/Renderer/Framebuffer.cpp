@@ -1,73 +1,285 @@
 #include "Kosmic/Renderer/Framebuffer.hpp"
+#include "Kosmic/Renderer/StateManager.hpp"
 #include <GL/glew.h>
+#include <algorithm>
 #include "Kosmic/Core/Logging.hpp"
 
 namespace Kosmic::Renderer {
 
+namespace {
+
+struct GLFormat {
+    GLenum internalFormat;
+    GLenum format;
+    GLenum type;
+};
+
+GLFormat GetGLFormat(FramebufferFormat format) {
+    switch (format) {
+        case FramebufferFormat::RGBA8:           return {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE};
+        case FramebufferFormat::RGBA16F:         return {GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT};
+        case FramebufferFormat::R11G11B10F:      return {GL_R11F_G11F_B10F, GL_RGB, GL_UNSIGNED_INT_10F_11F_11F_REV};
+        case FramebufferFormat::Depth24Stencil8: return {GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8};
+        case FramebufferFormat::Depth32F:        return {GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT};
+        case FramebufferFormat::None:            break;
+    }
+    return {GL_NONE, GL_NONE, GL_NONE};
+}
+
+GLenum GetDepthAttachmentPoint(FramebufferFormat format) {
+    return format == FramebufferFormat::Depth24Stencil8 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+}
+
+// Growing resizes allocate an eighth more, in 64 pixel steps, so dragging a
+// window edge reallocates every few dozen pixels rather than every frame
+uint32_t GetGrowSize(uint32_t size) {
+    return (size + size / 8 + 63) / 64 * 64;
+}
+
+GLuint CreateTexture(FramebufferFormat format, uint32_t width, uint32_t height) {
+    GLFormat gl = GetGLFormat(format);
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    StateManager::BindTexture(0, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, gl.internalFormat, width, height, 0, gl.format, gl.type, nullptr);
+    GLint filter = IsDepthFormat(format) ? GL_NEAREST : GL_LINEAR;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+GLuint CreateRenderbuffer(FramebufferFormat format, uint32_t width, uint32_t height, uint32_t samples) {
+    GLuint renderbuffer = 0;
+    glGenRenderbuffers(1, &renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    if (samples > 1)
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GetGLFormat(format).internalFormat, width, height);
+    else
+        glRenderbufferStorage(GL_RENDERBUFFER, GetGLFormat(format).internalFormat, width, height);
+    return renderbuffer;
+}
+
+void SetDrawBuffers(uint32_t count) {
+    if (count == 0) {
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        return;
+    }
+    GLenum buffers[FramebufferSpecification::MaxColorAttachments];
+    for (uint32_t i = 0; i < count; ++i) buffers[i] = GL_COLOR_ATTACHMENT0 + i;
+    glDrawBuffers(static_cast<GLsizei>(count), buffers);
+}
+
+} // namespace
+
+bool IsDepthFormat(FramebufferFormat format) {
+    return format == FramebufferFormat::Depth24Stencil8 || format == FramebufferFormat::Depth32F;
+}
+
+uint32_t GetFramebufferFormatSize(FramebufferFormat format) {
+    switch (format) {
+        case FramebufferFormat::RGBA16F: return 8;
+        case FramebufferFormat::None:    return 0;
+        default:                         return 4;
+    }
+}
+
+uint32_t FramebufferSpecification::GetColorAttachmentCount() const {
+    uint32_t count = 0;
+    while (count < MaxColorAttachments && colorAttachments[count] != FramebufferFormat::None) count++;
+    return count;
+}
+
+bool FramebufferSpecification::IsCompatible(const FramebufferSpecification& other) const {
+    return colorAttachments == other.colorAttachments && depthAttachment == other.depthAttachment &&
+           depthTexture == other.depthTexture && samples == other.samples;
+}
+
+size_t FramebufferSpecification::GetSize(uint32_t width, uint32_t height) const {
+    size_t color = 0;
+    for (uint32_t i = 0; i < GetColorAttachmentCount(); ++i) color += GetFramebufferFormatSize(colorAttachments[i]);
+    size_t depth = GetFramebufferFormatSize(depthAttachment);
+    size_t perPixel = (color + depth) * std::max(samples, 1u);
+    // Resolve textures
+    if (samples > 1) perPixel += color + (depthTexture ? depth : 0);
+    return size_t(width) * height * perPixel;
+}
+
 class OpenGLFramebuffer : public Framebuffer {
 public:
-    OpenGLFramebuffer(uint32_t width, uint32_t height)
-        : m_Width(width), m_Height(height) { Invalidate(); }
-    
-    ~OpenGLFramebuffer() override {
-        glDeleteFramebuffers(1, &m_RendererID);
-        glDeleteTextures(1, &m_ColorAttachment);
-        glDeleteRenderbuffers(1, &m_DepthAttachment);
+    explicit OpenGLFramebuffer(const FramebufferSpecification& specification) : m_Specification(specification) {
+        if (m_Specification.samples > 1) {
+            GLint maxSamples = 1;
+            glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+            m_Specification.samples = std::min(m_Specification.samples, static_cast<uint32_t>(maxSamples));
+        }
+        if (!IsDepthFormat(m_Specification.depthAttachment)) m_Specification.depthTexture = false;
+        Invalidate(m_Specification.width, m_Specification.height);
     }
-    
+
+    ~OpenGLFramebuffer() override { Release(); }
+
     void Bind() const override {
-        glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID);
+        StateManager::BindFramebuffer(m_RendererID);
     }
-    
+
     void Unbind() const override {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        StateManager::BindFramebuffer(0);
     }
-    
+
     void Resize(uint32_t width, uint32_t height) override {
-        m_Width = width;
-        m_Height = height;
-        Invalidate();
+        if (width == 0 || height == 0) return;
+        m_Specification.width = width;
+        m_Specification.height = height;
+
+        bool fits = width <= m_AllocatedWidth && height <= m_AllocatedHeight;
+        // Shrunk to under a quarter of the allocation, give the memory back
+        bool wasteful = size_t(width) * height * 4 < size_t(m_AllocatedWidth) * m_AllocatedHeight;
+        if (fits && !wasteful) return;
+        if (fits) Invalidate(width, height);
+        else Invalidate(std::max(GetGrowSize(width), m_AllocatedWidth), std::max(GetGrowSize(height), m_AllocatedHeight));
     }
-    
-private:
-    void Invalidate() {
-        if(m_RendererID) {
-            glDeleteFramebuffers(1, &m_RendererID);
-            glDeleteTextures(1, &m_ColorAttachment);
-            glDeleteRenderbuffers(1, &m_DepthAttachment);
+
+    void Resolve() const override {
+        if (!m_ResolveID) return;
+        // Read and draw are bound apart here, and put back together after
+        uint32_t bound = StateManager::GetFramebuffer();
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_ResolveID);
+
+        GLint width = static_cast<GLint>(m_Specification.width);
+        GLint height = static_cast<GLint>(m_Specification.height);
+        uint32_t colorCount = m_Specification.GetColorAttachmentCount();
+        // One attachment per blit, read and draw buffers select which
+        for (uint32_t i = 0; i < colorCount; ++i) {
+            glReadBuffer(GL_COLOR_ATTACHMENT0 + i);
+            glDrawBuffer(GL_COLOR_ATTACHMENT0 + i);
+            glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
         }
-        glGenFramebuffers(1, &m_RendererID);
-        glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID);
-
-        // Create color attachment texture
-        glGenTextures(1, &m_ColorAttachment);
-        glBindTexture(GL_TEXTURE_2D, m_ColorAttachment);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_ColorAttachment, 0);
-
-        // Create renderbuffer for depth & stencil attachment
-        glGenRenderbuffers(1, &m_DepthAttachment);
-        glBindRenderbuffer(GL_RENDERBUFFER, m_DepthAttachment);
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_Width, m_Height);
-        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_DepthAttachment);
+        if (m_Specification.depthTexture)
+            glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        if (colorCount) {
+            glReadBuffer(GL_COLOR_ATTACHMENT0);
+            SetDrawBuffers(colorCount);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, bound);
+    }
 
+    uint32_t GetID() const override { return m_RendererID; }
+    uint32_t GetColorAttachment(uint32_t index) const override {
+        return index < FramebufferSpecification::MaxColorAttachments ? m_ColorTextures[index] : 0;
+    }
+    uint32_t GetDepthAttachment() const override { return m_DepthTexture; }
+    uint32_t GetWidth() const override { return m_Specification.width; }
+    uint32_t GetHeight() const override { return m_Specification.height; }
+    uint32_t GetAllocatedWidth() const override { return m_AllocatedWidth; }
+    uint32_t GetAllocatedHeight() const override { return m_AllocatedHeight; }
+    const FramebufferSpecification& GetSpecification() const override { return m_Specification; }
+
+private:
+    void Invalidate(uint32_t width, uint32_t height) {
+        Release();
+        // Creating the attachments binds them, the caller's binding comes back at the end
+        uint32_t bound = StateManager::GetFramebuffer();
+        m_AllocatedWidth = width;
+        m_AllocatedHeight = height;
+
+        const FramebufferSpecification& spec = m_Specification;
+        uint32_t colorCount = spec.GetColorAttachmentCount();
+        bool multisampled = spec.samples > 1;
+
+        glGenFramebuffers(1, &m_RendererID);
+        StateManager::BindFramebuffer(m_RendererID);
+        for (uint32_t i = 0; i < colorCount; ++i) {
+            if (multisampled) {
+                m_ColorRenderbuffers[i] = CreateRenderbuffer(spec.colorAttachments[i], width, height, spec.samples);
+                glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_RENDERBUFFER,
+                                          m_ColorRenderbuffers[i]);
+            } else {
+                m_ColorTextures[i] = CreateTexture(spec.colorAttachments[i], width, height);
+                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, m_ColorTextures[i], 0);
+            }
+        }
+        if (IsDepthFormat(spec.depthAttachment)) {
+            GLenum attachment = GetDepthAttachmentPoint(spec.depthAttachment);
+            if (spec.depthTexture && !multisampled) {
+                m_DepthTexture = CreateTexture(spec.depthAttachment, width, height);
+                glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, m_DepthTexture, 0);
+            } else {
+                m_DepthRenderbuffer = CreateRenderbuffer(spec.depthAttachment, width, height, spec.samples);
+                glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, m_DepthRenderbuffer);
+            }
+        }
+        SetDrawBuffers(colorCount);
         if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
             KOSMIC_ERROR("Framebuffer is incomplete!");
         }
-        
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        // Single sampled textures the multisampled attachments resolve into
+        if (multisampled) {
+            glGenFramebuffers(1, &m_ResolveID);
+            StateManager::BindFramebuffer(m_ResolveID);
+            for (uint32_t i = 0; i < colorCount; ++i) {
+                m_ColorTextures[i] = CreateTexture(spec.colorAttachments[i], width, height);
+                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, m_ColorTextures[i], 0);
+            }
+            if (spec.depthTexture) {
+                m_DepthTexture = CreateTexture(spec.depthAttachment, width, height);
+                glFramebufferTexture2D(GL_FRAMEBUFFER, GetDepthAttachmentPoint(spec.depthAttachment), GL_TEXTURE_2D,
+                                       m_DepthTexture, 0);
+            }
+            SetDrawBuffers(colorCount);
+            if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+                KOSMIC_ERROR("Framebuffer resolve target is incomplete!");
+            }
+        }
+
+        StateManager::BindFramebuffer(bound);
+    }
+
+    void Release() {
+        if (m_RendererID) glDeleteFramebuffers(1, &m_RendererID);
+        if (m_ResolveID) glDeleteFramebuffers(1, &m_ResolveID);
+        StateManager::OnFramebufferDeleted(m_RendererID);
+        StateManager::OnFramebufferDeleted(m_ResolveID);
+        glDeleteTextures(FramebufferSpecification::MaxColorAttachments, m_ColorTextures);
+        for (uint32_t texture : m_ColorTextures)
+            if (texture) StateManager::OnTextureDeleted(texture);
+        glDeleteRenderbuffers(FramebufferSpecification::MaxColorAttachments, m_ColorRenderbuffers);
+        if (m_DepthTexture) {
+            glDeleteTextures(1, &m_DepthTexture);
+            StateManager::OnTextureDeleted(m_DepthTexture);
+        }
+        if (m_DepthRenderbuffer) glDeleteRenderbuffers(1, &m_DepthRenderbuffer);
+        m_RendererID = m_ResolveID = m_DepthTexture = m_DepthRenderbuffer = 0;
+        std::fill(std::begin(m_ColorTextures), std::end(m_ColorTextures), 0u);
+        std::fill(std::begin(m_ColorRenderbuffers), std::end(m_ColorRenderbuffers), 0u);
     }
-    
+
+    FramebufferSpecification m_Specification;
     uint32_t m_RendererID = 0;
-    uint32_t m_ColorAttachment = 0;
-    uint32_t m_DepthAttachment = 0;
-    uint32_t m_Width, m_Height;
+    uint32_t m_ResolveID = 0;       // Only when multisampled
+    uint32_t m_ColorTextures[FramebufferSpecification::MaxColorAttachments]{};
+    uint32_t m_ColorRenderbuffers[FramebufferSpecification::MaxColorAttachments]{};
+    uint32_t m_DepthTexture = 0;
+    uint32_t m_DepthRenderbuffer = 0;
+    uint32_t m_AllocatedWidth = 0;
+    uint32_t m_AllocatedHeight = 0;
 };
 
-std::shared_ptr<Framebuffer> Framebuffer::Create(uint32_t width, uint32_t height) {
-    return std::make_shared<OpenGLFramebuffer>(width, height);
+std::shared_ptr<Framebuffer> Framebuffer::Create(const FramebufferSpecification& specification) {
+    return std::make_shared<OpenGLFramebuffer>(specification);
+}
+
+std::shared_ptr<Framebuffer> Framebuffer::Create(uint32_t width, uint32_t height, FramebufferFormat format) {
+    FramebufferSpecification specification;
+    specification.width = width;
+    specification.height = height;
+    specification.colorAttachments[0] = format;
+    return Create(specification);
 }
 
 } // namespace Kosmic::Renderer
@@ -0,0 +1,408 @@
+#include "Kosmic/Renderer/GPUCulling.hpp"
+#include "Kosmic/Renderer/Shader.hpp"
+#include "Kosmic/Renderer/StateManager.hpp"
+#include "Kosmic/Renderer/RenderStats.hpp"
+#include "Kosmic/Renderer/UniformBuffer.hpp"
+#include "Kosmic/Assets/Material.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include "Kosmic/Core/Profiler.hpp"
+#include <GL/glew.h>
+#include <algorithm>
+#include <bit>
+#include <numeric>
+
+namespace Kosmic::Renderer {
+
+namespace {
+
+// Storage buffer bindings of cull.comp and culled.vert
+namespace StorageBinding {
+    constexpr GLuint Instances = 0;
+    constexpr GLuint Batches   = 1;
+    constexpr GLuint Commands  = 2;
+    constexpr GLuint Visible   = 3;
+    constexpr GLuint Counters  = 4;
+}
+
+// culled.vert's instance index
+constexpr GLuint InstanceAttribute = 10;
+
+constexpr uint32_t CullGroupSize = 64;
+constexpr uint32_t PyramidGroupSize = 8;
+// GL only promises this many groups per dimension
+constexpr uint32_t MaxGroups = 65535;
+constexpr uint32_t CounterCount = 4;
+
+uint32_t GetTextureID(const Assets::Material* material) {
+    return material && material->diffuseMap ? material->diffuseMap->GetID() : 0;
+}
+
+} // namespace
+
+GPUCulling::~GPUCulling() {
+    GLuint buffers[] = {m_InstanceBuffer, m_BatchBuffer, m_CommandBuffer, m_VisibleBuffer, m_CounterBuffer};
+    for (GLuint buffer : buffers)
+        if (buffer) glDeleteBuffers(1, &buffer);
+    for (Readback& readback : m_Readbacks) {
+        if (readback.fence) glDeleteSync(static_cast<GLsync>(readback.fence));
+        if (readback.buffer) glDeleteBuffers(1, &readback.buffer);
+    }
+    for (GLuint texture : {m_DepthTexture, m_PyramidTexture}) {
+        if (!texture) continue;
+        glDeleteTextures(1, &texture);
+        StateManager::OnTextureDeleted(texture);
+    }
+    if (m_DepthFramebuffer) {
+        glDeleteFramebuffers(1, &m_DepthFramebuffer);
+        StateManager::OnFramebufferDeleted(m_DepthFramebuffer);
+    }
+}
+
+bool GPUCulling::IsSupported() {
+    if (!GLEW_VERSION_4_3) return false;
+    // 4.3 only requires storage buffers in compute and fragment shaders
+    GLint vertexBlocks = 0;
+    glGetIntegerv(GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS, &vertexBlocks);
+    return vertexBlocks > 0;
+}
+
+void GPUCulling::Submit(Mesh& mesh, const Assets::Material* material, const InstanceData* instances,
+                        uint32_t count) {
+    if (count == 0) return;
+    m_Batches.push_back({&mesh, material, instances, count});
+}
+
+void GPUCulling::CreateResources() {
+    m_CullShader = Shader::CreateCullShader();
+    m_PyramidShader = Shader::CreateDepthPyramidShader();
+    m_DrawShader = Shader::CreateCulledInstanceShader();
+
+    GLuint buffers[5];
+    glGenBuffers(5, buffers);
+    m_InstanceBuffer = buffers[0];
+    m_BatchBuffer = buffers[1];
+    m_CommandBuffer = buffers[2];
+    m_VisibleBuffer = buffers[3];
+    m_CounterBuffer = buffers[4];
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_CounterBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, CounterCount * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+
+    for (Readback& readback : m_Readbacks) {
+        glGenBuffers(1, &readback.buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, readback.buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, CounterCount * sizeof(uint32_t), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GPUCulling::Reserve(uint32_t target, uint32_t buffer, size_t bytes, size_t& capacity) {
+    glBindBuffer(target, buffer);
+    if (bytes > capacity) capacity = std::max(bytes, capacity + capacity / 2);
+    // Orphaned every frame, so last frame's draws never have to be waited on
+    glBufferData(target, static_cast<GLsizeiptr>(capacity), nullptr, GL_STREAM_DRAW);
+}
+
+void GPUCulling::CollectReadbacks() {
+    for (Readback& readback : m_Readbacks) {
+        if (!readback.fence) continue;
+        GLsync fence = static_cast<GLsync>(readback.fence);
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) continue;
+
+        glDeleteSync(fence);
+        readback.fence = nullptr;
+        // Slots can finish out of order with a skipped frame, keep the newest
+        if (readback.frame <= m_ReadFrame) continue;
+
+        uint32_t counters[CounterCount];
+        glBindBuffer(GL_COPY_READ_BUFFER, readback.buffer);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(counters), counters);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+        m_ReadFrame = readback.frame;
+        m_Stats.tested = counters[0];
+        m_Stats.frustumCulled = counters[1];
+        m_Stats.occluded = counters[2];
+        m_Stats.visible = counters[0] - counters[1] - counters[2];
+        m_Stats.latency = m_Frame - readback.frame;
+    }
+}
+
+void GPUCulling::Cull(const Math::Frustum& frustum) {
+    KOSMIC_PROFILE_SCOPE("GPUCulling::Cull");
+    if (m_Batches.empty()) return;
+    if (!m_CullShader) CreateResources();
+    m_Frame++;
+    CollectReadbacks();
+
+    // Batches stay in submission order for the shader's search by instance
+    uint32_t batchCount = static_cast<uint32_t>(m_Batches.size());
+    m_BatchData.clear();
+    m_InstanceCount = 0;
+    for (const Batch& batch : m_Batches) {
+        const Math::BoundingSphere& sphere = batch.mesh->GetBoundingSphere();
+        m_BatchData.push_back({Math::Vector4(sphere.center.x, sphere.center.y, sphere.center.z, sphere.radius),
+                               m_InstanceCount, batch.count, 0, 0});
+        m_InstanceCount += batch.count;
+    }
+
+    // Commands go in VAO and material order, so runs of them share state
+    m_DrawOrder.resize(batchCount);
+    std::iota(m_DrawOrder.begin(), m_DrawOrder.end(), 0u);
+    std::stable_sort(m_DrawOrder.begin(), m_DrawOrder.end(), [this](uint32_t a, uint32_t b) {
+        const Batch& left = m_Batches[a];
+        const Batch& right = m_Batches[b];
+        if (left.mesh->GetVAO() != right.mesh->GetVAO()) return left.mesh->GetVAO() < right.mesh->GetVAO();
+        return left.material < right.material;
+    });
+    m_Commands.clear();
+    for (uint32_t command = 0; command < batchCount; ++command) {
+        BatchData& data = m_BatchData[m_DrawOrder[command]];
+        const Mesh& mesh = *m_Batches[m_DrawOrder[command]].mesh;
+        data.command = command;
+        m_Commands.push_back({mesh.GetIndexCount(), 0, mesh.GetFirstIndex(),
+                              static_cast<int32_t>(mesh.GetBaseVertex()), data.first});
+    }
+
+    // Instances straight from the submitters' arrays, one batch at a time
+    size_t instanceBytes = size_t(m_InstanceCount) * sizeof(InstanceData);
+    Reserve(GL_SHADER_STORAGE_BUFFER, m_InstanceBuffer, instanceBytes, m_InstanceCapacity);
+    for (uint32_t b = 0; b < batchCount; ++b)
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, size_t(m_BatchData[b].first) * sizeof(InstanceData),
+                        size_t(m_Batches[b].count) * sizeof(InstanceData), m_Batches[b].instances);
+    Reserve(GL_SHADER_STORAGE_BUFFER, m_BatchBuffer, m_BatchData.size() * sizeof(BatchData), m_BatchCapacity);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_BatchData.size() * sizeof(BatchData), m_BatchData.data());
+    Reserve(GL_SHADER_STORAGE_BUFFER, m_CommandBuffer, m_Commands.size() * sizeof(DrawCommand), m_CommandCapacity);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_Commands.size() * sizeof(DrawCommand), m_Commands.data());
+    Reserve(GL_SHADER_STORAGE_BUFFER, m_VisibleBuffer, size_t(m_InstanceCount) * sizeof(uint32_t), m_VisibleCapacity);
+    const uint32_t zeros[CounterCount] = {};
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_CounterBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(zeros), zeros);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    RenderStatistics::GetCurrent().bufferBytes +=
+        instanceBytes + m_BatchData.size() * sizeof(BatchData) + m_Commands.size() * sizeof(DrawCommand);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, StorageBinding::Instances, m_InstanceBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, StorageBinding::Batches, m_BatchBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, StorageBinding::Commands, m_CommandBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, StorageBinding::Visible, m_VisibleBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, StorageBinding::Counters, m_CounterBuffer);
+
+    Shader& shader = *m_CullShader;
+    shader.Bind();
+    shader.SetInt("u_InstanceCount", static_cast<int>(m_InstanceCount));
+    shader.SetInt("u_BatchCount", static_cast<int>(batchCount));
+    glUniform4fv(shader.GetUniformLocation("u_Planes"), Math::Frustum::Count, &frustum.planes[0].x);
+    RenderStatistics::GetCurrent().uniformUploads++;
+    shader.SetInt("u_PyramidLevels", m_HasPyramid ? static_cast<int>(m_PyramidLevels) : 0);
+    if (m_HasPyramid) {
+        shader.SetMat4("u_PyramidViewProjection", m_PyramidViewProjection);
+        StateManager::BindTexture(TextureUnit::DepthPyramid, m_PyramidTexture);
+    }
+
+    // Two dimensions past the per-dimension group limit; the shader flattens them
+    uint32_t groups = (m_InstanceCount + CullGroupSize - 1) / CullGroupSize;
+    uint32_t groupsX = std::min(groups, MaxGroups);
+    glDispatchCompute(groupsX, (groups + groupsX - 1) / groupsX, 1);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    // Counters go to a readback slot; if it's still in flight this frame's are skipped
+    Readback& readback = m_Readbacks[m_Frame % ReadbackSlots];
+    if (!readback.fence) {
+        glBindBuffer(GL_COPY_READ_BUFFER, m_CounterBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, readback.buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, CounterCount * sizeof(uint32_t));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        readback.frame = m_Frame;
+    }
+
+    m_Stats.batches = batchCount;
+    m_Stats.instances = m_InstanceCount;
+}
+
+void GPUCulling::Draw() {
+    KOSMIC_PROFILE_SCOPE("GPUCulling::Draw");
+    if (m_Batches.empty() || !m_DrawShader) return;
+
+    Shader& shader = *m_DrawShader;
+    shader.Bind();
+    shader.SetInt("u_Texture", 0);
+    GLint colorLocation = shader.GetUniformLocation("u_Color");
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, StorageBinding::Instances, m_InstanceBuffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBuffer);
+
+    uint32_t drawCalls = 0;
+    uint32_t commandCount = static_cast<uint32_t>(m_DrawOrder.size());
+    for (uint32_t first = 0; first < commandCount;) {
+        const Batch& batch = m_Batches[m_DrawOrder[first]];
+        uint32_t end = first + 1;
+        while (end < commandCount && m_Batches[m_DrawOrder[end]].mesh->GetVAO() == batch.mesh->GetVAO() &&
+               m_Batches[m_DrawOrder[end]].material == batch.material)
+            end++;
+
+        const Assets::Material* material = batch.material;
+        if (material)
+            shader.SetVec4(colorLocation, Math::Vector4(material->diffuse.x, material->diffuse.y, material->diffuse.z,
+                                                        material->opacity));
+        else
+            shader.SetVec4(colorLocation, Math::Vector4(1.0f, 1.0f, 1.0f, 1.0f));
+        StateManager::BindTexture(0, GetTextureID(material));
+
+        // The instance index attribute only exists for these draws, the VAO
+        // belongs to the mesh
+        batch.mesh->Bind();
+        glBindBuffer(GL_ARRAY_BUFFER, m_VisibleBuffer);
+        glVertexAttribIPointer(InstanceAttribute, 1, GL_UNSIGNED_INT, 0, nullptr);
+        glVertexAttribDivisor(InstanceAttribute, 1);
+        glEnableVertexAttribArray(InstanceAttribute);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glMultiDrawElementsIndirect(GL_TRIANGLES, batch.mesh->GetGLIndexType(),
+                                    (void*)(size_t(first) * sizeof(DrawCommand)), static_cast<GLsizei>(end - first), 0);
+        glDisableVertexAttribArray(InstanceAttribute);
+        drawCalls++;
+        first = end;
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    // Triangles and instances drawn are only known on the GPU
+    RenderStats& stats = RenderStatistics::GetCurrent();
+    stats.drawCalls += drawCalls;
+    stats.gpuCullTested += m_Stats.tested;
+    stats.gpuCullVisible += m_Stats.visible;
+}
+
+uint32_t GPUCulling::GetDepthFormat(uint32_t framebuffer) {
+    // The window's buffers are named differently from a framebuffer object's
+    GLenum depth = framebuffer ? GL_DEPTH_ATTACHMENT : GL_DEPTH;
+    GLenum stencil = framebuffer ? GL_STENCIL_ATTACHMENT : GL_STENCIL;
+
+    GLint type = GL_NONE;
+    glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, depth, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type);
+    if (type == GL_NONE) return 0;
+    GLint depthBits = 0, componentType = 0, stencilBits = 0;
+    glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, depth, GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE, &depthBits);
+    glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, depth, GL_FRAMEBUFFER_ATTACHMENT_COMPONENT_TYPE,
+                                          &componentType);
+    glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, stencil, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type);
+    if (type != GL_NONE)
+        glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, stencil, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE,
+                                              &stencilBits);
+
+    if (depthBits == 0) return 0;
+    if (componentType == GL_FLOAT) return stencilBits ? GL_DEPTH32F_STENCIL8 : GL_DEPTH_COMPONENT32F;
+    if (depthBits >= 24) return stencilBits ? GL_DEPTH24_STENCIL8 : GL_DEPTH_COMPONENT24;
+    return GL_DEPTH_COMPONENT16;
+}
+
+void GPUCulling::ResizeDepthPyramid(uint32_t format, uint32_t width, uint32_t height) {
+    for (GLuint* texture : {&m_DepthTexture, &m_PyramidTexture}) {
+        if (!*texture) continue;
+        glDeleteTextures(1, texture);
+        StateManager::OnTextureDeleted(*texture);
+        *texture = 0;
+    }
+    m_DepthFormat = format;
+    m_Width = width;
+    m_Height = height;
+    m_HasPyramid = false;
+
+    // Blits need the same depth format on both sides
+    glGenTextures(1, &m_DepthTexture);
+    StateManager::BindTexture(TextureUnit::DepthPyramid, m_DepthTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, format, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // Powers of two, so every level halves the one below exactly
+    uint32_t pyramidWidth = std::bit_floor(std::max(width / 2, 1u));
+    uint32_t pyramidHeight = std::bit_floor(std::max(height / 2, 1u));
+    m_PyramidLevels = std::bit_width(std::max(pyramidWidth, pyramidHeight));
+    glGenTextures(1, &m_PyramidTexture);
+    StateManager::BindTexture(TextureUnit::DepthPyramid, m_PyramidTexture);
+    glTexStorage2D(GL_TEXTURE_2D, static_cast<GLsizei>(m_PyramidLevels), GL_R32F,
+                   static_cast<GLsizei>(pyramidWidth), static_cast<GLsizei>(pyramidHeight));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    if (!m_DepthFramebuffer) glGenFramebuffers(1, &m_DepthFramebuffer);
+    bool stencil = format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8;
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_DepthFramebuffer);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+                           GL_TEXTURE_2D, m_DepthTexture, 0);
+    glDrawBuffer(GL_NONE);
+}
+
+void GPUCulling::UpdateDepthPyramid(const Math::Mat4& viewProjection) {
+    KOSMIC_PROFILE_SCOPE("GPUCulling::UpdateDepthPyramid");
+    if (m_PyramidFailed || !m_PyramidShader) return;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    uint32_t width = static_cast<uint32_t>(std::max(viewport[2], 1));
+    uint32_t height = static_cast<uint32_t>(std::max(viewport[3], 1));
+
+    // StateManager binds read and draw together, so the read side is the scene's
+    uint32_t source = StateManager::GetFramebuffer();
+    uint32_t format = m_DepthFormat;
+    if (source != m_SourceFramebuffer) {
+        format = GetDepthFormat(source);
+        m_SourceFramebuffer = source;
+        if (!format) {
+            KOSMIC_WARN("GPU culling: the scene has no depth buffer, occlusion culling is off");
+            m_PyramidFailed = true;
+            return;
+        }
+    }
+
+    bool created = format != m_DepthFormat || width != m_Width || height != m_Height;
+    if (created) {
+        // Checked after the first blit into them, start from a clean slate
+        while (glGetError() != GL_NO_ERROR) {}
+        ResizeDepthPyramid(format, width, height);
+    } else {
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_DepthFramebuffer);
+    }
+    glBlitFramebuffer(viewport[0], viewport[1], viewport[0] + viewport[2], viewport[1] + viewport[3], 0, 0,
+                      static_cast<GLint>(width), static_cast<GLint>(height), GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, source);
+    if (created && glGetError() != GL_NO_ERROR) {
+        // Multisampled sources of another size, mostly
+        KOSMIC_WARN("GPU culling: could not copy the scene's depth buffer, occlusion culling is off");
+        m_PyramidFailed = true;
+        return;
+    }
+
+    // Level 0 from the copy, then each level from the one below
+    Shader& shader = *m_PyramidShader;
+    shader.Bind();
+    GLint sourceLevelLocation = shader.GetUniformLocation("u_SourceLevel");
+    StateManager::BindTexture(TextureUnit::DepthPyramid, m_DepthTexture);
+    uint32_t pyramidWidth = std::bit_floor(std::max(width / 2, 1u));
+    uint32_t pyramidHeight = std::bit_floor(std::max(height / 2, 1u));
+    for (uint32_t level = 0; level < m_PyramidLevels; ++level) {
+        if (level == 1) StateManager::BindTexture(TextureUnit::DepthPyramid, m_PyramidTexture);
+        if (level > 0) glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+        shader.SetInt(sourceLevelLocation, level == 0 ? 0 : static_cast<int>(level - 1));
+        glBindImageTexture(0, m_PyramidTexture, static_cast<GLint>(level), GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+        uint32_t levelWidth = std::max(pyramidWidth >> level, 1u);
+        uint32_t levelHeight = std::max(pyramidHeight >> level, 1u);
+        glDispatchCompute((levelWidth + PyramidGroupSize - 1) / PyramidGroupSize,
+                          (levelHeight + PyramidGroupSize - 1) / PyramidGroupSize, 1);
+    }
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    m_PyramidViewProjection = viewProjection;
+    m_HasPyramid = true;
+}
+
+void GPUCulling::Clear() {
+    m_Batches.clear();
+}
+
+} // namespace Kosmic::Renderer
@@ -0,0 +1,202 @@
+#include "Kosmic/Renderer/GPUProfiler.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include <GL/glew.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace Kosmic::Renderer {
+
+namespace {
+
+constexpr uint32_t NoQuery = UINT32_MAX;
+
+// Scope names are copied in when recorded, without allocating; longer ones are cut
+constexpr size_t MaxScopeName = 48;
+
+struct ScopeRecord {
+    char name[MaxScopeName];
+    uint32_t depth;
+    uint32_t beginQuery;
+    uint32_t endQuery;
+};
+
+struct FrameSlot {
+    std::array<GLuint, GPUProfiler::MaxScopesPerFrame * 2> queries{};
+    std::vector<ScopeRecord> scopes; // Scope 0 is the whole frame
+    uint32_t queryCount = 0;
+    uint64_t frameIndex = 0;
+    bool pending = false;
+};
+
+struct ProfilerState {
+    std::array<FrameSlot, GPUProfiler::FramesInFlight> slots;
+    std::vector<uint32_t> scopeStack; // Indices into the recording slot's scopes
+    uint32_t openScopes = 0;          // Recorded scopes still waiting for their end query
+    FrameSlot* recording = nullptr;
+    uint64_t frameCounter = 0;
+    uint64_t droppedFrames = 0;
+    bool initialized = false;
+    GPUFrameTimings latest;
+    std::function<void(const GPUFrameTimings&)> callback;
+};
+
+ProfilerState s_State;
+
+// Reads a slot back; without wait it gives up if the GPU has not finished it yet
+bool ResolveSlot(FrameSlot& slot, bool wait) {
+    if (!slot.pending) return true;
+
+    // Timestamps complete in order, the frame's closing query is the last one written
+    GLuint last = slot.queries[slot.scopes[0].endQuery];
+    if (!wait) {
+        GLint available = 0;
+        glGetQueryObjectiv(last, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return false;
+    }
+
+    std::array<GLuint64, GPUProfiler::MaxScopesPerFrame * 2> stamps{};
+    for (uint32_t i = 0; i < slot.queryCount; ++i)
+        glGetQueryObjectui64v(slot.queries[i], GL_QUERY_RESULT, &stamps[i]);
+
+    GPUFrameTimings& result = s_State.latest;
+    result.frameIndex = slot.frameIndex;
+    result.scopes.clear();
+    for (const ScopeRecord& scope : slot.scopes) {
+        if (scope.endQuery == NoQuery) continue; // Never closed
+        uint64_t begin = stamps[scope.beginQuery];
+        uint64_t end = stamps[scope.endQuery];
+        result.scopes.push_back({scope.name, scope.depth, end > begin ? end - begin : 0});
+    }
+    result.frameTime = result.scopes.empty() ? 0 : result.scopes.front().time;
+
+    slot.pending = false;
+    if (s_State.callback)
+        s_State.callback(result);
+    return true;
+}
+
+// Resolves pending slots oldest first, stopping at the first one still in flight
+void ResolvePending(bool wait) {
+    std::array<FrameSlot*, GPUProfiler::FramesInFlight> pending{};
+    size_t count = 0;
+    for (FrameSlot& slot : s_State.slots)
+        if (slot.pending) pending[count++] = &slot;
+
+    std::sort(pending.begin(), pending.begin() + count,
+              [](const FrameSlot* a, const FrameSlot* b) { return a->frameIndex < b->frameIndex; });
+
+    for (size_t i = 0; i < count; ++i)
+        if (!ResolveSlot(*pending[i], wait)) break;
+}
+
+} // namespace
+
+void GPUProfiler::Init() {
+    if (s_State.initialized) return;
+    for (FrameSlot& slot : s_State.slots) {
+        glGenQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+        slot.scopes.reserve(MaxScopesPerFrame);
+    }
+    s_State.scopeStack.reserve(MaxScopesPerFrame);
+    s_State.initialized = true;
+}
+
+void GPUProfiler::Shutdown() {
+    if (!s_State.initialized) return;
+    for (FrameSlot& slot : s_State.slots) {
+        glDeleteQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+        slot = FrameSlot{};
+    }
+    s_State.recording = nullptr;
+    s_State.scopeStack.clear();
+    s_State.initialized = false;
+}
+
+uint64_t GPUProfiler::BeginFrame() {
+    uint64_t frameIndex = s_State.frameCounter++;
+    if (!s_State.initialized) return frameIndex;
+
+    ResolvePending(false);
+
+    FrameSlot& slot = s_State.slots[frameIndex % FramesInFlight];
+    if (slot.pending) {
+        // Waiting here would stall the pipeline; skip timing this frame instead
+        if (s_State.droppedFrames++ == 0)
+            KOSMIC_WARN("GPUProfiler: GPU is more than {} frames behind, dropping timings", FramesInFlight);
+        return frameIndex;
+    }
+
+    slot.frameIndex = frameIndex;
+    slot.queryCount = 0;
+    slot.scopes.clear();
+    s_State.recording = &slot;
+    s_State.scopeStack.clear();
+    s_State.openScopes = 0;
+    BeginScope("Frame");
+    return frameIndex;
+}
+
+void GPUProfiler::EndFrame() {
+    if (!s_State.recording) return;
+
+    if (s_State.scopeStack.size() > 1)
+        KOSMIC_WARN("GPUProfiler: {} scope(s) left open at end of frame", s_State.scopeStack.size() - 1);
+    while (!s_State.scopeStack.empty())
+        EndScope();
+
+    s_State.recording->pending = true;
+    s_State.recording = nullptr;
+}
+
+void GPUProfiler::BeginScope(const char* name) {
+    FrameSlot* slot = s_State.recording;
+    // Open scopes have their end query reserved, so the frame can always be closed
+    if (!slot || slot->queryCount + s_State.openScopes + 2 > slot->queries.size()) {
+        // Keep Begin/End balanced even when the scope is not recorded
+        s_State.scopeStack.push_back(NoQuery);
+        return;
+    }
+
+    uint32_t beginQuery = slot->queryCount++;
+    glQueryCounter(slot->queries[beginQuery], GL_TIMESTAMP);
+    ++s_State.openScopes;
+
+    uint32_t depth = static_cast<uint32_t>(s_State.scopeStack.size());
+    s_State.scopeStack.push_back(static_cast<uint32_t>(slot->scopes.size()));
+    ScopeRecord& record = slot->scopes.emplace_back();
+    std::strncpy(record.name, name, MaxScopeName - 1);
+    record.name[MaxScopeName - 1] = '\0';
+    record.depth = depth;
+    record.beginQuery = beginQuery;
+    record.endQuery = NoQuery;
+}
+
+void GPUProfiler::EndScope() {
+    if (s_State.scopeStack.empty()) return;
+    uint32_t scopeIndex = s_State.scopeStack.back();
+    s_State.scopeStack.pop_back();
+
+    FrameSlot* slot = s_State.recording;
+    if (!slot || scopeIndex == NoQuery) return;
+
+    --s_State.openScopes;
+    uint32_t endQuery = slot->queryCount++;
+    glQueryCounter(slot->queries[endQuery], GL_TIMESTAMP);
+    slot->scopes[scopeIndex].endQuery = endQuery;
+}
+
+const GPUFrameTimings& GPUProfiler::GetLatest() {
+    return s_State.latest;
+}
+
+void GPUProfiler::SetResolveCallback(std::function<void(const GPUFrameTimings&)> callback) {
+    s_State.callback = std::move(callback);
+}
+
+void GPUProfiler::Flush() {
+    if (!s_State.initialized) return;
+    ResolvePending(true);
+}
+
+} // namespace Kosmic::Renderer
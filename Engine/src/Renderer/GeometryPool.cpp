@@ -0,0 +1,245 @@
+#include "Kosmic/Renderer/GeometryPool.hpp"
+#include "Kosmic/Renderer/Mesh.hpp"
+#include "Kosmic/Renderer/StateManager.hpp"
+#include "Kosmic/Renderer/RenderStats.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include <GL/glew.h>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+namespace Kosmic::Renderer {
+
+namespace {
+
+// First fit over a free list sorted by offset; neighbours merge when freed
+class RangeAllocator {
+public:
+    explicit RangeAllocator(uint32_t size) : m_Size(size) { m_Free.emplace(0, size); }
+
+    bool Allocate(uint32_t size, uint32_t& offset) {
+        for (auto it = m_Free.begin(); it != m_Free.end(); ++it) {
+            if (it->second < size) continue;
+            offset = it->first;
+            uint32_t remaining = it->second - size;
+            m_Free.erase(it);
+            if (remaining) m_Free.emplace(offset + size, remaining);
+            m_Used += size;
+            return true;
+        }
+        return false;
+    }
+
+    void Free(uint32_t offset, uint32_t size) {
+        m_Used -= size;
+        auto next = m_Free.lower_bound(offset);
+        if (next != m_Free.begin()) {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == offset) {
+                offset = previous->first;
+                size += previous->second;
+                m_Free.erase(previous);
+            }
+        }
+        if (next != m_Free.end() && offset + size == next->first) {
+            size += next->second;
+            m_Free.erase(next);
+        }
+        m_Free.emplace(offset, size);
+    }
+
+    uint32_t GetSize() const { return m_Size; }
+    uint32_t GetUsed() const { return m_Used; }
+
+private:
+    std::map<uint32_t, uint32_t> m_Free; // Offset -> size
+    uint32_t m_Size;
+    uint32_t m_Used{0};
+};
+
+struct Page {
+    VertexLayout layout;
+    IndexType indexType;
+    RangeAllocator vertices;
+    RangeAllocator indices;
+    GLuint vao{0};
+    GLuint vertexBuffer{0};
+    GLuint indexBuffer{0};
+    GLuint instanceBuffer{0};
+    uint32_t allocations{0};
+
+    Page(const VertexLayout& layout, IndexType indexType)
+        : layout(layout), indexType(indexType),
+          vertices(static_cast<uint32_t>(GeometryPool::VertexPageSize / layout.stride)),
+          indices(static_cast<uint32_t>(GeometryPool::IndexPageSize / static_cast<uint32_t>(indexType))) {}
+};
+
+struct PoolState {
+    std::vector<std::unique_ptr<Page>> pages;
+    GLuint drawIDBuffer{0}; // 0, 1, 2, ... read with divisor 1, shared by every page
+    bool enabled{true};
+    bool multiDrawIndirect{true};
+};
+
+PoolState s_State;
+
+GLuint GetDrawIDBuffer() {
+    if (!s_State.drawIDBuffer) {
+        std::vector<uint32_t> ids(GeometryPool::MaxDrawIDs);
+        std::iota(ids.begin(), ids.end(), 0u);
+        glGenBuffers(1, &s_State.drawIDBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, s_State.drawIDBuffer);
+        glBufferData(GL_ARRAY_BUFFER, ids.size() * sizeof(uint32_t), ids.data(), GL_STATIC_DRAW);
+    }
+    return s_State.drawIDBuffer;
+}
+
+Page& CreatePage(const VertexLayout& layout, IndexType indexType) {
+    auto page = std::make_unique<Page>(layout, indexType);
+    glGenVertexArrays(1, &page->vao);
+    glGenBuffers(1, &page->vertexBuffer);
+    glGenBuffers(1, &page->indexBuffer);
+    glGenBuffers(1, &page->instanceBuffer);
+
+    StateManager::BindVertexArray(page->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, page->vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, size_t(page->vertices.GetSize()) * layout.stride, nullptr, GL_STATIC_DRAW);
+    layout.Apply();
+    StateManager::SetConstantColor(page->vao, !layout.Has(VertexAttribute::Color));
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, page->indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, size_t(page->indices.GetSize()) * static_cast<uint32_t>(indexType),
+                 nullptr, GL_STATIC_DRAW);
+
+    // Filled by Mesh::SetInstanceData right before each instanced draw
+    glBindBuffer(GL_ARRAY_BUFFER, page->instanceBuffer);
+    ApplyInstanceAttributes();
+
+    // Draw ID -> layout(location = 9), the base instance picks the entry
+    glBindBuffer(GL_ARRAY_BUFFER, GetDrawIDBuffer());
+    glEnableVertexAttribArray(9);
+    glVertexAttribIPointer(9, 1, GL_UNSIGNED_INT, sizeof(uint32_t), nullptr);
+    glVertexAttribDivisor(9, 1);
+
+    StateManager::BindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    KOSMIC_INFO("Geometry pool: page {} for {} byte vertices, {} bit indices", s_State.pages.size(), layout.stride,
+                static_cast<uint32_t>(indexType) * 8);
+    s_State.pages.push_back(std::move(page));
+    return *s_State.pages.back();
+}
+
+bool TryAllocate(Page& page, uint32_t vertexCount, uint32_t indexCount, GeometryAllocation& allocation) {
+    if (!page.vertices.Allocate(vertexCount, allocation.baseVertex)) return false;
+    if (!page.indices.Allocate(indexCount, allocation.firstIndex)) {
+        page.vertices.Free(allocation.baseVertex, vertexCount);
+        return false;
+    }
+    page.allocations++;
+    return true;
+}
+
+} // namespace
+
+void GeometryPool::SetEnabled(bool enabled) {
+    s_State.enabled = enabled;
+}
+
+bool GeometryPool::IsEnabled() {
+    return s_State.enabled;
+}
+
+void GeometryPool::SetMultiDrawIndirect(bool enabled) {
+    s_State.multiDrawIndirect = enabled;
+}
+
+bool GeometryPool::UseMultiDrawIndirect() {
+    // Non-zero base instances are what carry the draw IDs
+    return s_State.multiDrawIndirect &&
+           (GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance));
+}
+
+GeometryAllocation GeometryPool::Allocate(const VertexLayout& layout, IndexType indexType, const void* vertices,
+                                          uint32_t vertexCount, const void* indices, uint32_t indexCount) {
+    GeometryAllocation allocation;
+    uint32_t indexSize = static_cast<uint32_t>(indexType);
+    if (!s_State.enabled || vertexCount == 0 || indexCount == 0 || !layout.IsValid() ||
+        size_t(vertexCount) * layout.stride > VertexPageSize || size_t(indexCount) * indexSize > IndexPageSize)
+        return allocation;
+
+    Page* target = nullptr;
+    for (uint32_t i = 0; i < s_State.pages.size() && !target; ++i) {
+        Page& page = *s_State.pages[i];
+        if (page.layout == layout && page.indexType == indexType &&
+            TryAllocate(page, vertexCount, indexCount, allocation)) {
+            allocation.page = i;
+            target = &page;
+        }
+    }
+    if (!target) {
+        target = &CreatePage(layout, indexType);
+        TryAllocate(*target, vertexCount, indexCount, allocation);
+        allocation.page = static_cast<uint32_t>(s_State.pages.size() - 1);
+    }
+    allocation.vertexCount = vertexCount;
+    allocation.indexCount = indexCount;
+
+    // Copy targets, so no VAO's element binding gets touched
+    glBindBuffer(GL_COPY_WRITE_BUFFER, target->vertexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, size_t(allocation.baseVertex) * layout.stride,
+                    size_t(vertexCount) * layout.stride, vertices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, target->indexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, size_t(allocation.firstIndex) * indexSize, size_t(indexCount) * indexSize,
+                    indices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    RenderStatistics::GetCurrent().bufferBytes += size_t(vertexCount) * layout.stride + size_t(indexCount) * indexSize;
+    return allocation;
+}
+
+void GeometryPool::Free(const GeometryAllocation& allocation) {
+    if (allocation.page >= s_State.pages.size()) return;
+    // Pages stay around once created, the next mesh of the same kind reuses the space
+    Page& page = *s_State.pages[allocation.page];
+    page.vertices.Free(allocation.baseVertex, allocation.vertexCount);
+    page.indices.Free(allocation.firstIndex, allocation.indexCount);
+    page.allocations--;
+}
+
+uint32_t GeometryPool::GetVAO(uint32_t page) {
+    return page < s_State.pages.size() ? s_State.pages[page]->vao : 0;
+}
+
+uint32_t GeometryPool::GetInstanceBuffer(uint32_t page) {
+    return page < s_State.pages.size() ? s_State.pages[page]->instanceBuffer : 0;
+}
+
+GeometryPoolStats GeometryPool::GetStats() {
+    GeometryPoolStats stats;
+    stats.pages = static_cast<uint32_t>(s_State.pages.size());
+    for (const auto& page : s_State.pages) {
+        uint32_t indexSize = static_cast<uint32_t>(page->indexType);
+        stats.allocations += page->allocations;
+        stats.usedBytes += size_t(page->vertices.GetUsed()) * page->layout.stride +
+                           size_t(page->indices.GetUsed()) * indexSize;
+        stats.capacityBytes += size_t(page->vertices.GetSize()) * page->layout.stride +
+                               size_t(page->indices.GetSize()) * indexSize;
+    }
+    return stats;
+}
+
+void GeometryPool::Shutdown() {
+    for (const auto& page : s_State.pages) {
+        glDeleteVertexArrays(1, &page->vao);
+        StateManager::OnVertexArrayDeleted(page->vao);
+        GLuint buffers[] = {page->vertexBuffer, page->indexBuffer, page->instanceBuffer};
+        glDeleteBuffers(3, buffers);
+    }
+    if (s_State.drawIDBuffer) glDeleteBuffers(1, &s_State.drawIDBuffer);
+    s_State.pages.clear();
+    s_State.drawIDBuffer = 0;
+}
+
+} // namespace Kosmic::Renderer
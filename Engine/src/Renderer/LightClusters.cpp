@@ -0,0 +1,286 @@
+#include "Kosmic/Renderer/LightClusters.hpp"
+#include "Kosmic/Renderer/Camera.hpp"
+#include "Kosmic/Renderer/StateManager.hpp"
+#include "Kosmic/Renderer/UniformBuffer.hpp"
+#include "Kosmic/Renderer/RenderStats.hpp"
+#include "Kosmic/Core/Jobs.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include "Kosmic/Core/Profiler.hpp"
+#include <GL/glew.h>
+#include <algorithm>
+#include <bit>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define KOSMIC_LIGHTS_SSE
+#endif
+
+namespace Kosmic::Renderer {
+
+namespace {
+
+constexpr uint32_t TileCount = LightClusters::TilesX * LightClusters::TilesY;
+constexpr uint32_t LightTexels = 3;
+
+// Orphans the old storage, like the render queue's draw data
+void Upload(uint32_t buffer, const void* data, size_t size) {
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    // An empty buffer can't back a texture everywhere, keep a few bytes
+    if (size > 0) glBufferData(GL_TEXTURE_BUFFER, size, data, GL_STREAM_DRAW);
+    else glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    RenderStatistics::GetCurrent().bufferBytes += size;
+}
+
+// NDC x or y to a tile, clamped to the grid
+uint8_t ToTile(float ndc, uint32_t tiles) {
+    float tile = (ndc + 1.0f) * 0.5f * static_cast<float>(tiles);
+    return static_cast<uint8_t>(std::clamp(tile, 0.0f, static_cast<float>(tiles - 1)));
+}
+
+} // namespace
+
+LightClusters::~LightClusters() {
+    for (uint32_t texture : {m_ClusterTexture, m_IndexTexture, m_LightTexture}) {
+        if (!texture) continue;
+        glDeleteTextures(1, &texture);
+        StateManager::OnTextureDeleted(texture);
+    }
+    for (uint32_t buffer : {m_ClusterBuffer, m_IndexBuffer, m_LightBuffer})
+        if (buffer) glDeleteBuffers(1, &buffer);
+}
+
+void LightClusters::AddPointLight(const Lighting::PointLight& light) {
+    if (m_Lights.size() >= MaxLights) return;
+    const Math::Vector3 color = light.color * light.intensity;
+    // Cutoffs that put every direction inside the cone
+    m_Lights.push_back({{light.position.x, light.position.y, light.position.z, light.range},
+                        {color.x, color.y, color.z, -1.0f},
+                        {0.0f, 0.0f, 0.0f, -2.0f}});
+}
+
+void LightClusters::AddSpotLight(const Lighting::SpotLight& light) {
+    if (m_Lights.size() >= MaxLights) return;
+    const Math::Vector3 color = light.color * light.intensity;
+    const Math::Vector3 direction = Math::Normalize(light.direction);
+    m_Lights.push_back({{light.position.x, light.position.y, light.position.z, light.range},
+                        {color.x, color.y, color.z, light.cutoff},
+                        {direction.x, direction.y, direction.z, light.outerCutoff}});
+}
+
+void LightClusters::Clear() {
+    m_Lights.clear();
+}
+
+void LightClusters::CreateBuffers() {
+    // 3.3 only promises 65536 texels, most drivers allow far more
+    GLint maxTexels = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+    m_MaxIndices = std::min(static_cast<uint32_t>(maxTexels), ClusterCount * MaxLightsPerCluster);
+    m_MaxLights = std::min(MaxLights, static_cast<uint32_t>(maxTexels) / LightTexels);
+
+    struct Target { uint32_t* buffer; uint32_t* texture; uint32_t unit; GLenum format; };
+    for (const Target& target : {Target{&m_ClusterBuffer, &m_ClusterTexture, TextureUnit::ClusterLights, GL_RG32UI},
+                                 Target{&m_IndexBuffer, &m_IndexTexture, TextureUnit::LightIndices, GL_R16UI},
+                                 Target{&m_LightBuffer, &m_LightTexture, TextureUnit::LightData, GL_RGBA32F}}) {
+        glGenBuffers(1, target.buffer);
+        glGenTextures(1, target.texture);
+        glBindBuffer(GL_TEXTURE_BUFFER, *target.buffer);
+        glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+        StateManager::BindTexture(target.unit, *target.texture, GL_TEXTURE_BUFFER);
+        glTexBuffer(GL_TEXTURE_BUFFER, target.format, *target.buffer);
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void LightClusters::Build(const Camera& camera, uint32_t width, uint32_t height) {
+    KOSMIC_PROFILE_SCOPE("LightClusters::Build");
+    if (!m_ClusterBuffer) CreateBuffers();
+
+    m_Stats = {};
+    m_Stats.lights = static_cast<uint32_t>(m_Lights.size());
+
+    // Exponential slices: slice = log(depth) * scale + bias. The outer ones
+    // reach past the planes, the shader clamps to them as well.
+    float nearPlane = std::max(camera.GetNearPlane(), 0.01f);
+    float farPlane = std::max(camera.GetFarPlane(), nearPlane * 2.0f);
+    float logRatio = std::log(farPlane / nearPlane);
+    m_ClusterScale = Math::Vector4(Slices / logRatio, -static_cast<float>(Slices) * std::log(nearPlane) / logRatio,
+                                   TilesX / static_cast<float>(std::max(width, 1u)),
+                                   TilesY / static_cast<float>(std::max(height, 1u)));
+    for (uint32_t i = 1; i < Slices; ++i)
+        m_SliceDepths[i] = nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(i) / Slices);
+    m_SliceDepths[0] = -FLT_MAX;
+    m_SliceDepths[Slices] = FLT_MAX;
+    m_NearPlane = nearPlane;
+
+    const Math::Mat4& view = camera.GetViewMatrix();
+    const Math::Mat4& projection = camera.GetProjectionMatrix();
+    m_Orthographic = camera.IsOrthographic();
+    m_ProjectionX = projection[0][0];
+    m_ProjectionY = projection[1][1];
+    // x_ndc = scale * x + offset, with x divided by the depth for perspective
+    m_OffsetX = m_Orthographic ? projection[3][0] : -projection[2][0];
+    m_OffsetY = m_Orthographic ? projection[3][1] : -projection[2][1];
+
+    // Lights outside the frustum take no part, and aren't uploaded either
+    uint32_t lightCount = static_cast<uint32_t>(m_Lights.size());
+    m_Spheres.Resize(lightCount);
+    for (uint32_t i = 0; i < lightCount; ++i) {
+        const Math::Vector4& light = m_Lights[i].positionRange;
+        m_Spheres.Set(i, {{light.x, light.y, light.z}, light.w});
+    }
+    m_Visibility.resize(lightCount);
+    Culling::CullSpheres(camera.GetFrustum(), m_Spheres, 0, lightCount, m_Visibility.data());
+
+    m_Upload.clear();
+    m_ViewX.clear();
+    m_ViewY.clear();
+    m_DepthMin.clear();
+    m_DepthMax.clear();
+    m_Radius.clear();
+    for (uint32_t i = 0; i < lightCount && m_Upload.size() < m_MaxLights; ++i) {
+        if (!m_Visibility[i]) continue;
+        const Math::Vector4& light = m_Lights[i].positionRange;
+        glm::vec4 position = view * glm::vec4(light.x, light.y, light.z, 1.0f);
+        m_Upload.push_back(m_Lights[i]);
+        m_ViewX.push_back(position.x);
+        m_ViewY.push_back(position.y);
+        m_DepthMin.push_back(-position.z - light.w);
+        m_DepthMax.push_back(-position.z + light.w);
+        m_Radius.push_back(light.w);
+    }
+    m_Stats.visibleLights = static_cast<uint32_t>(m_Upload.size());
+
+    // Slices are independent, each fills its own lists
+    Jobs::ParallelFor(Slices, 1, [this](uint32_t begin, uint32_t end) {
+        for (uint32_t slice = begin; slice < end; ++slice)
+            BuildSlice(slice);
+    });
+
+    // Stitch the slices together; a cluster is tileX + tileY * TilesX + slice * TilesX * TilesY
+    m_ClusterData.resize(size_t(ClusterCount) * 2);
+    m_Indices.clear();
+    for (uint32_t s = 0; s < Slices; ++s) {
+        const Slice& slice = m_Slices[s];
+        uint32_t base = static_cast<uint32_t>(m_Indices.size());
+        uint32_t room = m_MaxIndices - base;
+        uint32_t taken = std::min(room, static_cast<uint32_t>(slice.indices.size()));
+        m_Indices.insert(m_Indices.end(), slice.indices.begin(), slice.indices.begin() + taken);
+        m_Stats.droppedIndices += slice.dropped + static_cast<uint32_t>(slice.indices.size()) - taken;
+
+        for (uint32_t tile = 0; tile < TileCount; ++tile) {
+            uint32_t cluster = s * TileCount + tile;
+            uint32_t offset = std::min(slice.offsets[tile], taken);
+            uint32_t count = std::min(slice.counts[tile], taken - offset);
+            m_ClusterData[cluster * 2] = base + offset;
+            m_ClusterData[cluster * 2 + 1] = count;
+            m_Stats.maxClusterLights = std::max(m_Stats.maxClusterLights, count);
+        }
+    }
+    m_Stats.lightIndices = static_cast<uint32_t>(m_Indices.size());
+    RenderStats& frameStats = RenderStatistics::GetCurrent();
+    frameStats.visibleLights += m_Stats.visibleLights;
+    frameStats.lightIndices += m_Stats.lightIndices;
+    if (m_Stats.droppedIndices > 0 && !m_WarnedDropped) {
+        KOSMIC_WARN("LightClusters: {} cluster entries dropped, clusters are over {} lights or out of texels",
+                    m_Stats.droppedIndices, MaxLightsPerCluster);
+        m_WarnedDropped = true;
+    }
+
+    // Nothing to light two frames in a row: the zero counts are already there
+    if (m_Upload.empty() && m_UploadedLights == 0) return;
+    Upload(m_ClusterBuffer, m_ClusterData.data(), m_ClusterData.size() * sizeof(uint32_t));
+    Upload(m_IndexBuffer, m_Indices.data(), m_Indices.size() * sizeof(uint16_t));
+    Upload(m_LightBuffer, m_Upload.data(), m_Upload.size() * sizeof(LightData));
+    m_UploadedLights = static_cast<uint32_t>(m_Upload.size());
+}
+
+void LightClusters::BuildSlice(uint32_t sliceIndex) {
+    Slice& slice = m_Slices[sliceIndex];
+    slice.hits.clear();
+    slice.counts.assign(TileCount, 0);
+    slice.offsets.resize(TileCount);
+    slice.dropped = 0;
+
+    const float sliceNear = m_SliceDepths[sliceIndex];
+    const float sliceFar = m_SliceDepths[sliceIndex + 1];
+
+    // Tiles covered by the part of the light's sphere inside this slice,
+    // from its view-space bounding box
+    auto addLight = [&](uint32_t light) {
+        float depthNear = std::max({m_DepthMin[light], sliceNear, m_NearPlane});
+        float depthFar = std::max(std::min(m_DepthMax[light], sliceFar), depthNear);
+        float radius = m_Radius[light];
+        float minX = m_ViewX[light] - radius, maxX = m_ViewX[light] + radius;
+        float minY = m_ViewY[light] - radius, maxY = m_ViewY[light] + radius;
+        if (!m_Orthographic) {
+            // Widest on screen where the box is closest, narrowest where farthest
+            minX /= minX < 0.0f ? depthNear : depthFar;
+            maxX /= maxX > 0.0f ? depthNear : depthFar;
+            minY /= minY < 0.0f ? depthNear : depthFar;
+            maxY /= maxY > 0.0f ? depthNear : depthFar;
+        }
+        minX = minX * m_ProjectionX + m_OffsetX;
+        maxX = maxX * m_ProjectionX + m_OffsetX;
+        minY = minY * m_ProjectionY + m_OffsetY;
+        maxY = maxY * m_ProjectionY + m_OffsetY;
+        if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f) return;
+
+        SliceHit hit{static_cast<uint16_t>(light), ToTile(minX, TilesX), ToTile(maxX, TilesX),
+                     ToTile(minY, TilesY), ToTile(maxY, TilesY)};
+        for (uint32_t y = hit.y0; y <= hit.y1; ++y)
+            for (uint32_t x = hit.x0; x <= hit.x1; ++x)
+                slice.counts[y * TilesX + x]++;
+        slice.hits.push_back(hit);
+    };
+
+    // Depth overlap first, four lights at a time
+    uint32_t count = static_cast<uint32_t>(m_DepthMin.size());
+    uint32_t i = 0;
+#if defined(KOSMIC_LIGHTS_SSE)
+    __m128 nearV = _mm_set1_ps(sliceNear);
+    __m128 farV = _mm_set1_ps(sliceFar);
+    for (; i + 4 <= count; i += 4) {
+        __m128 overlaps = _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(&m_DepthMin[i]), farV),
+                                     _mm_cmpgt_ps(_mm_loadu_ps(&m_DepthMax[i]), nearV));
+        for (uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(overlaps)); mask; mask &= mask - 1)
+            addLight(i + std::countr_zero(mask));
+    }
+#endif
+    for (; i < count; ++i) {
+        if (m_DepthMin[i] < sliceFar && m_DepthMax[i] > sliceNear)
+            addLight(i);
+    }
+
+    // Counting sort into per-tile lists, in light order
+    uint32_t total = 0;
+    for (uint32_t tile = 0; tile < TileCount; ++tile) {
+        uint32_t capped = std::min(slice.counts[tile], MaxLightsPerCluster);
+        slice.dropped += slice.counts[tile] - capped;
+        slice.offsets[tile] = total;
+        slice.counts[tile] = 0;
+        total += capped;
+    }
+    slice.indices.resize(total);
+    for (const SliceHit& hit : slice.hits) {
+        for (uint32_t y = hit.y0; y <= hit.y1; ++y) {
+            for (uint32_t x = hit.x0; x <= hit.x1; ++x) {
+                uint32_t tile = y * TilesX + x;
+                if (slice.counts[tile] < MaxLightsPerCluster)
+                    slice.indices[slice.offsets[tile] + slice.counts[tile]++] = hit.light;
+            }
+        }
+    }
+}
+
+void LightClusters::Bind() const {
+    if (!m_ClusterTexture) return;
+    StateManager::BindTexture(TextureUnit::ClusterLights, m_ClusterTexture, GL_TEXTURE_BUFFER);
+    StateManager::BindTexture(TextureUnit::LightIndices, m_IndexTexture, GL_TEXTURE_BUFFER);
+    StateManager::BindTexture(TextureUnit::LightData, m_LightTexture, GL_TEXTURE_BUFFER);
+}
+
+} // namespace Kosmic::Renderer
@@ -1,64 +1,167 @@
 #include "Kosmic/Renderer/Mesh.hpp"
+#include "Kosmic/Renderer/StateManager.hpp"
+#include "Kosmic/Renderer/RenderStats.hpp"
 #include <GL/glew.h>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 
 namespace Kosmic::Renderer {
 
+static std::atomic<uint32_t> s_NextMeshID{1};
+
 Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
-    : m_Vertices(vertices), m_Indices(indices) {
-    SetupMesh();
+    : Mesh(vertices, indices, VertexLayout::Choose(vertices.data(), static_cast<uint32_t>(vertices.size()))) {}
+
+Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const VertexLayout& layout)
+    : m_ID(s_NextMeshID++), m_VertexCount(static_cast<uint32_t>(vertices.size())),
+      m_IndexCount(static_cast<uint32_t>(indices.size())), m_Layout(layout) {
+    std::vector<uint8_t> packed(size_t(m_VertexCount) * m_Layout.stride);
+    m_Layout.Pack(vertices.data(), m_VertexCount, packed.data());
+    if (vertices.size() <= 65536) {
+        std::vector<uint16_t> narrow(indices.begin(), indices.end());
+        m_IndexType = IndexType::UInt16;
+        SetupMesh(packed.data(), narrow.data());
+    } else {
+        SetupMesh(packed.data(), indices.data());
+    }
+    ComputeBounds(vertices.data(), m_VertexCount, m_Bounds, m_BoundingSphere);
+}
+
+Mesh::Mesh(const void* vertices, uint32_t vertexCount, const VertexLayout& layout, const void* indices,
+           uint32_t indexCount, IndexType indexType, const Math::AABB& bounds,
+           const Math::BoundingSphere& boundingSphere)
+    : m_ID(s_NextMeshID++), m_VertexCount(vertexCount), m_IndexCount(indexCount), m_IndexType(indexType),
+      m_Layout(layout), m_Bounds(bounds), m_BoundingSphere(boundingSphere) {
+    SetupMesh(vertices, indices);
 }
 
 Mesh::~Mesh() {
+    if (IsPooled()) {
+        GeometryPool::Free(m_Allocation);
+        return;
+    }
     glDeleteVertexArrays(1, &m_VAO);
+    StateManager::OnVertexArrayDeleted(m_VAO);
     glDeleteBuffers(1, &m_VBO);
     glDeleteBuffers(1, &m_EBO);
+    if (m_InstanceVBO) glDeleteBuffers(1, &m_InstanceVBO);
 }
 
-void Mesh::SetupMesh() {
+void Mesh::SetupMesh(const void* vertices, const void* indices) {
+    m_Allocation = GeometryPool::Allocate(m_Layout, m_IndexType, vertices, m_VertexCount, indices, m_IndexCount);
+    if (IsPooled()) {
+        m_VAO = GeometryPool::GetVAO(m_Allocation.page);
+        return;
+    }
+
     glGenVertexArrays(1, &m_VAO);
     glGenBuffers(1, &m_VBO);
     glGenBuffers(1, &m_EBO);
 
-    glBindVertexArray(m_VAO);
+    StateManager::BindVertexArray(m_VAO);
+    RenderStatistics::GetCurrent().bufferBytes += size_t(m_VertexCount) * m_Layout.stride +
+                                                  size_t(m_IndexCount) * static_cast<uint32_t>(m_IndexType);
     
     glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBufferData(GL_ARRAY_BUFFER, m_Vertices.size() * sizeof(Vertex), m_Vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, size_t(m_VertexCount) * m_Layout.stride, vertices, GL_STATIC_DRAW);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_Indices.size() * sizeof(uint32_t), m_Indices.data(), GL_STATIC_DRAW);
-
-    // Configure vertex attributes
-    // Position -> layout(location = 0)
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Position));
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, size_t(m_IndexCount) * static_cast<uint32_t>(m_IndexType), indices,
+                 GL_STATIC_DRAW);
 
-    // Color -> layout(location = 1)
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Color));
+    // Locations follow VertexAttribute: position 0, color 1, UVs 2, normal 3
+    m_Layout.Apply();
+    StateManager::SetConstantColor(m_VAO, !m_Layout.Has(VertexAttribute::Color));
+    
+    StateManager::BindVertexArray(0);
+}
 
-    // TexCoords -> layout(location = 2)
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+void Mesh::ComputeBounds(const Vertex* vertices, uint32_t vertexCount,
+                         Math::AABB& bounds, Math::BoundingSphere& boundingSphere) {
+    bounds = {};
+    boundingSphere = {};
+    for (uint32_t i = 0; i < vertexCount; ++i)
+        bounds.Expand(vertices[i].Position);
+    if (!bounds.IsValid()) return;
+
+    // Centered on the box, which is close enough to minimal for culling
+    boundingSphere.center = bounds.GetCenter();
+    float radiusSquared = 0.0f;
+    for (uint32_t i = 0; i < vertexCount; ++i) {
+        Math::Vector3 offset = vertices[i].Position - boundingSphere.center;
+        radiusSquared = std::max(radiusSquared, offset.x * offset.x + offset.y * offset.y + offset.z * offset.z);
+    }
+    boundingSphere.radius = std::sqrt(radiusSquared);
+}
 
-    // Normal -> layout(location = 3)
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-    
-    glBindVertexArray(0);
+uint32_t Mesh::GetGLIndexType() const {
+    return m_IndexType == IndexType::UInt16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
 }
 
 void Mesh::Bind() const {
-    glBindVertexArray(m_VAO);
+    StateManager::BindVertexArray(m_VAO);
 }
 
 void Mesh::Unbind() const {
-    glBindVertexArray(0);
+    StateManager::BindVertexArray(0);
 }
 
 void Mesh::Draw() const {
     Bind();
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(m_Indices.size()), GL_UNSIGNED_INT, 0);
-    Unbind();
+    glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(m_IndexCount), GetGLIndexType(),
+                             (void*)(size_t(GetFirstIndex()) * static_cast<uint32_t>(m_IndexType)),
+                             static_cast<GLint>(GetBaseVertex()));
+    RenderStats& stats = RenderStatistics::GetCurrent();
+    stats.drawCalls++;
+    stats.triangles += m_IndexCount / 3;
+}
+
+void ApplyInstanceAttributes() {
+    // Model matrix -> layout(location = 4..7), one column per location
+    for (GLuint column = 0; column < 4; ++column) {
+        GLuint location = 4 + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (void*)(offsetof(InstanceData, transform) + sizeof(float) * 4 * column));
+        glVertexAttribDivisor(location, 1);
+    }
+
+    // Color -> layout(location = 8)
+    glEnableVertexAttribArray(8);
+    glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, color));
+    glVertexAttribDivisor(8, 1);
+}
+
+void Mesh::SetInstanceData(const InstanceData* instances, uint32_t count) {
+    if (IsPooled()) {
+        // The page's buffer is shared, orphaning keeps earlier draws' data intact
+        glBindBuffer(GL_ARRAY_BUFFER, GeometryPool::GetInstanceBuffer(m_Allocation.page));
+    } else if (!m_InstanceVBO) {
+        glGenBuffers(1, &m_InstanceVBO);
+        StateManager::BindVertexArray(m_VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, m_InstanceVBO);
+        ApplyInstanceAttributes();
+    } else {
+        glBindBuffer(GL_ARRAY_BUFFER, m_InstanceVBO);
+    }
+
+    // Fresh storage every upload so the previous draw never has to be waited on
+    glBufferData(GL_ARRAY_BUFFER, count * sizeof(InstanceData), instances, GL_STREAM_DRAW);
+    RenderStatistics::GetCurrent().bufferBytes += count * sizeof(InstanceData);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Mesh::DrawInstanced(uint32_t instanceCount) const {
+    Bind();
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(m_IndexCount), GetGLIndexType(),
+                                      (void*)(size_t(GetFirstIndex()) * static_cast<uint32_t>(m_IndexType)),
+                                      static_cast<GLsizei>(instanceCount), static_cast<GLint>(GetBaseVertex()));
+    RenderStats& stats = RenderStatistics::GetCurrent();
+    stats.drawCalls++;
+    stats.triangles += uint64_t(m_IndexCount / 3) * instanceCount;
+    stats.instances += instanceCount;
 }
 
 void Mesh::SetTransform(const Math::Mat4& transform) {
@@ -0,0 +1,338 @@
+#include "Kosmic/Renderer/OcclusionCulling.hpp"
+#include "Kosmic/Renderer/RenderStats.hpp"
+#include "Kosmic/Core/Jobs.hpp"
+#include "Kosmic/Core/Profiler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+    #define KOSMIC_RASTER_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define KOSMIC_RASTER_SSE
+#endif
+
+namespace Kosmic::Renderer {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t TileCount = OcclusionCuller::TilesX * OcclusionCuller::TilesY;
+// Levels that fit inside a tile, reduced by the tile's job
+constexpr uint32_t TileLevels = std::countr_zero(std::min(OcclusionCuller::TileWidth, OcclusionCuller::TileHeight));
+
+constexpr uint32_t LevelWidth(uint32_t level) { return std::max(OcclusionCuller::Width >> level, 1u); }
+constexpr uint32_t LevelHeight(uint32_t level) { return std::max(OcclusionCuller::Height >> level, 1u); }
+
+double Milliseconds(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Texel (x, y) of the next level from the 2x2 block under it
+void Reduce(const std::vector<float>& source, std::vector<float>& target, uint32_t level,
+            uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) {
+    uint32_t sourceWidth = LevelWidth(level - 1), sourceHeight = LevelHeight(level - 1);
+    uint32_t width = LevelWidth(level);
+    for (uint32_t y = y0; y < y1; ++y) {
+        uint32_t sy0 = std::min(y * 2, sourceHeight - 1), sy1 = std::min(y * 2 + 1, sourceHeight - 1);
+        for (uint32_t x = x0; x < x1; ++x) {
+            uint32_t sx0 = std::min(x * 2, sourceWidth - 1), sx1 = std::min(x * 2 + 1, sourceWidth - 1);
+            target[y * width + x] = std::max(std::max(source[sy0 * sourceWidth + sx0], source[sy0 * sourceWidth + sx1]),
+                                             std::max(source[sy1 * sourceWidth + sx0], source[sy1 * sourceWidth + sx1]));
+        }
+    }
+}
+
+} // namespace
+
+// Keeps the nearest depth of the triangle's pixels in [x0, x1) of a row.
+// x0 and x1 are multiples of the lane count, so whole groups stay in the tile.
+#if defined(KOSMIC_RASTER_AVX)
+
+namespace {
+
+constexpr uint32_t Lanes = 8;
+
+template <typename Triangle>
+void RasterizeSpan(const Triangle& t, float py, uint32_t x0, uint32_t x1, float* row) {
+    const __m256 offsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    __m256 a0 = _mm256_set1_ps(t.a[0]), a1 = _mm256_set1_ps(t.a[1]), a2 = _mm256_set1_ps(t.a[2]);
+    __m256 row0 = _mm256_set1_ps(t.b[0] * py + t.c[0]);
+    __m256 row1 = _mm256_set1_ps(t.b[1] * py + t.c[1]);
+    __m256 row2 = _mm256_set1_ps(t.b[2] * py + t.c[2]);
+    __m256 depthX = _mm256_set1_ps(t.depthX), rowDepth = _mm256_set1_ps(t.depthY * py + t.depthC);
+
+    for (uint32_t x = x0; x < x1; x += Lanes) {
+        __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), offsets);
+        __m256 inside = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(a0, px), row0), zero, _CMP_GE_OQ),
+                          _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(a1, px), row1), zero, _CMP_GE_OQ)),
+            _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(a2, px), row2), zero, _CMP_GE_OQ));
+        if (_mm256_movemask_ps(inside) == 0) continue;
+        __m256 depth = _mm256_add_ps(_mm256_mul_ps(depthX, px), rowDepth);
+        __m256 current = _mm256_loadu_ps(row + x);
+        _mm256_storeu_ps(row + x, _mm256_blendv_ps(current, _mm256_min_ps(current, depth), inside));
+    }
+}
+
+} // namespace
+
+const char* OcclusionCuller::GetKernelName() { return "AVX"; }
+
+#elif defined(KOSMIC_RASTER_SSE)
+
+namespace {
+
+constexpr uint32_t Lanes = 4;
+
+template <typename Triangle>
+void RasterizeSpan(const Triangle& t, float py, uint32_t x0, uint32_t x1, float* row) {
+    const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+    __m128 a0 = _mm_set1_ps(t.a[0]), a1 = _mm_set1_ps(t.a[1]), a2 = _mm_set1_ps(t.a[2]);
+    __m128 row0 = _mm_set1_ps(t.b[0] * py + t.c[0]);
+    __m128 row1 = _mm_set1_ps(t.b[1] * py + t.c[1]);
+    __m128 row2 = _mm_set1_ps(t.b[2] * py + t.c[2]);
+    __m128 depthX = _mm_set1_ps(t.depthX), rowDepth = _mm_set1_ps(t.depthY * py + t.depthC);
+
+    for (uint32_t x = x0; x < x1; x += Lanes) {
+        __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, px), row0), zero),
+                                              _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, px), row1), zero)),
+                                   _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, px), row2), zero));
+        if (_mm_movemask_ps(inside) == 0) continue;
+        __m128 depth = _mm_add_ps(_mm_mul_ps(depthX, px), rowDepth);
+        __m128 current = _mm_loadu_ps(row + x);
+        // No blendv before SSE4.1
+        __m128 nearest = _mm_min_ps(current, depth);
+        _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+    }
+}
+
+} // namespace
+
+const char* OcclusionCuller::GetKernelName() { return "SSE"; }
+
+#else
+
+namespace {
+
+constexpr uint32_t Lanes = 1;
+
+template <typename Triangle>
+void RasterizeSpan(const Triangle& t, float py, uint32_t x0, uint32_t x1, float* row) {
+    for (uint32_t x = x0; x < x1; ++x) {
+        float px = static_cast<float>(x) + 0.5f;
+        bool inside = true;
+        for (int edge = 0; edge < 3; ++edge)
+            inside &= t.a[edge] * px + t.b[edge] * py + t.c[edge] >= 0.0f;
+        if (inside) row[x] = std::min(row[x], t.depthX * px + t.depthY * py + t.depthC);
+    }
+}
+
+} // namespace
+
+const char* OcclusionCuller::GetKernelName() { return "Scalar"; }
+
+#endif
+
+static_assert(OcclusionCuller::TileWidth % Lanes == 0, "Spans must not cross tiles");
+
+OccluderMesh OccluderMesh::Box(const Math::AABB& box) {
+    OccluderMesh mesh;
+    for (int i = 0; i < 8; ++i)
+        mesh.positions.emplace_back(i & 1 ? box.max.x : box.min.x, i & 2 ? box.max.y : box.min.y,
+                                    i & 4 ? box.max.z : box.min.z);
+    // Two triangles per face, counter-clockwise from outside
+    mesh.indices = {0, 2, 3, 0, 3, 1,   // -z
+                    4, 5, 7, 4, 7, 6,   // +z
+                    0, 4, 6, 0, 6, 2,   // -x
+                    1, 3, 7, 1, 7, 5,   // +x
+                    0, 1, 5, 0, 5, 4,   // -y
+                    2, 6, 7, 2, 7, 3};  // +y
+    return mesh;
+}
+
+OcclusionCuller::OcclusionCuller() {
+    for (uint32_t level = 0; level < LevelCount; ++level)
+        m_Levels[level].assign(size_t(LevelWidth(level)) * LevelHeight(level), 1.0f);
+}
+
+void OcclusionCuller::AddOccluder(const OccluderMesh& mesh, const Math::Mat4& transform) {
+    m_Occluders.push_back({&mesh, transform});
+}
+
+void OcclusionCuller::SetupTriangles(const Occluder& occluder) {
+    const OccluderMesh& mesh = *occluder.mesh;
+    Math::Mat4 transform = m_ViewProjection * occluder.transform;
+    m_Clip.resize(mesh.positions.size());
+    for (size_t i = 0; i < mesh.positions.size(); ++i) {
+        const Math::Vector3& p = mesh.positions[i];
+        m_Clip[i] = transform * glm::vec4(p.x, p.y, p.z, 1.0f);
+    }
+
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        const glm::vec4* clip[3] = {&m_Clip[mesh.indices[i]], &m_Clip[mesh.indices[i + 1]], &m_Clip[mesh.indices[i + 2]]};
+        // No near plane clipping: a triangle crossing it is left out
+        bool crossesNear = false;
+        for (const glm::vec4* v : clip)
+            crossesNear |= v->w <= 0.0f || v->z < -v->w;
+        if (crossesNear) continue;
+
+        float x[3], y[3], z[3];
+        for (int v = 0; v < 3; ++v) {
+            float inverseW = 1.0f / clip[v]->w;
+            x[v] = (clip[v]->x * inverseW * 0.5f + 0.5f) * Width;
+            y[v] = (clip[v]->y * inverseW * 0.5f + 0.5f) * Height;
+            z[v] = clip[v]->z * inverseW * 0.5f + 0.5f;
+        }
+        // Back faces and slivers; a closed mesh is covered by its front faces
+        float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        if (area <= 0.0f) continue;
+
+        Triangle triangle;
+        triangle.minX = std::max(static_cast<int32_t>(std::floor(std::min({x[0], x[1], x[2]}))), 0);
+        triangle.minY = std::max(static_cast<int32_t>(std::floor(std::min({y[0], y[1], y[2]}))), 0);
+        triangle.maxX = std::min(static_cast<int32_t>(std::ceil(std::max({x[0], x[1], x[2]}))), int32_t(Width));
+        triangle.maxY = std::min(static_cast<int32_t>(std::ceil(std::max({y[0], y[1], y[2]}))), int32_t(Height));
+        if (triangle.minX >= triangle.maxX || triangle.minY >= triangle.maxY) continue;
+
+        for (int edge = 0; edge < 3; ++edge) {
+            int next = (edge + 1) % 3;
+            triangle.a[edge] = y[edge] - y[next];
+            triangle.b[edge] = x[next] - x[edge];
+            triangle.c[edge] = (y[next] - y[edge]) * x[edge] - (x[next] - x[edge]) * y[edge];
+        }
+        triangle.depthX = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+        triangle.depthY = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+        // Farthest the plane gets within a pixel, not just at its center
+        triangle.depthC = z[0] - triangle.depthX * x[0] - triangle.depthY * y[0] +
+                          0.5f * (std::abs(triangle.depthX) + std::abs(triangle.depthY));
+
+        uint32_t index = static_cast<uint32_t>(m_Triangles.size());
+        m_Triangles.push_back(triangle);
+        for (int32_t tileY = triangle.minY / int32_t(TileHeight); tileY <= (triangle.maxY - 1) / int32_t(TileHeight); ++tileY)
+            for (int32_t tileX = triangle.minX / int32_t(TileWidth); tileX <= (triangle.maxX - 1) / int32_t(TileWidth); ++tileX)
+                m_Bins[tileY * TilesX + tileX].push_back(index);
+    }
+}
+
+void OcclusionCuller::RenderTile(uint32_t tile) {
+    const int32_t tileX0 = int32_t(tile % TilesX * TileWidth), tileY0 = int32_t(tile / TilesX * TileHeight);
+    const int32_t tileX1 = tileX0 + int32_t(TileWidth), tileY1 = tileY0 + int32_t(TileHeight);
+    std::vector<float>& depth = m_Levels[0];
+
+    for (int32_t y = tileY0; y < tileY1; ++y)
+        std::fill_n(depth.data() + size_t(y) * Width + tileX0, TileWidth, 1.0f);
+
+    for (uint32_t index : m_Bins[tile]) {
+        const Triangle& triangle = m_Triangles[index];
+        int32_t minX = std::max(triangle.minX, tileX0), maxX = std::min(triangle.maxX, tileX1);
+        int32_t minY = std::max(triangle.minY, tileY0), maxY = std::min(triangle.maxY, tileY1);
+        // Whole lane groups, the tile width is a multiple of them
+        uint32_t spanStart = uint32_t(minX) / Lanes * Lanes;
+        uint32_t spanEnd = (uint32_t(maxX) + Lanes - 1) / Lanes * Lanes;
+        for (int32_t y = minY; y < maxY; ++y)
+            RasterizeSpan(triangle, static_cast<float>(y) + 0.5f, spanStart, spanEnd, depth.data() + size_t(y) * Width);
+    }
+
+    // The levels whose texels all come from this tile
+    for (uint32_t level = 1; level <= TileLevels && level < LevelCount; ++level)
+        Reduce(m_Levels[level - 1], m_Levels[level], level, uint32_t(tileX0) >> level, uint32_t(tileY0) >> level,
+               uint32_t(tileX1) >> level, uint32_t(tileY1) >> level);
+}
+
+void OcclusionCuller::Render(const Math::Mat4& viewProjection) {
+    KOSMIC_PROFILE_SCOPE("OcclusionCuller::Render");
+    Clock::time_point start = Clock::now();
+    m_Stats = {};
+    m_Stats.occluders = static_cast<uint32_t>(m_Occluders.size());
+    m_ViewProjection = viewProjection;
+    if (m_Occluders.empty()) return;
+
+    m_Triangles.clear();
+    for (std::vector<uint32_t>& bin : m_Bins)
+        bin.clear();
+    for (const Occluder& occluder : m_Occluders)
+        SetupTriangles(occluder);
+    m_Occluders.clear();
+    m_Stats.triangles = static_cast<uint32_t>(m_Triangles.size());
+
+    // Tiles write disjoint parts of every level up to TileLevels
+    Jobs::ParallelFor(TileCount, 1, [this](uint32_t begin, uint32_t end) {
+        for (uint32_t tile = begin; tile < end; ++tile)
+            RenderTile(tile);
+    });
+    for (uint32_t level = TileLevels + 1; level < LevelCount; ++level)
+        Reduce(m_Levels[level - 1], m_Levels[level], level, 0, 0, LevelWidth(level), LevelHeight(level));
+
+    m_Stats.rasterTime = Milliseconds(start);
+}
+
+bool OcclusionCuller::IsOccluded(const Math::AABB& box) const {
+    if (m_Stats.occluders == 0 || !box.IsValid()) return false;
+
+    constexpr float Max = std::numeric_limits<float>::max();
+    float minX = Max, minY = Max, maxX = -Max, maxY = -Max, nearest = 1.0f;
+    for (int i = 0; i < 8; ++i) {
+        glm::vec4 clip = m_ViewProjection * glm::vec4(i & 1 ? box.max.x : box.min.x, i & 2 ? box.max.y : box.min.y,
+                                                      i & 4 ? box.max.z : box.min.z, 1.0f);
+        // Reaches the camera, nothing can be in front of all of it
+        if (clip.w <= 0.0f || clip.z < -clip.w) return false;
+        float inverseW = 1.0f / clip.w;
+        minX = std::min(minX, clip.x * inverseW);
+        maxX = std::max(maxX, clip.x * inverseW);
+        minY = std::min(minY, clip.y * inverseW);
+        maxY = std::max(maxY, clip.y * inverseW);
+        nearest = std::min(nearest, clip.z * inverseW * 0.5f + 0.5f);
+    }
+    // Off screen is for the frustum test to decide
+    if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f) return false;
+
+    auto toPixel = [](float ndc, uint32_t size) {
+        return static_cast<uint32_t>(std::clamp((ndc * 0.5f + 0.5f) * size, 0.0f, static_cast<float>(size - 1)));
+    };
+    uint32_t x0 = toPixel(minX, Width), x1 = toPixel(maxX, Width);
+    uint32_t y0 = toPixel(minY, Height), y1 = toPixel(maxY, Height);
+
+    // The level where the box spans two or three texels each way
+    uint32_t span = std::max(x1 - x0, y1 - y0) + 1;
+    uint32_t level = std::min(span > 2 ? std::bit_width(span - 1) - 1 : 0u, LevelCount - 1);
+    const std::vector<float>& depth = m_Levels[level];
+    uint32_t width = LevelWidth(level);
+    for (uint32_t y = y0 >> level; y <= (y1 >> level); ++y)
+        for (uint32_t x = x0 >> level; x <= (x1 >> level); ++x)
+            if (depth[y * width + x] >= nearest) return false;
+    return true;
+}
+
+uint32_t OcclusionCuller::Cull(const Math::AABB* boxes, uint32_t count, uint8_t* visible) {
+    KOSMIC_PROFILE_SCOPE("OcclusionCuller::Cull");
+    Clock::time_point start = Clock::now();
+    std::atomic<uint32_t> visibleCount{0};
+    Jobs::ParallelFor(count, 256, [&](uint32_t begin, uint32_t end) {
+        uint32_t chunkVisible = 0;
+        for (uint32_t i = begin; i < end; ++i) {
+            visible[i] = !IsOccluded(boxes[i]);
+            chunkVisible += visible[i];
+        }
+        visibleCount.fetch_add(chunkVisible, std::memory_order_relaxed);
+    });
+
+    uint32_t occluded = count - visibleCount.load();
+    m_Stats.tested += count;
+    m_Stats.occluded += occluded;
+    m_Stats.testTime += Milliseconds(start);
+    RenderStats& frameStats = RenderStatistics::GetCurrent();
+    frameStats.occlusionTested += count;
+    frameStats.occludedObjects += occluded;
+    return count - occluded;
+}
+
+} // namespace Kosmic::Renderer
@@ -0,0 +1,162 @@
+#include "Kosmic/Renderer/OcclusionQueries.hpp"
+#include "Kosmic/Renderer/Mesh.hpp"
+#include "Kosmic/Renderer/Shader.hpp"
+#include "Kosmic/Renderer/StateManager.hpp"
+#include "Kosmic/Renderer/RenderStats.hpp"
+#include "Kosmic/Core/Profiler.hpp"
+#include <GL/glew.h>
+#include <algorithm>
+
+namespace Kosmic::Renderer {
+
+namespace {
+
+// Query boxes are grown by this much of their size, so faces that coincide
+// with the draw's own surface still pass the depth test
+constexpr float BoxGrowth = 0.01f;
+
+// Closer than this many near plane distances, the near plane may clip the
+// box's front faces and the query would find nothing
+constexpr float NearMargin = 4.0f;
+
+bool Contains(const Math::AABB& box, const Math::Vector3& point, float margin) {
+    return point.x >= box.min.x - margin && point.x <= box.max.x + margin &&
+           point.y >= box.min.y - margin && point.y <= box.max.y + margin &&
+           point.z >= box.min.z - margin && point.z <= box.max.z + margin;
+}
+
+} // namespace
+
+OcclusionQueries::~OcclusionQueries() {
+    for (const Pending& pending : m_Pending)
+        m_FreeQueries.push_back(pending.query);
+    if (!m_FreeQueries.empty())
+        glDeleteQueries(static_cast<GLsizei>(m_FreeQueries.size()), m_FreeQueries.data());
+}
+
+uint32_t OcclusionQueries::AcquireQuery() {
+    if (m_FreeQueries.empty()) {
+        GLuint query = 0;
+        glGenQueries(1, &query);
+        return query;
+    }
+    uint32_t query = m_FreeQueries.back();
+    m_FreeQueries.pop_back();
+    return query;
+}
+
+void OcclusionQueries::BeginFrame(const Math::Vector3& cameraPosition, float nearPlane) {
+    KOSMIC_PROFILE_SCOPE("OcclusionQueries::BeginFrame");
+    m_Frame++;
+    m_CameraPosition = cameraPosition;
+    m_NearPlane = nearPlane;
+    m_Tests.clear();
+    m_Stats = {};
+
+    // Queries finish in the order they were issued: stop at the first one
+    // still running instead of asking about every one of them
+    while (!m_Pending.empty()) {
+        const Pending& pending = m_Pending.front();
+        GLint available = 0;
+        glGetQueryObjectiv(pending.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        // The slot may have been reset since, then the result is stale
+        if (pending.object < m_Objects.size() && m_Objects[pending.object].query == pending.query) {
+            Object& object = m_Objects[pending.object];
+            GLuint samples = 0;
+            glGetQueryObjectuiv(pending.query, GL_QUERY_RESULT, &samples);
+            object.visible = samples != 0;
+            object.query = 0;
+        }
+        m_FreeQueries.push_back(pending.query);
+        m_Pending.pop_front();
+    }
+    m_Stats.inFlight = static_cast<uint32_t>(m_Pending.size());
+}
+
+OcclusionQueries::Visibility OcclusionQueries::Classify(uint32_t index, uint32_t meshID, const Math::AABB& box) {
+    if (index >= m_Objects.size()) m_Objects.resize(index + 1);
+    Object& object = m_Objects[index];
+    m_Stats.tested++;
+
+    // Someone else's history, or too old to trust: draw it and find out
+    bool fresh = object.meshID != meshID || object.lastFrame + 1 != m_Frame;
+    object.meshID = meshID;
+    object.lastFrame = m_Frame;
+    if (fresh) {
+        object.query = 0;  // Its result is ignored when it comes back
+        object.visible = true;
+        object.nextCheck = m_Frame;
+    }
+
+    if (Contains(box, m_CameraPosition, m_NearPlane * NearMargin)) {
+        object.visible = true;
+        return Visibility::Visible;
+    }
+
+    if (object.visible) {
+        if (object.query == 0 && m_Frame >= object.nextCheck) {
+            m_Tests.push_back({index, box});
+            // Staggered by slot so the re-checks don't all land on one frame
+            object.nextCheck = m_Frame + VisibleInterval + index % 3;
+        }
+        return Visibility::Visible;
+    }
+
+    if (object.query != 0) {
+        m_Stats.conditional++;
+        return Visibility::Conditional;
+    }
+    m_Tests.push_back({index, box});
+    m_Stats.hidden++;
+    return Visibility::Hidden;
+}
+
+void OcclusionQueries::IssueQueries() {
+    KOSMIC_PROFILE_SCOPE("OcclusionQueries::IssueQueries");
+    if (m_Tests.empty()) return;
+    if (!m_Shader) {
+        m_Shader = Shader::CreateBoundsShader();
+        m_Box = MeshLibrary::Cube();
+    }
+
+    // Depth test only; both faces, in case the camera is close to a box
+    m_Shader->Bind();
+    GLint centerLocation = m_Shader->GetUniformLocation("u_Center");
+    GLint sizeLocation = m_Shader->GetUniformLocation("u_Size");
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    StateManager::SetDepthMask(false);
+    StateManager::SetCullFace(false);
+
+    for (const Test& test : m_Tests) {
+        const Math::AABB& box = test.box;
+        Math::Vector3 size = box.max - box.min;
+        float growth = std::max({size.x, size.y, size.z}) * BoxGrowth;
+        m_Shader->SetVec3(centerLocation, box.GetCenter());
+        m_Shader->SetVec3(sizeLocation, size + Math::Vector3(growth * 2.0f));
+
+        uint32_t query = AcquireQuery();
+        glBeginQuery(GL_ANY_SAMPLES_PASSED, query);
+        m_Box->Draw();
+        glEndQuery(GL_ANY_SAMPLES_PASSED);
+        m_Objects[test.object].query = query;
+        m_Pending.push_back({test.object, query});
+    }
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    StateManager::SetDepthMask(true);
+    StateManager::SetCullFace(true);
+
+    m_Stats.issued = static_cast<uint32_t>(m_Tests.size());
+    RenderStatistics::GetCurrent().occlusionQueries += m_Stats.issued;
+    m_Tests.clear();
+}
+
+void OcclusionQueries::Reset() {
+    // Results still in flight are dropped when they come back
+    m_Objects.clear();
+    m_Tests.clear();
+}
+
+} // namespace Kosmic::Renderer
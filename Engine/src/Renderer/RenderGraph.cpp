@@ -0,0 +1,308 @@
+#include "Kosmic/Renderer/RenderGraph.hpp"
+#include "Kosmic/Renderer/StateManager.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include "Kosmic/Core/Profiler.hpp"
+#include <GL/glew.h>
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+namespace Kosmic::Renderer {
+
+namespace {
+
+// Wraps the functions given to AddPass
+class FunctionPass : public RenderPass {
+public:
+    FunctionPass(std::string name, RenderGraph::SetupFunction setup, RenderGraph::ExecuteFunction execute)
+        : m_Name(std::move(name)), m_Setup(std::move(setup)), m_Execute(std::move(execute)) {}
+
+    void Setup(RenderGraphBuilder& builder) override {
+        if (m_Setup) m_Setup(builder);
+        else builder.SetSideEffect();
+    }
+    void Execute(const RenderGraphContext& context) override { m_Execute(context); }
+    const char* GetName() const override { return m_Name.c_str(); }
+
+private:
+    std::string m_Name;
+    RenderGraph::SetupFunction m_Setup;
+    RenderGraph::ExecuteFunction m_Execute;
+};
+
+} // namespace
+
+void RenderGraphBuilder::Create(std::string_view name, const RenderTargetDesc& desc) {
+    if (m_Graph.FindResource(name) != RenderGraph::None) {
+        KOSMIC_ERROR("Render graph: {} declared twice", name);
+        return;
+    }
+    if (desc.width == 0 || desc.height == 0) {
+        KOSMIC_ERROR("Render graph: {} has no size", name);
+        return;
+    }
+    m_Graph.m_ResourceIndex.emplace(std::string(name), static_cast<uint32_t>(m_Graph.m_Resources.size()));
+    m_Graph.m_Resources.push_back({std::string(name), desc, false, nullptr});
+}
+
+void RenderGraphBuilder::Read(std::string_view name) {
+    m_Graph.m_Passes[m_Pass].readNames.emplace_back(name);
+}
+
+void RenderGraphBuilder::Write(std::string_view name, LoadOp load) {
+    RenderGraph::PassNode& pass = m_Graph.m_Passes[m_Pass];
+    if (!pass.targetName.empty()) {
+        KOSMIC_WARN("Render graph: {} already writes {}, ignoring {}", pass.pass->GetName(), pass.targetName, name);
+        return;
+    }
+    pass.targetName = name;
+    pass.load = load;
+}
+
+void RenderGraphBuilder::SetSideEffect() {
+    m_Graph.m_Passes[m_Pass].sideEffect = true;
+}
+
+uint32_t RenderGraphContext::GetTexture(std::string_view name, uint32_t attachment) const {
+    std::shared_ptr<Framebuffer> framebuffer = GetFramebuffer(name);
+    return framebuffer ? framebuffer->GetColorAttachment(attachment) : 0;
+}
+
+uint32_t RenderGraphContext::GetDepthTexture(std::string_view name) const {
+    std::shared_ptr<Framebuffer> framebuffer = GetFramebuffer(name);
+    return framebuffer ? framebuffer->GetDepthAttachment() : 0;
+}
+
+std::shared_ptr<Framebuffer> RenderGraphContext::GetFramebuffer(std::string_view name) const {
+    uint32_t index = m_Graph.FindResource(name);
+    return index != RenderGraph::None ? m_Graph.m_Resources[index].framebuffer : nullptr;
+}
+
+void RenderGraph::AddPass(std::shared_ptr<RenderPass> pass) {
+    PassNode node;
+    node.pass = std::move(pass);
+    m_Passes.push_back(std::move(node));
+}
+
+void RenderGraph::AddPass(std::string name, SetupFunction setup, ExecuteFunction execute) {
+    AddPass(std::make_shared<FunctionPass>(std::move(name), std::move(setup), std::move(execute)));
+}
+
+void RenderGraph::ImportFramebuffer(std::string_view name, std::shared_ptr<Framebuffer> framebuffer) {
+    auto it = m_Imports.find(name);
+    if (it != m_Imports.end()) it->second = std::move(framebuffer);
+    else m_Imports.emplace(std::string(name), std::move(framebuffer));
+}
+
+uint32_t RenderGraph::FindResource(std::string_view name) const {
+    auto it = m_ResourceIndex.find(name);
+    return it != m_ResourceIndex.end() ? it->second : None;
+}
+
+void RenderGraph::SetupPasses() {
+    m_Resources.clear();
+    m_ResourceIndex.clear();
+    for (const auto& [name, framebuffer] : m_Imports) {
+        m_ResourceIndex.emplace(name, static_cast<uint32_t>(m_Resources.size()));
+        m_Resources.push_back({name, {}, true, framebuffer});
+    }
+
+    for (uint32_t i = 0; i < m_Passes.size(); ++i) {
+        PassNode& pass = m_Passes[i];
+        pass.readNames.clear();
+        pass.targetName.clear();
+        pass.reads.clear();
+        pass.target = None;
+        pass.load = LoadOp::Load;
+        pass.sideEffect = false;
+        pass.live = false;
+        pass.clear = false;
+        pass.dependents.clear();
+        pass.dependencies = 0;
+
+        RenderGraphBuilder builder(*this, i);
+        pass.pass->Setup(builder);
+    }
+
+    // Every pass is set up, so names declared by later passes resolve too
+    for (PassNode& pass : m_Passes) {
+        for (const std::string& name : pass.readNames) {
+            uint32_t resource = FindResource(name);
+            if (resource == None) KOSMIC_WARN("Render graph: {} reads unknown target {}", pass.pass->GetName(), name);
+            else pass.reads.push_back(resource);
+        }
+        if (!pass.targetName.empty()) {
+            pass.target = FindResource(pass.targetName);
+            if (pass.target == None)
+                KOSMIC_WARN("Render graph: {} writes unknown target {}", pass.pass->GetName(), pass.targetName);
+        }
+    }
+}
+
+void RenderGraph::Schedule() {
+    // Writers of a target go in insertion order, and its readers after the
+    // last of them
+    std::vector<uint32_t> lastWriter(m_Resources.size(), None);
+    for (uint32_t i = 0; i < m_Passes.size(); ++i) {
+        uint32_t target = m_Passes[i].target;
+        if (target == None) continue;
+        if (lastWriter[target] != None) {
+            m_Passes[lastWriter[target]].dependents.push_back(i);
+            m_Passes[i].dependencies++;
+        }
+        lastWriter[target] = i;
+    }
+    for (uint32_t i = 0; i < m_Passes.size(); ++i) {
+        for (uint32_t resource : m_Passes[i].reads) {
+            uint32_t writer = lastWriter[resource];
+            if (writer == None || writer == i || m_Passes[i].target == resource) continue;
+            m_Passes[writer].dependents.push_back(i);
+            m_Passes[i].dependencies++;
+        }
+    }
+
+    // Kahn's algorithm, always taking the earliest added pass that is ready
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<>> ready;
+    for (uint32_t i = 0; i < m_Passes.size(); ++i)
+        if (m_Passes[i].dependencies == 0) ready.push(i);
+
+    m_Schedule.clear();
+    while (!ready.empty()) {
+        uint32_t pass = ready.top();
+        ready.pop();
+        m_Schedule.push_back(pass);
+        for (uint32_t dependent : m_Passes[pass].dependents)
+            if (--m_Passes[dependent].dependencies == 0) ready.push(dependent);
+    }
+
+    if (m_Schedule.size() != m_Passes.size()) {
+        KOSMIC_ERROR("Render graph: dependency cycle, running the remaining passes in insertion order");
+        for (uint32_t i = 0; i < m_Passes.size(); ++i)
+            if (m_Passes[i].dependencies > 0) m_Schedule.push_back(i);
+    }
+}
+
+void RenderGraph::Cull() {
+    // Walking backwards: a pass lives if it has side effects, writes an
+    // import, or writes a target some later live pass still needs
+    std::vector<bool> needed(m_Resources.size(), false);
+    for (auto it = m_Schedule.rbegin(); it != m_Schedule.rend(); ++it) {
+        PassNode& pass = m_Passes[*it];
+        bool writesImport = pass.target != None && m_Resources[pass.target].imported;
+        pass.live = pass.sideEffect || writesImport || (pass.target != None && needed[pass.target]);
+        if (!pass.live) continue;
+
+        // A clear overwrites everything earlier writers did, loading keeps it
+        if (pass.target != None) needed[pass.target] = pass.load == LoadOp::Load;
+        for (uint32_t resource : pass.reads) needed[resource] = true;
+    }
+}
+
+void RenderGraph::AllocateTargets() {
+    for (uint32_t position = 0; position < m_Schedule.size(); ++position) {
+        PassNode& pass = m_Passes[m_Schedule[position]];
+        if (!pass.live) continue;
+        auto use = [&](uint32_t resource) {
+            ResourceNode& node = m_Resources[resource];
+            if (node.firstUse == None) node.firstUse = position;
+            node.lastUse = position;
+        };
+        if (pass.target != None) use(pass.target);
+        for (uint32_t resource : pass.reads) use(resource);
+
+        // Whatever an aliased target held before belongs to another resource
+        bool firstWrite = pass.target != None && !m_Resources[pass.target].imported &&
+                          m_Resources[pass.target].firstUse == position;
+        pass.clear = pass.load == LoadOp::Clear || firstWrite;
+    }
+
+    // Targets go back to the pool right after their last use, so the next
+    // one to start can take the same framebuffer
+    std::vector<const Framebuffer*> physical;
+    for (uint32_t position = 0; position < m_Schedule.size(); ++position) {
+        for (ResourceNode& node : m_Resources) {
+            if (node.imported || node.firstUse != position) continue;
+            node.framebuffer = m_Pool.Acquire(node.desc);
+            m_Stats.transientTargets++;
+            if (std::find(physical.begin(), physical.end(), node.framebuffer.get()) == physical.end())
+                physical.push_back(node.framebuffer.get());
+        }
+        for (ResourceNode& node : m_Resources) {
+            if (node.imported || node.firstUse == None || node.lastUse != position) continue;
+            m_Pool.Release(node.framebuffer);
+        }
+    }
+    m_Stats.physicalTargets = static_cast<uint32_t>(physical.size());
+}
+
+void RenderGraph::Execute() {
+    KOSMIC_PROFILE_SCOPE("RenderGraph::Execute");
+    m_Stats = {};
+    m_Stats.passes = static_cast<uint32_t>(m_Passes.size());
+    if (m_Passes.empty()) return;
+
+    SetupPasses();
+    Schedule();
+    Cull();
+    AllocateTargets();
+
+    // Imports without a framebuffer and undeclared passes draw into this
+    uint32_t initialFramebuffer = StateManager::GetFramebuffer();
+    GLint initialViewport[4]{};
+    glGetIntegerv(GL_VIEWPORT, initialViewport);
+    bool viewportChanged = false;
+
+    RenderGraphContext context(*this);
+    for (uint32_t index : m_Schedule) {
+        PassNode& pass = m_Passes[index];
+        if (!pass.live) {
+            m_Stats.culledPasses++;
+            continue;
+        }
+
+        const Framebuffer* target = pass.target != None ? m_Resources[pass.target].framebuffer.get() : nullptr;
+        uint32_t framebuffer = target ? target->GetID() : initialFramebuffer;
+        if (framebuffer != StateManager::GetFramebuffer()) {
+            StateManager::BindFramebuffer(framebuffer);
+            if (target)
+                glViewport(0, 0, static_cast<GLsizei>(target->GetWidth()), static_cast<GLsizei>(target->GetHeight()));
+            else
+                glViewport(initialViewport[0], initialViewport[1], initialViewport[2], initialViewport[3]);
+            viewportChanged = true;
+            m_Stats.framebufferBinds++;
+        }
+        if (pass.clear) {
+            // A masked depth buffer would not clear
+            StateManager::SetDepthMask(true);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+            m_Stats.clears++;
+        }
+
+        for (uint32_t resource : pass.reads) {
+            ResourceNode& node = m_Resources[resource];
+            if (!node.unresolved) continue;
+            node.framebuffer->Resolve();
+            node.unresolved = false;
+            m_Stats.resolves++;
+        }
+
+        GPUScope scope(pass.pass->GetName());
+        pass.pass->Execute(context);
+        if (target && target->GetSpecification().samples > 1) m_Resources[pass.target].unresolved = true;
+    }
+
+    // Imports are read by whoever owns them, leave them resolved
+    for (ResourceNode& node : m_Resources) {
+        if (!node.imported || !node.unresolved) continue;
+        node.framebuffer->Resolve();
+        m_Stats.resolves++;
+    }
+    m_Pool.EndFrame();
+    m_Stats.pooledTargets = m_Pool.GetStats().targets;
+    m_Stats.pooledBytes = m_Pool.GetStats().bytes;
+
+    StateManager::BindFramebuffer(initialFramebuffer);
+    if (viewportChanged) glViewport(initialViewport[0], initialViewport[1], initialViewport[2], initialViewport[3]);
+}
+
+} // namespace Kosmic::Renderer
@@ -0,0 +1,449 @@
+#include "Kosmic/Renderer/RenderQueue.hpp"
+#include "Kosmic/Renderer/Mesh.hpp"
+#include "Kosmic/Renderer/GeometryPool.hpp"
+#include "Kosmic/Renderer/Shader.hpp"
+#include "Kosmic/Renderer/StateManager.hpp"
+#include "Kosmic/Renderer/RenderStats.hpp"
+#include "Kosmic/Renderer/UniformBuffer.hpp"
+#include "Kosmic/Renderer/OcclusionCulling.hpp"
+#include "Kosmic/Renderer/OcclusionQueries.hpp"
+#include "Kosmic/Assets/Material.hpp"
+#include "Kosmic/Core/Profiler.hpp"
+#include <GL/glew.h>
+#include <algorithm>
+#include <bit>
+
+namespace Kosmic::Renderer {
+
+namespace {
+
+constexpr uint64_t ShaderBits   = 10;
+constexpr uint64_t MaterialBits = 16;
+constexpr uint64_t MeshBits     = 16;
+constexpr uint64_t DepthBits    = 20;
+
+constexpr uint64_t Field(uint64_t value, uint64_t bits) {
+    return value & ((uint64_t(1) << bits) - 1);
+}
+
+// Non-negative floats order like their bit patterns, so the top bits of the
+// pattern are a monotonic depth bucket that needs no near/far range
+uint64_t QuantizeDepth(float depth) {
+    depth = std::max(depth, 0.0f);
+    return std::bit_cast<uint32_t>(depth) >> (31 - DepthBits);
+}
+
+constexpr uint32_t DrawDataTexels = 5; // Model matrix columns, then the color
+constexpr GLint DrawDataUnit = TextureUnit::DrawData;
+
+// Shaders written like pooled.vert
+bool ReadsDrawData(const Shader& shader) {
+    return shader.GetUniformLocation("u_DrawData") >= 0;
+}
+
+uint32_t GetTextureID(const Assets::Material* material) {
+    return material && material->diffuseMap ? material->diffuseMap->GetID() : 0;
+}
+
+bool IsTransparent(uint64_t key) {
+    return (key >> 62) == uint64_t(RenderPassType::Transparent);
+}
+
+} // namespace
+
+RenderQueue::~RenderQueue() {
+    if (m_DrawDataTexture) {
+        glDeleteTextures(1, &m_DrawDataTexture);
+        StateManager::OnTextureDeleted(m_DrawDataTexture);
+    }
+    if (m_DrawDataBuffer) glDeleteBuffers(1, &m_DrawDataBuffer);
+    if (m_IndirectBuffer) glDeleteBuffers(1, &m_IndirectBuffer);
+}
+
+uint64_t RenderQueue::MakeKey(RenderPassType pass, uint32_t shaderID, uint32_t materialID,
+                              uint32_t meshID, float viewDepth) {
+    uint64_t key = uint64_t(pass) << 62;
+    uint64_t depth = QuantizeDepth(viewDepth);
+
+    if (pass == RenderPassType::Transparent) {
+        // Blending needs back-to-front, so depth wins over state here
+        key |= Field(~depth, DepthBits) << (ShaderBits + MaterialBits + MeshBits);
+        key |= Field(shaderID, ShaderBits) << (MaterialBits + MeshBits);
+        key |= Field(materialID, MaterialBits) << MeshBits;
+        key |= Field(meshID, MeshBits);
+    } else {
+        // IDs only group draws, a wrapped ID costs a bind but is never wrong
+        key |= Field(shaderID, ShaderBits) << (MaterialBits + MeshBits + DepthBits);
+        key |= Field(materialID, MaterialBits) << (MeshBits + DepthBits);
+        key |= Field(meshID, MeshBits) << DepthBits;
+        key |= Field(depth, DepthBits);
+    }
+    return key;
+}
+
+void RenderQueue::Submit(Mesh& mesh, const Assets::Material* material, Shader& shader,
+                         const Math::Mat4& transform, float viewDepth) {
+    RenderPassType pass = material && material->IsTransparent() ? RenderPassType::Transparent
+                                                                : RenderPassType::Opaque;
+    uint64_t key = MakeKey(pass, shader.GetID(), material ? material->GetID() : 0, mesh.GetID(), viewDepth);
+
+    m_Keys.emplace_back(key, static_cast<uint32_t>(m_Packets.size()));
+    m_Packets.push_back({&mesh, material, &shader, transform, nullptr, 0});
+}
+
+void RenderQueue::SubmitInstanced(Mesh& mesh, const Assets::Material* material, Shader& shader,
+                                  const InstanceData* instances, uint32_t instanceCount) {
+    if (instanceCount == 0) return;
+    RenderPassType pass = material && material->IsTransparent() ? RenderPassType::Transparent
+                                                                : RenderPassType::Opaque;
+    // Instances are spread out, there is no single depth to sort by
+    uint64_t key = MakeKey(pass, shader.GetID(), material ? material->GetID() : 0, mesh.GetID(), 0.0f);
+
+    m_Keys.emplace_back(key, static_cast<uint32_t>(m_Packets.size()));
+    m_Packets.push_back({&mesh, material, &shader, Math::Mat4(1.0f), instances, instanceCount});
+}
+
+void RenderQueue::Cull(const Math::Frustum& frustum) {
+    KOSMIC_PROFILE_SCOPE("RenderQueue::Cull");
+    m_Spheres.Clear();
+    m_Tested.clear();
+    for (uint32_t i = 0; i < m_Keys.size(); ++i) {
+        const DrawPacket& packet = m_Packets[m_Keys[i].second];
+        if (packet.instanceCount > 0) continue;
+        m_Spheres.Push(packet.mesh->GetBoundingSphere().Transformed(packet.transform));
+        m_Tested.push_back(i);
+    }
+
+    m_Visibility.resize(m_Spheres.Size());
+    uint32_t visible = Culling::CullSpheres(frustum, m_Spheres, 0, m_Spheres.Size(), m_Visibility.data());
+    m_Stats.visible += visible;
+    m_Stats.culled += m_Spheres.Size() - visible;
+    if (visible < m_Spheres.Size()) EraseHidden();
+}
+
+void RenderQueue::CullOccluded(OcclusionCuller& culler) {
+    KOSMIC_PROFILE_SCOPE("RenderQueue::CullOccluded");
+    m_Boxes.clear();
+    m_Tested.clear();
+    for (uint32_t i = 0; i < m_Keys.size(); ++i) {
+        const DrawPacket& packet = m_Packets[m_Keys[i].second];
+        if (packet.instanceCount > 0) continue;
+        m_Boxes.push_back(packet.mesh->GetBounds().Transformed(packet.transform));
+        m_Tested.push_back(i);
+    }
+
+    uint32_t count = static_cast<uint32_t>(m_Boxes.size());
+    m_Visibility.resize(count);
+    uint32_t visible = culler.Cull(m_Boxes.data(), count, m_Visibility.data());
+    m_Stats.occluded += count - visible;
+    if (visible < count) EraseHidden();
+}
+
+void RenderQueue::CullQueried(OcclusionQueries& queries) {
+    KOSMIC_PROFILE_SCOPE("RenderQueue::CullQueried");
+    m_Tested.clear();
+    m_Visibility.clear();
+    m_Conditions.assign(m_Packets.size(), 0);
+    uint32_t hidden = 0;
+    for (uint32_t i = 0; i < m_Keys.size(); ++i) {
+        const auto& [key, index] = m_Keys[i];
+        const DrawPacket& packet = m_Packets[index];
+        // Transparent draws leave no depth to query against, and still get drawn
+        if (packet.instanceCount > 0 || IsTransparent(key)) continue;
+
+        auto visibility = queries.Classify(index, packet.mesh->GetID(),
+                                           packet.mesh->GetBounds().Transformed(packet.transform));
+        if (visibility == OcclusionQueries::Visibility::Conditional)
+            m_Conditions[index] = queries.GetCondition(index);
+        m_Tested.push_back(i);
+        m_Visibility.push_back(visibility != OcclusionQueries::Visibility::Hidden);
+        hidden += visibility == OcclusionQueries::Visibility::Hidden;
+    }
+
+    m_Stats.occluded += hidden;
+    RenderStats& stats = RenderStatistics::GetCurrent();
+    stats.occlusionTested += static_cast<uint32_t>(m_Tested.size());
+    stats.occludedObjects += hidden;
+    if (hidden > 0) EraseHidden();
+}
+
+void RenderQueue::EraseHidden() {
+    // No real key has every bit set (the pass field never reaches 3)
+    constexpr uint64_t Culled = UINT64_MAX;
+    for (uint32_t i = 0; i < m_Tested.size(); ++i) {
+        if (!m_Visibility[i])
+            m_Keys[m_Tested[i]].first = Culled;
+    }
+    std::erase_if(m_Keys, [](const auto& entry) { return entry.first == Culled; });
+}
+
+void RenderQueue::Sort() {
+    KOSMIC_PROFILE_SCOPE("RenderQueue::Sort");
+    std::sort(m_Keys.begin(), m_Keys.end());
+}
+
+void RenderQueue::PreparePooledDraws() {
+    m_Commands.clear();
+    m_DrawData.clear();
+
+    const Shader* shader = nullptr;
+    bool readsDrawData = false;
+    for (const auto& [key, index] : m_Keys) {
+        const DrawPacket& packet = m_Packets[index];
+        if (packet.shader != shader) {
+            shader = packet.shader;
+            readsDrawData = ReadsDrawData(*shader);
+        }
+        if (!readsDrawData || packet.instanceCount > 0 || !packet.mesh->IsPooled()) continue;
+
+        if (!m_DrawDataBuffer) {
+            // 3.3 only promises 65536 texels, most drivers allow far more
+            GLint maxTexels = 0;
+            glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+            m_DrawWindow = std::min(GeometryPool::MaxDrawIDs, static_cast<uint32_t>(maxTexels) / DrawDataTexels);
+
+            glGenBuffers(1, &m_DrawDataBuffer);
+            glGenBuffers(1, &m_IndirectBuffer);
+            glGenTextures(1, &m_DrawDataTexture);
+            glBindBuffer(GL_TEXTURE_BUFFER, m_DrawDataBuffer);
+            glBufferData(GL_TEXTURE_BUFFER, size_t(m_DrawWindow) * DrawDataTexels * sizeof(Math::Vector4), nullptr,
+                         GL_STREAM_DRAW);
+            StateManager::BindTexture(DrawDataUnit, m_DrawDataTexture, GL_TEXTURE_BUFFER);
+            glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_DrawDataBuffer);
+            glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        }
+
+        const Mesh& mesh = *packet.mesh;
+        uint32_t draw = static_cast<uint32_t>(m_Commands.size());
+        m_Commands.push_back({mesh.GetIndexCount(), 1, mesh.GetFirstIndex(),
+                              static_cast<int32_t>(mesh.GetBaseVertex()), draw % m_DrawWindow});
+
+        for (int column = 0; column < 4; ++column) {
+            const auto& values = packet.transform[column];
+            m_DrawData.emplace_back(values.x, values.y, values.z, values.w);
+        }
+        const Assets::Material* material = packet.material;
+        if (material)
+            m_DrawData.emplace_back(material->diffuse.x, material->diffuse.y, material->diffuse.z, material->opacity);
+        else
+            m_DrawData.emplace_back(1.0f, 1.0f, 1.0f, 1.0f);
+    }
+}
+
+void RenderQueue::UploadDrawData(uint32_t first) {
+    uint32_t start = first - first % m_DrawWindow;
+    uint32_t count = std::min(m_DrawWindow, static_cast<uint32_t>(m_Commands.size()) - start);
+    size_t capacity = size_t(m_DrawWindow) * DrawDataTexels * sizeof(Math::Vector4);
+
+    // Orphaned first, draws still reading the previous window keep their data
+    glBindBuffer(GL_TEXTURE_BUFFER, m_DrawDataBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, size_t(count) * DrawDataTexels * sizeof(Math::Vector4),
+                    m_DrawData.data() + size_t(start) * DrawDataTexels);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    RenderStatistics::GetCurrent().bufferBytes += size_t(count) * DrawDataTexels * sizeof(Math::Vector4);
+}
+
+void RenderQueue::Execute() {
+    KOSMIC_PROFILE_SCOPE("RenderQueue::Execute");
+
+    PreparePooledDraws();
+    bool pooledDraws = !m_Commands.empty();
+    bool multiDraw = pooledDraws && GeometryPool::UseMultiDrawIndirect();
+    if (pooledDraws) StateManager::BindTexture(DrawDataUnit, m_DrawDataTexture, GL_TEXTURE_BUFFER);
+    if (multiDraw) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, m_Commands.size() * sizeof(DrawCommand), m_Commands.data(),
+                     GL_STREAM_DRAW);
+        RenderStatistics::GetCurrent().bufferBytes += m_Commands.size() * sizeof(DrawCommand);
+    }
+
+    Shader* boundShader = nullptr;
+    GLint modelLocation = -1, colorLocation = -1, drawBaseLocation = -1;
+    bool readsDrawData = false;
+    uint32_t boundVAO = 0;
+    const Assets::Material* boundMaterial = nullptr;
+    bool materialValid = false; // nullptr is a valid material, so track it separately
+    uint32_t boundTexture = UINT32_MAX;
+    bool blending = false;
+    uint32_t nextDraw = 0;      // Pooled draws come up in the order PreparePooledDraws saw them
+    uint32_t windowEnd = 0;     // End of the uploaded draw data
+    uint64_t triangles = 0;
+    uint32_t instancedDraws = 0;
+
+    for (size_t i = 0; i < m_Keys.size(); ++i) {
+        const DrawPacket& packet = m_Packets[m_Keys[i].second];
+
+        bool transparent = IsTransparent(m_Keys[i].first);
+        if (transparent != blending) {
+            blending = transparent;
+            StateManager::SetBlend(blending);
+            if (blending) StateManager::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            StateManager::SetDepthMask(!blending);
+        }
+
+        if (packet.shader != boundShader) {
+            boundShader = packet.shader;
+            boundShader->Bind();
+            boundShader->SetInt("u_Texture", 0);
+            modelLocation = boundShader->GetUniformLocation("model");
+            colorLocation = boundShader->GetUniformLocation("u_Color");
+            readsDrawData = ReadsDrawData(*boundShader);
+            if (readsDrawData) {
+                // u_DrawData was pointed at DrawDataUnit when the program was linked
+                drawBaseLocation = boundShader->GetUniformLocation("u_DrawBase");
+                boundShader->SetInt(drawBaseLocation, 0);
+                // The color comes with the draw data
+                boundShader->SetVec4(colorLocation, Math::Vector4(1.0f, 1.0f, 1.0f, 1.0f));
+            }
+            // Uniforms are per program, the material has to be set again
+            materialValid = false;
+            m_Stats.shaderBinds++;
+        }
+
+        if (readsDrawData && packet.instanceCount == 0 && packet.mesh->IsPooled()) {
+            uint32_t texture = GetTextureID(packet.material);
+            if (texture != boundTexture) {
+                StateManager::BindTexture(0, texture);
+                boundTexture = texture;
+                m_Stats.textureBinds++;
+            }
+            if (packet.mesh->GetVAO() != boundVAO) {
+                boundVAO = packet.mesh->GetVAO();
+                packet.mesh->Bind();
+                m_Stats.meshBinds++;
+            }
+            if (nextDraw >= windowEnd) {
+                UploadDrawData(nextDraw);
+                windowEnd = std::min(nextDraw - nextDraw % m_DrawWindow + m_DrawWindow,
+                                     static_cast<uint32_t>(m_Commands.size()));
+            }
+
+            // Take every following draw that needs no state change. A
+            // conditional draw goes out on its own.
+            uint32_t condition = GetCondition(m_Keys[i].second);
+            size_t end = i + 1;
+            while (condition == 0 && end < m_Keys.size() && nextDraw + (end - i) < windowEnd) {
+                const DrawPacket& next = m_Packets[m_Keys[end].second];
+                if (next.shader != boundShader || next.instanceCount > 0 || !next.mesh->IsPooled() ||
+                    GetCondition(m_Keys[end].second) != 0 ||
+                    next.mesh->GetVAO() != boundVAO || GetTextureID(next.material) != texture ||
+                    IsTransparent(m_Keys[end].first) != blending)
+                    break;
+                end++;
+            }
+            uint32_t count = static_cast<uint32_t>(end - i);
+            for (uint32_t draw = nextDraw; draw < nextDraw + count; ++draw)
+                triangles += m_Commands[draw].indexCount / 3;
+
+            GLenum indexType = packet.mesh->GetGLIndexType();
+            if (condition) glBeginConditionalRender(condition, GL_QUERY_NO_WAIT);
+            if (multiDraw) {
+                glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, (void*)(size_t(nextDraw) * sizeof(DrawCommand)),
+                                            static_cast<GLsizei>(count), 0);
+                m_Stats.drawCalls++;
+                m_Stats.multiDraws++;
+            } else {
+                // No base instance here, so the draw ID goes in a uniform
+                size_t indexSize = static_cast<size_t>(packet.mesh->GetIndexType());
+                for (uint32_t draw = nextDraw; draw < nextDraw + count; ++draw) {
+                    const DrawCommand& command = m_Commands[draw];
+                    boundShader->SetInt(drawBaseLocation, static_cast<int>(command.baseInstance));
+                    glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(command.indexCount), indexType,
+                                             (void*)(command.firstIndex * indexSize), command.baseVertex);
+                }
+                m_Stats.drawCalls += count;
+            }
+            if (condition) {
+                glEndConditionalRender();
+                m_Stats.conditional++;
+            }
+            m_Stats.draws += count;
+            m_Stats.pooledDraws += count;
+            nextDraw += count;
+            i = end - 1;
+            continue;
+        }
+
+        if (!materialValid || packet.material != boundMaterial) {
+            const Assets::Material* material = packet.material;
+            if (material)
+                boundShader->SetVec4(colorLocation, Math::Vector4(material->diffuse.x, material->diffuse.y,
+                                                                  material->diffuse.z, material->opacity));
+            else
+                boundShader->SetVec4(colorLocation, Math::Vector4(1.0f, 1.0f, 1.0f, 1.0f));
+
+            uint32_t texture = GetTextureID(material);
+            if (texture != boundTexture) {
+                StateManager::BindTexture(0, texture);
+                boundTexture = texture;
+                m_Stats.textureBinds++;
+            }
+
+            boundMaterial = material;
+            materialValid = true;
+            m_Stats.materialBinds++;
+        }
+
+        if (packet.instanceCount > 0)
+            packet.mesh->SetInstanceData(packet.instances, packet.instanceCount);
+
+        // Pooled meshes share their page's VAO, switching between them is free
+        const Mesh& mesh = *packet.mesh;
+        if (mesh.GetVAO() != boundVAO) {
+            boundVAO = mesh.GetVAO();
+            mesh.Bind();
+            m_Stats.meshBinds++;
+        }
+
+        GLsizei indexCount = static_cast<GLsizei>(mesh.GetIndexCount());
+        GLenum indexType = mesh.GetGLIndexType();
+        const void* indices = (void*)(size_t(mesh.GetFirstIndex()) * static_cast<size_t>(mesh.GetIndexType()));
+        GLint baseVertex = static_cast<GLint>(mesh.GetBaseVertex());
+        if (packet.instanceCount > 0) {
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, indexCount, indexType, indices,
+                                              static_cast<GLsizei>(packet.instanceCount), baseVertex);
+            m_Stats.instances += packet.instanceCount;
+            triangles += uint64_t(indexCount / 3) * packet.instanceCount;
+            instancedDraws++;
+        } else {
+            boundShader->SetMat4(modelLocation, packet.transform);
+            // Skipped by the GPU if the query waited on found it hidden
+            uint32_t condition = GetCondition(m_Keys[i].second);
+            if (condition) glBeginConditionalRender(condition, GL_QUERY_NO_WAIT);
+            glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, indexType, indices, baseVertex);
+            if (condition) {
+                glEndConditionalRender();
+                m_Stats.conditional++;
+            }
+            triangles += indexCount / 3;
+        }
+        m_Stats.draws++;
+        m_Stats.drawCalls++;
+    }
+
+    // Leave the defaults the rest of the renderer expects; bindings stay,
+    // StateManager knows about them
+    if (blending) {
+        StateManager::SetBlend(false);
+        StateManager::SetDepthMask(true);
+    }
+    if (multiDraw) glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    RenderStats& stats = RenderStatistics::GetCurrent();
+    stats.drawCalls += m_Stats.drawCalls;
+    stats.triangles += triangles;
+    stats.instances += m_Stats.instances;
+    // Instanced draws were culled upstream, their instances are what is visible
+    stats.visibleObjects += m_Stats.draws - instancedDraws + m_Stats.instances;
+    stats.culledObjects += m_Stats.culled;
+}
+
+void RenderQueue::Clear() {
+    m_Packets.clear();
+    m_Keys.clear();
+    m_Conditions.clear();
+    m_Stats = {};
+}
+
+} // namespace Kosmic::Renderer
@@ -0,0 +1,44 @@
+#include "Kosmic/Renderer/RenderStats.hpp"
+#include <algorithm>
+#include <array>
+
+namespace Kosmic::Renderer {
+
+namespace {
+
+struct StatsState {
+    RenderStats current;
+    std::array<RenderStats, RenderStatistics::HistorySize> history{};
+    uint32_t next{0};   // Slot EndFrame writes to
+    uint32_t count{0};
+};
+
+StatsState s_State;
+
+} // namespace
+
+RenderStats& RenderStatistics::GetCurrent() {
+    return s_State.current;
+}
+
+void RenderStatistics::EndFrame() {
+    s_State.history[s_State.next] = s_State.current;
+    s_State.next = (s_State.next + 1) % HistorySize;
+    s_State.count = std::min(s_State.count + 1, HistorySize);
+    s_State.current = {};
+}
+
+const RenderStats& RenderStatistics::GetLast() {
+    return GetHistory(0);
+}
+
+const RenderStats& RenderStatistics::GetHistory(uint32_t framesAgo) {
+    framesAgo = std::min(framesAgo, HistorySize - 1);
+    return s_State.history[(s_State.next + HistorySize - 1 - framesAgo) % HistorySize];
+}
+
+uint32_t RenderStatistics::GetHistoryCount() {
+    return s_State.count;
+}
+
+} // namespace Kosmic::Renderer
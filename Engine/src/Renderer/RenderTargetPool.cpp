@@ -0,0 +1,89 @@
+#include "Kosmic/Renderer/RenderTargetPool.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include <algorithm>
+
+namespace Kosmic::Renderer {
+
+std::shared_ptr<Framebuffer> RenderTargetPool::Acquire(const FramebufferSpecification& specification) {
+    m_Frame.acquired++;
+
+    // Best is a free target already at this size, then the smallest one
+    // whose allocation holds it, then any other one, reallocated
+    Entry* exact = nullptr;
+    Entry* larger = nullptr;
+    Entry* idle = nullptr;
+    for (Entry& entry : m_Entries) {
+        if (entry.acquired) continue;
+        const Framebuffer& framebuffer = *entry.framebuffer;
+        if (!entry.specification.IsCompatible(specification)) continue;
+
+        if (framebuffer.GetWidth() == specification.width && framebuffer.GetHeight() == specification.height) {
+            exact = &entry;
+            break;
+        }
+        // Resizing a target handed out earlier this frame would change it
+        // under whoever had it
+        if (entry.usedThisFrame) continue;
+
+        size_t allocated = size_t(framebuffer.GetAllocatedWidth()) * framebuffer.GetAllocatedHeight();
+        // Same limit as Framebuffer::Resize, beyond it the resize reallocates
+        bool fits = framebuffer.GetAllocatedWidth() >= specification.width &&
+                    framebuffer.GetAllocatedHeight() >= specification.height &&
+                    allocated <= size_t(specification.width) * specification.height * 4;
+        if (fits && (!larger || allocated < size_t(larger->framebuffer->GetAllocatedWidth()) *
+                                                larger->framebuffer->GetAllocatedHeight()))
+            larger = &entry;
+        if (!idle) idle = &entry;
+    }
+
+    Entry* entry = exact ? exact : larger ? larger : idle;
+    if (entry) {
+        if (entry != exact) {
+            if (entry != larger) m_Frame.resized++;
+            entry->framebuffer->Resize(specification.width, specification.height);
+        }
+    } else {
+        m_Entries.push_back({specification, Framebuffer::Create(specification)});
+        entry = &m_Entries.back();
+        m_Frame.created++;
+    }
+    entry->acquired = true;
+    entry->usedThisFrame = true;
+    entry->idleFrames = 0;
+    return entry->framebuffer;
+}
+
+void RenderTargetPool::Release(const std::shared_ptr<Framebuffer>& framebuffer) {
+    for (Entry& entry : m_Entries) {
+        if (entry.framebuffer != framebuffer) continue;
+        entry.acquired = false;
+        return;
+    }
+    KOSMIC_WARN("RenderTargetPool: released a framebuffer it does not own");
+}
+
+void RenderTargetPool::EndFrame() {
+    for (Entry& entry : m_Entries) {
+        if (!entry.usedThisFrame) entry.idleFrames++;
+        entry.acquired = false;
+        entry.usedThisFrame = false;
+    }
+    std::erase_if(m_Entries, [](const Entry& entry) { return entry.idleFrames > MaxIdleFrames; });
+
+    m_Frame.targets = static_cast<uint32_t>(m_Entries.size());
+    for (const Entry& entry : m_Entries) {
+        const Framebuffer& framebuffer = *entry.framebuffer;
+        m_Frame.bytes += framebuffer.GetSpecification().GetSize(framebuffer.GetAllocatedWidth(),
+                                                                framebuffer.GetAllocatedHeight());
+    }
+    m_Stats = m_Frame;
+    m_Frame = {};
+}
+
+void RenderTargetPool::Clear() {
+    m_Entries.clear();
+    m_Frame = {};
+    m_Stats = {};
+}
+
+} // namespace Kosmic::Renderer
@@ -3,62 +3,78 @@
 #include "Kosmic/Renderer/Mesh.hpp"
 #include "Kosmic/Renderer/StateManager.hpp"
 #include "Kosmic/Core/Logging.hpp"
+#include "Kosmic/Core/Profiler.hpp"
 #include "Kosmic/Renderer/Framebuffer.hpp"
 #include "Kosmic/Renderer/RendererAPI.hpp"
 #include "Kosmic/Renderer/OpenGLRendererAPI.hpp"
+#include "Kosmic/Renderer/GPUProfiler.hpp"
+#include "Kosmic/Renderer/RenderQueue.hpp"
+#include "Kosmic/Renderer/UniformBuffer.hpp"
+#include "Kosmic/Assets/Material.hpp"
 #include <iostream>
 #include <cstdint>
 
 namespace Kosmic::Renderer {
 
-// Store the last GPU time in nanoseconds
-static uint64_t s_LastGPUTime = 0;
+namespace {
+
+// GPU scope around Render, what GetLastGPUTime reports
+constexpr const char* RenderScopeName = "Renderer3D::Render";
+
+} // namespace
 
 class Renderer3D::Impl {
 public:
     std::shared_ptr<Shader> shader;
+    std::shared_ptr<Shader> instancedShader;
+    std::shared_ptr<Shader> pooledShader;
     std::shared_ptr<Mesh> mesh;
     std::shared_ptr<Camera> camera;
-    GLuint queryID = 0;      // OpenGL query object for GPU timing
-    uint64_t gpuTime = 0;    // Last measured GPU time (ns)
     // Procedural sky
     std::shared_ptr<Shader> skyShader;
     std::shared_ptr<Mesh> skyMesh;
+    // Draws submitted this frame
+    RenderQueue queue;
+    RenderQueueStats lastStats;
+    // Shared uniform blocks, see UniformBuffer.hpp
+    std::unique_ptr<UniformBuffer> cameraBuffer;
+    std::unique_ptr<UniformBuffer> lightingBuffer;
+    LightingUniforms lighting{};
+    bool lightingDirty{true};
+    // Point and spot lights submitted this frame
+    LightClusters lights;
+    OcclusionCuller occlusion;
+    OcclusionQueries queries;
+    GPUCulling gpuCulling;
 };
 
 Renderer3D::Renderer3D() : pImpl(std::make_unique<Impl>()) {
     m_RenderGraph = std::make_shared<RenderGraph>();
 }
 
-Renderer3D::~Renderer3D() {
-    if (pImpl->queryID)
-        glDeleteQueries(1, &pImpl->queryID);
-}
+Renderer3D::~Renderer3D() = default;
 
 void Renderer3D::Init() {
     // Initialize the RendererAPI using OpenGL
     GetOpenGLRendererAPI()->Init();
     
-    // Create and configure shader
+    // Create shader
     pImpl->shader = Shader::CreateBasicShader();
-    pImpl->shader->Bind();
-    
+    pImpl->instancedShader = Shader::CreateInstancedShader();
+    pImpl->pooledShader = Shader::CreatePooledShader();
+
+    // Camera and lights live in uniform buffers shared by every program
+    pImpl->cameraBuffer = std::make_unique<UniformBuffer>(sizeof(CameraUniforms), UniformBinding::Camera);
+    pImpl->lightingBuffer = std::make_unique<UniformBuffer>(sizeof(LightingUniforms), UniformBinding::Lighting);
+
     // Set default lighting parameters
-    pImpl->shader->SetVec3("u_AmbientLightColor", Math::Vector3(1.0f));
-    pImpl->shader->SetFloat("u_AmbientLightIntensity", 0.7f);
-    pImpl->shader->SetVec3("u_DirLightDirection", Math::Vector3(-0.2f, -1.0f, -0.3f));
-    pImpl->shader->SetVec3("u_DirLightColor", Math::Vector3(1.0f));
-    pImpl->shader->SetFloat("u_DirLightIntensity", 0.3f);
-    
-    pImpl->shader->Unbind();
+    SetAmbientLight({Math::Vector3(1.0f), 0.7f});
+    SetDirectionalLight({Math::Vector3(-0.2f, -1.0f, -0.3f), Math::Vector3(1.0f), 0.3f});
     
     // Create sky shader and sky mesh (a sphere used for sky dome)
     pImpl->skyShader = Shader::CreateSkyShader();
     pImpl->skyMesh   = MeshLibrary::Sphere();
     
-    // Create OpenGL query object for GPU timing
-    glGenQueries(1, &pImpl->queryID);
-    
     // Set default clear color to dark gray
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     
@@ -72,12 +88,107 @@ void Renderer3D::Init() {
     // Initialize StateManager defaults:
     StateManager::SetCullFace(true);
     StateManager::SetDepthTest(true);
+
+    // The sky clears the output, the scene draws over it. "Output" is
+    // imported every frame, see Render.
+    m_RenderGraph->AddPass("Sky",
+        [](RenderGraphBuilder& builder) { builder.Write("Output", LoadOp::Clear); },
+        [this](const RenderGraphContext&) { RenderSky(); });
+    m_RenderGraph->AddPass("Scene",
+        [](RenderGraphBuilder& builder) { builder.Write("Output"); },
+        [this](const RenderGraphContext&) { RenderScene(); });
 }
 
 void Renderer3D::SetMesh(const std::shared_ptr<Mesh>& mesh) {
     pImpl->mesh = mesh;
 }
 
+void Renderer3D::Submit(const std::shared_ptr<Mesh>& mesh, const std::shared_ptr<Assets::Material>& material,
+                        const Math::Mat4& transform) {
+    if (!mesh) return;
+    // Pooled meshes batch into multi-draws with the draw data shader
+    Shader& shader = material && material->shader ? *material->shader
+                   : mesh->IsPooled()             ? *pImpl->pooledShader
+                                                  : *pImpl->shader;
+
+    float viewDepth = 0.0f;
+    if (pImpl->camera) {
+        const Math::Vector3& eye = pImpl->camera->GetPosition();
+        const Math::Vector3& front = pImpl->camera->GetFront();
+        Math::Vector3 toObject(transform[3].x - eye.x, transform[3].y - eye.y, transform[3].z - eye.z);
+        viewDepth = toObject.x * front.x + toObject.y * front.y + toObject.z * front.z;
+    }
+    pImpl->queue.Submit(*mesh, material.get(), shader, transform, viewDepth);
+}
+
+void Renderer3D::SubmitInstanced(const std::shared_ptr<Mesh>& mesh, const std::shared_ptr<Assets::Material>& material,
+                                 const InstanceData* instances, uint32_t count) {
+    if (!mesh || count == 0) return;
+    if (m_GPUCulling && !(material && (material->shader || material->IsTransparent()))) {
+        pImpl->gpuCulling.Submit(*mesh, material.get(), instances, count);
+        return;
+    }
+    Shader& shader = material && material->shader ? *material->shader : *pImpl->instancedShader;
+    pImpl->queue.SubmitInstanced(*mesh, material.get(), shader, instances, count);
+}
+
+const RenderQueueStats& Renderer3D::GetQueueStats() const {
+    return pImpl->lastStats;
+}
+
+void Renderer3D::SetAmbientLight(const Lighting::AmbientLight& light) {
+    pImpl->lighting.ambient = {light.color.x, light.color.y, light.color.z, light.intensity};
+    pImpl->lightingDirty = true;
+}
+
+void Renderer3D::SetDirectionalLight(const Lighting::DirectionalLight& light) {
+    pImpl->lighting.lightDirection = {light.direction.x, light.direction.y, light.direction.z, 0.0f};
+    pImpl->lighting.lightColor = {light.color.x, light.color.y, light.color.z, light.intensity};
+    pImpl->lightingDirty = true;
+}
+
+void Renderer3D::SubmitPointLight(const Lighting::PointLight& light) {
+    pImpl->lights.AddPointLight(light);
+}
+
+void Renderer3D::SubmitSpotLight(const Lighting::SpotLight& light) {
+    pImpl->lights.AddSpotLight(light);
+}
+
+const LightClusterStats& Renderer3D::GetLightStats() const {
+    return pImpl->lights.GetStats();
+}
+
+void Renderer3D::SubmitOccluder(const OccluderMesh& mesh, const Math::Mat4& transform) {
+    if (m_OcclusionCulling) pImpl->occlusion.AddOccluder(mesh, transform);
+}
+
+const OcclusionStats& Renderer3D::GetOcclusionStats() const {
+    return pImpl->occlusion.GetStats();
+}
+
+void Renderer3D::SetOcclusionQueries(bool enabled) {
+    if (enabled == m_OcclusionQueries) return;
+    m_OcclusionQueries = enabled;
+    pImpl->queries.Reset();
+}
+
+const OcclusionQueryStats& Renderer3D::GetOcclusionQueryStats() const {
+    return pImpl->queries.GetStats();
+}
+
+void Renderer3D::SetGPUCulling(bool enabled) {
+    if (enabled && !GPUCulling::IsSupported()) {
+        KOSMIC_WARN("GPU culling needs OpenGL 4.3 with vertex shader storage buffers, culling on the CPU");
+        enabled = false;
+    }
+    m_GPUCulling = enabled;
+}
+
+const GPUCullingStats& Renderer3D::GetGPUCullingStats() const {
+    return pImpl->gpuCulling.GetStats();
+}
+
 void Renderer3D::SetCamera(const std::shared_ptr<Camera>& camera) {
     m_Camera = camera;
     pImpl->camera = camera;
@@ -88,39 +199,79 @@ void Renderer3D::SetFramebuffer(const std::shared_ptr<Framebuffer>& framebuffer)
 }
 
 void Renderer3D::RenderSky() {
+    KOSMIC_PROFILE_SCOPE("Renderer3D::RenderSky");
+
     // Disable depth writing
-    glDepthMask(GL_FALSE);
+    StateManager::SetDepthMask(false);
     // Set face culling to render inside of the cube
-    glCullFace(GL_FRONT);
+    StateManager::SetCullMode(GL_FRONT);
     
+    // Matrices come from the Camera uniform block
     pImpl->skyShader->Bind();
-    pImpl->skyShader->SetMat4("view", pImpl->camera->GetViewMatrixNoTranslation());
-    pImpl->skyShader->SetMat4("projection", pImpl->camera->GetSkyboxProjectionMatrix());
-    
     pImpl->skyMesh->Draw();
     
-    pImpl->skyShader->Unbind();
-    
     // Restore default culling order
-    glCullFace(GL_BACK);
+    StateManager::SetCullMode(GL_BACK);
     // Re-enable depth writing
-    glDepthMask(GL_TRUE);
+    StateManager::SetDepthMask(true);
 }
 
 void Renderer3D::Render() {
-    // If a custom framebuffer is set, bind it before rendering
-    if(m_Framebuffer)
-        m_Framebuffer->Bind();
-    
-    // Begin GPU timing query
-    glBeginQuery(GL_TIME_ELAPSED, pImpl->queryID);
-    
-    // Clear buffers using RendererAPI
-    GetOpenGLRendererAPI()->Clear();
-    
-    // Render procedural sky first
-    RenderSky();
-    
+    KOSMIC_PROFILE_SCOPE("Renderer3D::Render");
+    // GPU timing is resolved a few frames later, see GPUProfiler
+    GPUScope gpuScope(RenderScopeName);
+
+    // Per-frame uniforms, shared by the scene and sky programs
+    CameraUniforms cameraData{
+        pImpl->camera->GetViewMatrix(),
+        pImpl->camera->GetProjectionMatrix(),
+        pImpl->camera->GetSkyboxProjectionMatrix(),
+        {pImpl->camera->GetPosition().x, pImpl->camera->GetPosition().y, pImpl->camera->GetPosition().z, 1.0f}
+    };
+    pImpl->cameraBuffer->SetData(&cameraData, sizeof(cameraData));
+
+    // Clusters cover the viewport the graph will render at
+    uint32_t width = 0, height = 0;
+    if (m_Framebuffer) {
+        width = m_Framebuffer->GetWidth();
+        height = m_Framebuffer->GetHeight();
+    } else {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        width = static_cast<uint32_t>(viewport[2]);
+        height = static_cast<uint32_t>(viewport[3]);
+    }
+    LightClusters& lights = pImpl->lights;
+    lights.Build(*pImpl->camera, width, height);
+    const Math::Vector4& clusterScale = lights.GetClusterScale();
+    LightingUniforms& lighting = pImpl->lighting;
+    if (clusterScale.x != lighting.clusterScale.x || clusterScale.y != lighting.clusterScale.y ||
+        clusterScale.z != lighting.clusterScale.z || clusterScale.w != lighting.clusterScale.w) {
+        lighting.clusterScale = clusterScale;
+        lighting.clusterGrid[0] = LightClusters::TilesX;
+        lighting.clusterGrid[1] = LightClusters::TilesY;
+        lighting.clusterGrid[2] = LightClusters::Slices;
+        pImpl->lightingDirty = true;
+    }
+    // Occluders are rasterized before the graph runs, the scene pass tests against them
+    if (m_OcclusionCulling)
+        pImpl->occlusion.Render(cameraData.projection * cameraData.view);
+
+    if (pImpl->lightingDirty) {
+        pImpl->lightingBuffer->SetData(&pImpl->lighting, sizeof(LightingUniforms));
+        pImpl->lightingDirty = false;
+    }
+
+    // Null renders into whatever is bound, usually the window. The graph
+    // binds and clears it, and puts the previous binding back afterwards.
+    m_RenderGraph->ImportFramebuffer("Output", m_Framebuffer);
+    m_RenderGraph->Execute();
+    lights.Clear();
+}
+
+void Renderer3D::RenderScene() {
+    KOSMIC_PROFILE_SCOPE("Renderer3D::RenderScene");
+    pImpl->lights.Bind();
     pImpl->shader->Bind();
     
     // Set default white color for objects without texture
@@ -128,30 +279,50 @@ void Renderer3D::Render() {
     
     // Set texture uniform
     pImpl->shader->SetInt("u_Texture", 0);
-    pImpl->shader->SetMat4("view", pImpl->camera->GetViewMatrix());
-    pImpl->shader->SetMat4("projection", pImpl->camera->GetProjectionMatrix());
     
     if(pImpl->mesh) { // Render provided mesh
         pImpl->shader->SetMat4("model", pImpl->mesh->GetTransform());
         pImpl->mesh->Draw();
     }
-    
-    pImpl->shader->Unbind();
-    
-    m_RenderGraph->Execute();
 
-    // End GPU timing query
-    glEndQuery(GL_TIME_ELAPSED);
-    glGetQueryObjectui64v(pImpl->queryID, GL_QUERY_RESULT, &pImpl->gpuTime);
-    s_LastGPUTime = pImpl->gpuTime; // Update global GPU time
-    
-    // If a custom framebuffer was bound, unbind to render to default framebuffer
-    if(m_Framebuffer)
-        m_Framebuffer->Unbind();
+    // Submitted draws, culled, then sorted by state and depth
+    if (m_FrustumCulling)
+        pImpl->queue.Cull(pImpl->camera->GetFrustum());
+    if (m_OcclusionCulling && pImpl->occlusion.HasOccluders())
+        pImpl->queue.CullOccluded(pImpl->occlusion);
+    if (m_OcclusionQueries) {
+        pImpl->queries.BeginFrame(pImpl->camera->GetPosition(), pImpl->camera->GetNearPlane());
+        pImpl->queue.CullQueried(pImpl->queries);
+    }
+    pImpl->queue.Sort();
+    // GPU-culled instances are opaque, they go first
+    GPUCulling& gpuCulling = pImpl->gpuCulling;
+    if (gpuCulling.HasBatches()) {
+        gpuCulling.Cull(pImpl->camera->GetFrustum());
+        gpuCulling.Draw();
+    }
+    pImpl->queue.Execute();
+    // Against this frame's depth, read back on a later frame
+    if (m_OcclusionQueries)
+        pImpl->queries.IssueQueries();
+    // Next frame's instances are tested against this frame's depth
+    if (m_GPUCulling)
+        gpuCulling.UpdateDepthPyramid(pImpl->camera->GetProjectionMatrix() * pImpl->camera->GetViewMatrix());
+    gpuCulling.Clear();
+    pImpl->lastStats = pImpl->queue.GetStats();
+    pImpl->queue.Clear();
 }
 
 uint64_t Renderer3D::GetLastGPUTime() {
-    return s_LastGPUTime;
+    // Only the renderer's own scopes; the frame also holds OnRender and ImGui
+    uint64_t time = 0;
+    for (const GPUTiming& timing : GPUProfiler::GetLatest().scopes)
+        if (timing.name == RenderScopeName) time += timing.time;
+    return time;
+}
+
+const GPUFrameTimings& Renderer3D::GetLastGPUTimings() {
+    return GPUProfiler::GetLatest();
 }
 
 std::shared_ptr<Shader> Renderer3D::GetShader() {
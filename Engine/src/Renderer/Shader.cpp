@@ -2,9 +2,15 @@
 #include "Kosmic/Renderer/Shader.hpp"
 #include <SDL2/SDL_opengl.h>
 #include "Kosmic/Core/Logging.hpp"
+#include "Kosmic/Core/Profiler.hpp"
+#include "Kosmic/Renderer/UniformBuffer.hpp"
+#include "Kosmic/Renderer/StateManager.hpp"
+#include "Kosmic/Renderer/RenderStats.hpp"
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <utility>
 
 namespace {
 
@@ -25,25 +31,38 @@ std::string LoadShaderSource(const std::string& filePath) {
 namespace Kosmic::Renderer {
 
 Shader::Shader(const std::string& vertexSrc, const std::string& fragmentSrc) {
+    KOSMIC_PROFILE_SCOPE("Shader::Compile");
     GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, vertexSrc);
     GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentSrc);
-    m_ShaderID = LinkProgram(vertexShader, fragmentShader);
+    m_ShaderID = LinkProgram({vertexShader, fragmentShader});
 
     // After linking the shaders, delete the objects
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
+
+    Reflect();
+}
+
+Shader::Shader(const std::string& computeSrc) {
+    KOSMIC_PROFILE_SCOPE("Shader::Compile");
+    GLuint computeShader = CompileShader(GL_COMPUTE_SHADER, computeSrc);
+    m_ShaderID = LinkProgram({computeShader});
+    glDeleteShader(computeShader);
+
+    Reflect();
 }
 
 Shader::~Shader() {
     glDeleteProgram(m_ShaderID);
+    StateManager::OnProgramDeleted(m_ShaderID);
 }
 
 void Shader::Bind() const {
-    glUseProgram(m_ShaderID);
+    StateManager::UseProgram(m_ShaderID);
 }
 
 void Shader::Unbind() const {
-    glUseProgram(0);
+    StateManager::UseProgram(0);
 }
 
 GLuint Shader::CompileShader(GLenum type, const std::string& source) {
@@ -63,10 +82,10 @@ GLuint Shader::CompileShader(GLenum type, const std::string& source) {
     return shader;
 }
 
-GLuint Shader::LinkProgram(GLuint vertexShader, GLuint fragmentShader) {
+GLuint Shader::LinkProgram(std::initializer_list<GLuint> shaders) {
     GLuint program = glCreateProgram();
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
+    for (GLuint shader : shaders)
+        glAttachShader(program, shader);
     glLinkProgram(program);
 
     // Link error checking
@@ -80,28 +99,118 @@ GLuint Shader::LinkProgram(GLuint vertexShader, GLuint fragmentShader) {
     return program;
 }
 
-void Shader::SetMat4(const std::string& name, const Math::Mat4& matrix) {
-    GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
+void Shader::Reflect() {
+    GLint uniformCount = 0, maxNameLength = 0;
+    glGetProgramiv(m_ShaderID, GL_ACTIVE_UNIFORMS, &uniformCount);
+    glGetProgramiv(m_ShaderID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::string buffer(std::max(maxNameLength, 1), '\0');
+    for (GLint i = 0; i < uniformCount; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(m_ShaderID, static_cast<GLuint>(i), maxNameLength, &length, &size, &type, buffer.data());
+        std::string name(buffer.data(), length);
+
+        GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
+        if (location < 0) continue; // Member of a uniform block
+
+        // Arrays are reported as "name[0]", make plain "name" resolve as well
+        if (name.ends_with("[0]"))
+            m_UniformLocations.emplace(name.substr(0, name.size() - 3), location);
+        m_UniformLocations.emplace(std::move(name), location);
+    }
+
+    // Samplers of the engine's shared texture buffers read fixed units
+    constexpr std::pair<std::string_view, uint32_t> SharedSamplers[] = {
+        {"u_DrawData", TextureUnit::DrawData},
+        {"u_ClusterLights", TextureUnit::ClusterLights},
+        {"u_LightIndices", TextureUnit::LightIndices},
+        {"u_LightData", TextureUnit::LightData},
+        {"u_DepthPyramid", TextureUnit::DepthPyramid},
+    };
+    for (const auto& [name, unit] : SharedSamplers) {
+        GLint location = GetUniformLocation(name);
+        if (location < 0) continue;
+        StateManager::UseProgram(m_ShaderID);
+        glUniform1i(location, static_cast<GLint>(unit));
+    }
+
+    GLint blockCount = 0, maxBlockNameLength = 0;
+    glGetProgramiv(m_ShaderID, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+    glGetProgramiv(m_ShaderID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxBlockNameLength);
+
+    buffer.assign(std::max(maxBlockNameLength, 1), '\0');
+    for (GLint i = 0; i < blockCount; ++i) {
+        GLsizei length = 0;
+        glGetActiveUniformBlockName(m_ShaderID, static_cast<GLuint>(i), maxBlockNameLength, &length, buffer.data());
+        std::string_view name(buffer.data(), length);
+
+        if (name == "Camera")
+            glUniformBlockBinding(m_ShaderID, static_cast<GLuint>(i), UniformBinding::Camera);
+        else if (name == "Lighting")
+            glUniformBlockBinding(m_ShaderID, static_cast<GLuint>(i), UniformBinding::Lighting);
+    }
+}
+
+GLint Shader::GetUniformLocation(std::string_view name) const {
+    auto it = m_UniformLocations.find(name);
+    return it != m_UniformLocations.end() ? it->second : -1;
+}
+
+void Shader::BindUniformBlock(std::string_view name, uint32_t binding) {
+    std::string blockName(name);
+    GLuint index = glGetUniformBlockIndex(m_ShaderID, blockName.c_str());
+    if (index == GL_INVALID_INDEX) {
+        KOSMIC_WARN("Shader has no uniform block named {}", blockName);
+        return;
+    }
+    glUniformBlockBinding(m_ShaderID, index, binding);
+}
+
+void Shader::SetMat4(std::string_view name, const Math::Mat4& matrix) {
+    SetMat4(GetUniformLocation(name), matrix);
+}
+
+void Shader::SetVec3(std::string_view name, const Math::Vector3& value) {
+    SetVec3(GetUniformLocation(name), value);
+}
+
+void Shader::SetVec4(std::string_view name, const Math::Vector4& value) {
+    SetVec4(GetUniformLocation(name), value);
+}
+
+void Shader::SetFloat(std::string_view name, float value) {
+    SetFloat(GetUniformLocation(name), value);
+}
+
+void Shader::SetInt(std::string_view name, int value) {
+    SetInt(GetUniformLocation(name), value);
+}
+
+void Shader::SetMat4(GLint location, const Math::Mat4& matrix) {
     glUniformMatrix4fv(location, 1, GL_FALSE, &matrix[0][0]);
+    RenderStatistics::GetCurrent().uniformUploads++;
 }
 
-void Shader::SetVec3(const std::string& name, const Math::Vector3& value) {
-    GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
+void Shader::SetVec3(GLint location, const Math::Vector3& value) {
     glUniform3f(location, value.x, value.y, value.z);
+    RenderStatistics::GetCurrent().uniformUploads++;
 }
 
-void Shader::SetVec4(const std::string& name, const Math::Vector4& value) {
-    GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
+void Shader::SetVec4(GLint location, const Math::Vector4& value) {
     glUniform4f(location, value.x, value.y, value.z, value.w);
+    RenderStatistics::GetCurrent().uniformUploads++;
 }
 
-void Shader::SetFloat(const std::string& name, float value) {
-    GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
+void Shader::SetFloat(GLint location, float value) {
     glUniform1f(location, value);
+    RenderStatistics::GetCurrent().uniformUploads++;
 }
 
-void Shader::SetInt(const std::string& name, int value) {
-    glUniform1i(glGetUniformLocation(m_ShaderID, name.c_str()), value);
+void Shader::SetInt(GLint location, int value) {
+    glUniform1i(location, value);
+    RenderStatistics::GetCurrent().uniformUploads++;
 }
 
 std::shared_ptr<Shader> Shader::CreateBasicShader() {
@@ -120,4 +229,44 @@ std::shared_ptr<Shader> Shader::CreateSkyShader() {
     return std::make_shared<Shader>(vertexSrc, fragmentSrc);
 }
 
+std::shared_ptr<Shader> Shader::CreateInstancedShader() {
+    std::string vertexPath   = "Resources/Shaders/instanced.vert";
+    std::string fragmentPath = "Resources/Shaders/basic.frag";
+    std::string vertexSrc = LoadShaderSource(vertexPath);
+    std::string fragmentSrc = LoadShaderSource(fragmentPath);
+    return std::make_shared<Shader>(vertexSrc, fragmentSrc);
+}
+
+std::shared_ptr<Shader> Shader::CreatePooledShader() {
+    std::string vertexPath   = "Resources/Shaders/pooled.vert";
+    std::string fragmentPath = "Resources/Shaders/basic.frag";
+    std::string vertexSrc = LoadShaderSource(vertexPath);
+    std::string fragmentSrc = LoadShaderSource(fragmentPath);
+    return std::make_shared<Shader>(vertexSrc, fragmentSrc);
+}
+
+std::shared_ptr<Shader> Shader::CreateBoundsShader() {
+    std::string vertexPath   = "Resources/Shaders/bounds.vert";
+    std::string fragmentPath = "Resources/Shaders/bounds.frag";
+    std::string vertexSrc = LoadShaderSource(vertexPath);
+    std::string fragmentSrc = LoadShaderSource(fragmentPath);
+    return std::make_shared<Shader>(vertexSrc, fragmentSrc);
+}
+
+std::shared_ptr<Shader> Shader::CreateCullShader() {
+    return std::make_shared<Shader>(LoadShaderSource("Resources/Shaders/cull.comp"));
+}
+
+std::shared_ptr<Shader> Shader::CreateDepthPyramidShader() {
+    return std::make_shared<Shader>(LoadShaderSource("Resources/Shaders/depth_pyramid.comp"));
+}
+
+std::shared_ptr<Shader> Shader::CreateCulledInstanceShader() {
+    std::string vertexPath   = "Resources/Shaders/culled.vert";
+    std::string fragmentPath = "Resources/Shaders/basic.frag";
+    std::string vertexSrc = LoadShaderSource(vertexPath);
+    std::string fragmentSrc = LoadShaderSource(fragmentPath);
+    return std::make_shared<Shader>(vertexSrc, fragmentSrc);
+}
+
 } // namespace Kosmic::Renderer
@@ -0,0 +1,178 @@
+#include "Kosmic/Renderer/StateManager.hpp"
+#include "Kosmic/Renderer/RenderStats.hpp"
+#include "Kosmic/Renderer/VertexLayout.hpp"
+#include <vector>
+
+namespace Kosmic::Renderer {
+
+namespace {
+
+constexpr uint32_t Unknown = UINT32_MAX;
+
+struct TextureUnit {
+    uint32_t texture2D{Unknown};
+    uint32_t textureBuffer{Unknown};
+};
+
+struct CachedState {
+    uint32_t program{Unknown};
+    uint32_t vao{Unknown};
+    uint32_t framebuffer{Unknown};
+    uint32_t activeUnit{Unknown};
+    TextureUnit units[StateManager::MaxTextureUnits];
+    // Flags hold 0 or 1 once known
+    uint32_t depthTest{Unknown};
+    uint32_t depthMask{Unknown};
+    uint32_t cullFace{Unknown};
+    uint32_t cullMode{Unknown};
+    uint32_t blend{Unknown};
+    uint32_t blendSource{Unknown};
+    uint32_t blendDestination{Unknown};
+};
+
+CachedState s_State;
+
+// VAOs without a color array, by name. Not GL state, Invalidate keeps it.
+std::vector<bool> s_ConstantColor;
+
+// Stores the value and returns true when the call has to go to GL
+bool Update(uint32_t& cached, uint32_t value) {
+    RenderStats& stats = RenderStatistics::GetCurrent();
+    if (cached == value) {
+        stats.redundantStateChanges++;
+        return false;
+    }
+    cached = value;
+    stats.stateChanges++;
+    return true;
+}
+
+void SetCapability(uint32_t& cached, GLenum capability, bool enable) {
+    if (!Update(cached, enable)) return;
+    if (enable) glEnable(capability);
+    else glDisable(capability);
+}
+
+void SetActiveUnit(uint32_t unit) {
+    if (Update(s_State.activeUnit, unit)) glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+} // namespace
+
+void StateManager::UseProgram(uint32_t program) {
+    if (!Update(s_State.program, program)) return;
+    glUseProgram(program);
+    RenderStatistics::GetCurrent().shaderBinds++;
+}
+
+void StateManager::BindVertexArray(uint32_t vao) {
+    if (!Update(s_State.vao, vao)) return;
+    glBindVertexArray(vao);
+    RenderStatistics::GetCurrent().vaoBinds++;
+    if (vao < s_ConstantColor.size() && s_ConstantColor[vao])
+        glVertexAttrib4f(static_cast<GLuint>(VertexAttribute::Color), 1.0f, 1.0f, 1.0f, 1.0f);
+}
+
+void StateManager::SetConstantColor(uint32_t vao, bool constant) {
+    if (vao >= s_ConstantColor.size()) {
+        if (!constant) return;
+        s_ConstantColor.resize(vao + 1);
+    }
+    s_ConstantColor[vao] = constant;
+    // Bound while it was set up: the next BindVertexArray may be skipped
+    if (constant && s_State.vao == vao)
+        glVertexAttrib4f(static_cast<GLuint>(VertexAttribute::Color), 1.0f, 1.0f, 1.0f, 1.0f);
+}
+
+void StateManager::BindTexture(uint32_t unit, uint32_t texture, GLenum target) {
+    uint32_t* cached = nullptr;
+    if (unit < MaxTextureUnits) {
+        if (target == GL_TEXTURE_2D) cached = &s_State.units[unit].texture2D;
+        else if (target == GL_TEXTURE_BUFFER) cached = &s_State.units[unit].textureBuffer;
+    }
+    RenderStats& stats = RenderStatistics::GetCurrent();
+    if (cached && *cached == texture) {
+        stats.redundantStateChanges++;
+        return;
+    }
+    SetActiveUnit(unit);
+    if (cached) *cached = texture;
+    glBindTexture(target, texture);
+    stats.stateChanges++;
+    stats.textureBinds++;
+}
+
+void StateManager::BindFramebuffer(uint32_t framebuffer) {
+    if (!Update(s_State.framebuffer, framebuffer)) return;
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    RenderStatistics::GetCurrent().framebufferBinds++;
+}
+
+uint32_t StateManager::GetFramebuffer() {
+    if (s_State.framebuffer == Unknown) {
+        GLint framebuffer = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+        s_State.framebuffer = static_cast<uint32_t>(framebuffer);
+    }
+    return s_State.framebuffer;
+}
+
+void StateManager::SetDepthTest(bool enable) {
+    SetCapability(s_State.depthTest, GL_DEPTH_TEST, enable);
+}
+
+void StateManager::SetDepthMask(bool enable) {
+    if (Update(s_State.depthMask, enable)) glDepthMask(enable ? GL_TRUE : GL_FALSE);
+}
+
+void StateManager::SetCullFace(bool enable) {
+    SetCapability(s_State.cullFace, GL_CULL_FACE, enable);
+}
+
+void StateManager::SetCullMode(GLenum face) {
+    if (Update(s_State.cullMode, face)) glCullFace(face);
+}
+
+void StateManager::SetBlend(bool enable) {
+    SetCapability(s_State.blend, GL_BLEND, enable);
+}
+
+void StateManager::SetBlendFunc(GLenum source, GLenum destination) {
+    RenderStats& stats = RenderStatistics::GetCurrent();
+    if (s_State.blendSource == source && s_State.blendDestination == destination) {
+        stats.redundantStateChanges++;
+        return;
+    }
+    s_State.blendSource = source;
+    s_State.blendDestination = destination;
+    stats.stateChanges++;
+    glBlendFunc(source, destination);
+}
+
+void StateManager::OnProgramDeleted(uint32_t program) {
+    // A program in use lives on until it is replaced, so it is not unbound;
+    // just make sure the next UseProgram goes through
+    if (s_State.program == program) s_State.program = Unknown;
+}
+
+void StateManager::OnVertexArrayDeleted(uint32_t vao) {
+    if (s_State.vao == vao) s_State.vao = 0;
+    SetConstantColor(vao, false);
+}
+
+void StateManager::OnTextureDeleted(uint32_t texture) {
+    for (TextureUnit& unit : s_State.units) {
+        if (unit.texture2D == texture) unit.texture2D = 0;
+        if (unit.textureBuffer == texture) unit.textureBuffer = 0;
+    }
+}
+
+void StateManager::OnFramebufferDeleted(uint32_t framebuffer) {
+    if (s_State.framebuffer == framebuffer) s_State.framebuffer = 0;
+}
+
+void StateManager::Invalidate() {
+    s_State = {};
+}
+
+} // namespace Kosmic::Renderer
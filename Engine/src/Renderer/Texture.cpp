@@ -1,46 +1,319 @@
 #include "Kosmic/Renderer/Texture.hpp"
+#include "Kosmic/Assets/TextureCompressor.hpp"
+#include "Kosmic/Renderer/StateManager.hpp"
 #include <GL/glew.h>
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 #include "Kosmic/Core/Logging.hpp"
+#include "Kosmic/Core/Profiler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
 
 namespace Kosmic::Renderer {
 
+static uint32_t s_PlaceholderID = 0;
+static std::atomic<size_t> s_TotalBytes{0};
+static std::atomic<size_t> s_TotalUncompressedBytes{0};
+
+static void GetGLFormat(Assets::TextureFile::Format format, GLenum& internalFormat, GLenum& pixelFormat) {
+    using Assets::TextureFile::Format;
+    switch (format) {
+        case Format::RGB8:  internalFormat = GL_RGB;  pixelFormat = GL_RGB;  return;
+        case Format::RGBA8: internalFormat = GL_RGBA; pixelFormat = GL_RGBA; return;
+        case Format::BC1:   internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT; break;
+        case Format::BC3:   internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+        case Format::BC5:   internalFormat = GL_COMPRESSED_RG_RGTC2; break;
+        case Format::BC7:   internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM_ARB; break;
+    }
+    pixelFormat = 0;
+}
+
+static int GetChannelCount(Assets::TextureFile::Format format) {
+    using Assets::TextureFile::Format;
+    switch (format) {
+        case Format::RGB8:
+        case Format::BC1:   return 3;
+        case Format::BC5:   return 2;
+        default:            return 4;
+    }
+}
+
 Texture::Texture(const std::string& path)
     : m_Path(path), m_RendererID(0), m_Width(0), m_Height(0), m_Channels(0)
 {
-    // Load image with stb_image
-    stbi_set_flip_vertically_on_load(1);
-    unsigned char* data = stbi_load(path.c_str(), &m_Width, &m_Height, &m_Channels, 0);
-    if (!data) {
+    KOSMIC_PROFILE_SCOPE("Texture::Load");
+    Image image;
+    if (Decode(path, image))
+        Upload(image);
+}
+
+bool Texture::Decode(const std::string& path, Image& image) {
+    KOSMIC_PROFILE_SCOPE("Texture::Decode");
+    using namespace Assets;
+
+    if (std::filesystem::path(path).extension() == TextureFile::Extension) {
+        if (DecodeCooked(path, nullptr, image)) return true;
+        KOSMIC_ERROR("Failed to load cooked texture: {}", path);
+        return false;
+    }
+
+    SourceStamp source = GetSourceStamp(path);
+    if (DecodeCooked(GetCookedPath(path, TextureFile::Extension), source.IsValid() ? &source : nullptr, image))
+        return true;
+    return DecodeImage(path, image);
+}
+
+bool Texture::DecodeCooked(const std::string& cookedPath, const Assets::SourceStamp* source, Image& image) {
+    using namespace Assets;
+    if (!image.file.Open(cookedPath)) return false;
+
+    std::optional<TextureFile::View> view = TextureFile::Parse(image.file.GetData(), image.file.GetSize());
+    if (!view) {
+        KOSMIC_WARN("Ignoring invalid or outdated cooked texture: {}", cookedPath);
+        image.file.Close();
+        return false;
+    }
+    if (source && view->header->cooked.source != *source) {
+        KOSMIC_INFO("Cooked texture is stale, loading the image: {}", cookedPath);
+        image.file.Close();
+        return false;
+    }
+
+    if (!IsFormatSupported(view->header->format)) {
+        KOSMIC_WARN("{} textures are not supported here, loading the image: {}",
+                    TextureFile::GetFormatName(view->header->format), cookedPath);
+        image.file.Close();
+        return false;
+    }
+
+    image.format = view->header->format;
+    image.levels.assign(view->levels, view->levels + view->header->mipCount);
+    image.generateMips = false;
+    return true;
+}
+
+bool Texture::DecodeImage(const std::string& path, Image& image) {
+    // Gray becomes RGB and gray+alpha RGBA, the two formats we upload.
+    // stb's flip flag is global state, so rows are flipped here instead,
+    // which keeps decoding safe on several threads at once.
+    int width = 0, height = 0, channels = 0;
+    if (!stbi_info(path.c_str(), &width, &height, &channels)) {
+        KOSMIC_ERROR("Failed to load texture from {}", path);
+        return false;
+    }
+    int wanted = channels == 2 || channels == 4 ? 4 : 3;
+    unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, wanted);
+    if (!pixels) {
         KOSMIC_ERROR("Failed to load texture from {}", path);
-        return;
+        return false;
+    }
+
+    image.format = wanted == 4 ? Assets::TextureFile::Format::RGBA8 : Assets::TextureFile::Format::RGB8;
+    size_t row = size_t(width) * wanted;
+    image.pixels.resize(row * height);
+    for (int y = 0; y < height; ++y)
+        std::memcpy(image.pixels.data() + row * y, pixels + row * (height - 1 - y), row);
+    stbi_image_free(pixels);
+
+    image.levels = {{static_cast<uint32_t>(width), static_cast<uint32_t>(height), 0, image.pixels.size()}};
+    image.generateMips = true;
+    return true;
+}
+
+void Texture::Upload(const Image& image) {
+    KOSMIC_PROFILE_SCOPE("Texture::Upload");
+    if (image.levels.empty()) return;
+
+    CreateStorage(image);
+    // Rows are tightly packed, RGB rows are not 4 byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    uint32_t rowHeight = Assets::TextureFile::GetRowHeight(image.format);
+    for (size_t i = 0; i < image.levels.size(); ++i) {
+        const Assets::TextureFile::MipLevel& level = image.levels[i];
+        UploadRows(image, static_cast<uint32_t>(i), 0, (level.height + rowHeight - 1) / rowHeight,
+                   image.GetData() + level.offset);
     }
-    glGenTextures(1, &m_RendererID);
-    glBindTexture(GL_TEXTURE_2D, m_RendererID);
-    // Set texture parameters
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    StateManager::BindTexture(0, m_RendererID);
+    if (image.generateMips)
+        glGenerateMipmap(GL_TEXTURE_2D);
+    else
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(image.levels.size() - 1));
+    m_Ready = true;
+    m_ResidentLevel = 0;
+}
+
+void Texture::AllocateLevels(const Image& image) {
+    CreateStorage(image);
+
+    uint32_t last = static_cast<uint32_t>(image.levels.size() - 1);
+    StateManager::BindTexture(0, m_RendererID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(last));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(last));
+
+    m_Ready = false;
+    m_ResidentLevel = last;
+}
+
+void Texture::CreateStorage(const Image& image) {
+    using namespace Assets;
+    m_Width = static_cast<int>(image.levels[0].width);
+    m_Height = static_cast<int>(image.levels[0].height);
+    m_Channels = GetChannelCount(image.format);
+    m_Format = image.format;
+
+    if (!m_RendererID) glGenTextures(1, &m_RendererID);
+    StateManager::BindTexture(0, m_RendererID);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // Determine format
-    GLenum format = m_Channels == 4 ? GL_RGBA : GL_RGB;
-    glTexImage2D(GL_TEXTURE_2D, 0, format, m_Width, m_Height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    stbi_image_free(data);
+
+    GLenum internalFormat = 0, format = 0;
+    GetGLFormat(image.format, internalFormat, format);
+    size_t bytes = 0, uncompressed = 0;
+    for (size_t i = 0; i < image.levels.size(); ++i) {
+        const TextureFile::MipLevel& level = image.levels[i];
+        if (TextureFile::IsCompressed(image.format)) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), internalFormat, level.width, level.height,
+                                   0, static_cast<GLsizei>(level.size), nullptr);
+            bytes += level.size;
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), internalFormat, level.width, level.height,
+                         0, format, GL_UNSIGNED_BYTE, nullptr);
+            bytes += size_t(level.width) * level.height * 4;
+        }
+        uncompressed += size_t(level.width) * level.height * 4;
+    }
+
+    // glGenerateMipmap adds about a third on top of level 0
+    if (image.generateMips) {
+        bytes += bytes / 3;
+        uncompressed += uncompressed / 3;
+    }
+    s_TotalBytes += bytes - m_MemorySize;
+    s_TotalUncompressedBytes += uncompressed - m_UncompressedSize;
+    m_MemorySize = bytes;
+    m_UncompressedSize = uncompressed;
+}
+
+void Texture::UploadRows(const Image& image, uint32_t level, uint32_t row, uint32_t rows, const void* pixels) {
+    using namespace Assets;
+    const TextureFile::MipLevel& mip = image.levels[level];
+    uint32_t rowHeight = TextureFile::GetRowHeight(image.format);
+    // The last block row may be cut off by the level's edge
+    uint32_t y = row * rowHeight;
+    uint32_t height = std::min(rows * rowHeight, mip.height - y);
+
+    GLenum internalFormat = 0, format = 0;
+    GetGLFormat(image.format, internalFormat, format);
+    StateManager::BindTexture(0, m_RendererID);
+    if (TextureFile::IsCompressed(image.format))
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), 0, static_cast<GLint>(y), mip.width,
+                                  height, internalFormat,
+                                  static_cast<GLsizei>(TextureFile::GetRowPitch(image.format, mip.width) * rows),
+                                  pixels);
+    else
+        glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), 0, static_cast<GLint>(y), mip.width, height,
+                        format, GL_UNSIGNED_BYTE, pixels);
+}
+
+void Texture::SetResidentLevel(uint32_t level) {
+    StateManager::BindTexture(0, m_RendererID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(level));
+    m_Ready = true;
+    m_ResidentLevel = level;
+}
+
+bool Texture::IsFormatSupported(Assets::TextureFile::Format format) {
+    using Assets::TextureFile::Format;
+    switch (format) {
+        case Format::RGB8:
+        case Format::RGBA8:
+        case Format::BC5:  // RGTC is core since 3.0
+            return true;
+        case Format::BC1:
+        case Format::BC3:
+            return GLEW_EXT_texture_compression_s3tc;
+        case Format::BC7:
+            return GLEW_ARB_texture_compression_bptc;
+    }
+    return false;
+}
+
+TextureMemory Texture::GetTotalMemory() {
+    return {s_TotalBytes.load(), s_TotalUncompressedBytes.load()};
+}
+
+void Texture::Image::GenerateMipChain() {
+    if (!generateMips || levels.empty()) return;
+    Assets::TextureFile::TextureData data;
+    data.format = format;
+    data.levels = {levels[0]};
+    data.pixels = std::move(pixels);
+    Assets::TextureFile::GenerateMips(data);
+    levels = std::move(data.levels);
+    pixels = std::move(data.pixels);
+    generateMips = false;
+}
+
+uint32_t Texture::GetPlaceholderID() {
+    if (!s_PlaceholderID) {
+        const uint8_t white[4] = {255, 255, 255, 255};
+        glGenTextures(1, &s_PlaceholderID);
+        StateManager::BindTexture(0, s_PlaceholderID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    }
+    return s_PlaceholderID;
+}
+
+void Texture::ReleasePlaceholder() {
+    if (s_PlaceholderID) {
+        glDeleteTextures(1, &s_PlaceholderID);
+        StateManager::OnTextureDeleted(s_PlaceholderID);
+    }
+    s_PlaceholderID = 0;
+}
+
+bool Texture::Cook(const std::string& sourcePath, const std::string& cookedPath, const TextureCookOptions& options) {
+    using namespace Assets;
+    KOSMIC_PROFILE_SCOPE("Texture::Cook");
+
+    Image image;
+    if (!DecodeImage(sourcePath, image)) return false;
+
+    TextureFile::TextureData data;
+    data.format = image.format;
+    data.levels = image.levels;
+    data.pixels = std::move(image.pixels);
+    TextureFile::GenerateMips(data);
+
+    if (options.compress &&
+        !TextureCompressor::Compress(data, TextureCompressor::ChooseFormat(data, options.normalMap, options.bc7)))
+        return false;
+    return TextureFile::Write(cookedPath, data, GetSourceStamp(sourcePath));
 }
 
 Texture::~Texture() {
-    glDeleteTextures(1, &m_RendererID);
+    s_TotalBytes -= m_MemorySize;
+    s_TotalUncompressedBytes -= m_UncompressedSize;
+    if (m_RendererID) {
+        glDeleteTextures(1, &m_RendererID);
+        StateManager::OnTextureDeleted(m_RendererID);
+    }
 }
 
 void Texture::Bind(uint32_t slot) const {
-    glActiveTexture(GL_TEXTURE0 + slot);
-    glBindTexture(GL_TEXTURE_2D, m_RendererID);
+    StateManager::BindTexture(slot, GetID());
 }
 
-void Texture::Unbind() const {
-    glBindTexture(GL_TEXTURE_2D, 0);
+void Texture::Unbind(uint32_t slot) const {
+    StateManager::BindTexture(slot, 0);
 }
 
 } // namespace Kosmic::Renderer
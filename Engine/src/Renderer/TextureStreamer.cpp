@@ -0,0 +1,230 @@
+#include "Kosmic/Renderer/TextureStreamer.hpp"
+#include "Kosmic/Renderer/RenderStats.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include "Kosmic/Core/Profiler.hpp"
+#include <GL/glew.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+
+namespace Kosmic::Renderer {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t SliceAlignment = 16;
+
+struct Request {
+    std::weak_ptr<Texture> texture;
+    std::shared_ptr<Texture::Image> image;
+    uint32_t level{0};    // Being filled, counts down to 0
+    uint32_t row{0};      // Next row of that level, in block rows when compressed
+    bool allocated{false};
+    Clock::time_point enqueued;
+};
+
+// A frame's worth of ring writes, free again once the fence signals
+struct Fence {
+    GLsync sync{nullptr};
+    size_t bytes{0};
+};
+
+struct StreamerState {
+    GLuint buffer{0};
+    uint8_t* mapped{nullptr}; // Persistent mapping, null when mapping per slice
+    size_t size{0};
+    size_t head{0};
+    size_t used{0};           // Allocated and not yet retired, including wrap padding
+    size_t unfenced{0};       // Written this frame, not covered by a fence yet
+    std::deque<Fence> fences;
+    std::deque<Request> requests;
+
+    size_t bytesLastFrame{0};
+    uint32_t completed{0};
+    double lastLatencyMs{0.0};
+    double totalLatencyMs{0.0};
+    double maxLatencyMs{0.0};
+};
+
+StreamerState s_State;
+
+void RetireFences() {
+    while (!s_State.fences.empty()) {
+        Fence& fence = s_State.fences.front();
+        GLenum status = glClientWaitSync(fence.sync, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+        glDeleteSync(fence.sync);
+        s_State.used -= fence.bytes;
+        s_State.fences.pop_front();
+    }
+}
+
+// Reserves bytes at the head, skipping the tail end of the ring when they don't fit there
+bool Allocate(size_t bytes, size_t& offset) {
+    size_t size = (bytes + SliceAlignment - 1) & ~(SliceAlignment - 1);
+    size_t padding = s_State.head + size > s_State.size ? s_State.size - s_State.head : 0;
+    if (s_State.used + padding + size > s_State.size) return false;
+
+    if (padding) s_State.head = 0;
+    offset = s_State.head;
+    s_State.head += size;
+    if (s_State.head == s_State.size) s_State.head = 0;
+
+    s_State.used += padding + size;
+    s_State.unfenced += padding + size;
+    return true;
+}
+
+// Moves on to the next larger level, or records the latency when all are in
+void FinishLevel(Request& request) {
+    if (request.level > 0) {
+        request.level--;
+        request.row = 0;
+        return;
+    }
+
+    double latency = std::chrono::duration<double, std::milli>(Clock::now() - request.enqueued).count();
+    s_State.completed++;
+    s_State.lastLatencyMs = latency;
+    s_State.totalLatencyMs += latency;
+    s_State.maxLatencyMs = std::max(s_State.maxLatencyMs, latency);
+}
+
+} // namespace
+
+void TextureStreamer::Init(size_t ringSize) {
+    if (s_State.buffer) return;
+    // Slices are aligned, so the ring must be too
+    s_State.size = ringSize & ~(SliceAlignment - 1);
+
+    glGenBuffers(1, &s_State.buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s_State.buffer);
+    if (GLEW_ARB_buffer_storage) {
+        // Coherent, so plain memcpy writes need no explicit flush
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, s_State.size, nullptr, flags);
+        s_State.mapped = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, s_State.size, flags));
+    } else {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, s_State.size, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    KOSMIC_INFO("Texture streaming: {} MB ring, {} mapping", s_State.size >> 20,
+                s_State.mapped ? "persistent" : "per-slice");
+}
+
+void TextureStreamer::Shutdown() {
+    for (Fence& fence : s_State.fences) glDeleteSync(fence.sync);
+    if (s_State.buffer) {
+        if (s_State.mapped) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s_State.buffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &s_State.buffer);
+    }
+    s_State = {};
+}
+
+void TextureStreamer::Enqueue(const std::shared_ptr<Texture>& texture, std::shared_ptr<Texture::Image> image) {
+    if (!texture || !image || image->levels.empty()) return;
+    // Streaming goes smallest level first, they all have to exist up front
+    image->GenerateMipChain();
+
+    Request request;
+    request.texture = texture;
+    request.level = static_cast<uint32_t>(image->levels.size() - 1);
+    request.image = std::move(image);
+    request.enqueued = Clock::now();
+    s_State.requests.push_back(std::move(request));
+}
+
+void TextureStreamer::Update(size_t budgetBytes) {
+    KOSMIC_PROFILE_SCOPE("TextureStreamer::Update");
+    s_State.bytesLastFrame = 0;
+    if (s_State.requests.empty() && s_State.fences.empty()) return;
+    if (!s_State.buffer) Init();
+
+    RetireFences();
+
+    size_t uploaded = 0;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s_State.buffer);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    while (!s_State.requests.empty()) {
+        Request& request = s_State.requests.front();
+        std::shared_ptr<Texture> texture = request.texture.lock();
+        if (!texture) {
+            s_State.requests.pop_front();
+            continue;
+        }
+
+        const Texture::Image& image = *request.image;
+        if (!request.allocated) {
+            texture->AllocateLevels(image);
+            request.allocated = true;
+        }
+
+        // Whole rows per slice; always at least one so a tight budget still progresses
+        const Assets::TextureFile::MipLevel& level = image.levels[request.level];
+        uint32_t rowHeight = Assets::TextureFile::GetRowHeight(image.format);
+        uint32_t levelRows = (level.height + rowHeight - 1) / rowHeight;
+        size_t rowBytes = Assets::TextureFile::GetRowPitch(image.format, level.width);
+        size_t budgetRows = uploaded < budgetBytes ? (budgetBytes - uploaded) / rowBytes : 0;
+        if (budgetRows == 0 && uploaded > 0) break;
+        uint32_t rows = static_cast<uint32_t>(std::min<size_t>(std::max<size_t>(budgetRows, 1), levelRows - request.row));
+        rows = static_cast<uint32_t>(std::min<size_t>(rows, std::max<size_t>(s_State.size / 4 / rowBytes, 1)));
+
+        size_t bytes = rows * rowBytes;
+        size_t offset = 0;
+        if (!Allocate(bytes, offset)) break; // Ring full until the GPU catches up
+
+        const uint8_t* source = image.GetData() + level.offset + request.row * rowBytes;
+        if (s_State.mapped) {
+            std::memcpy(s_State.mapped + offset, source, bytes);
+        } else {
+            void* destination = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, offset, bytes,
+                GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+            if (!destination) break;
+            std::memcpy(destination, source, bytes);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+
+        texture->UploadRows(image, request.level, request.row, rows, reinterpret_cast<const void*>(offset));
+
+        uploaded += bytes;
+        request.row += rows;
+        if (request.row == levelRows) {
+            bool done = request.level == 0;
+            texture->SetResidentLevel(request.level);
+            FinishLevel(request);
+            if (done) s_State.requests.pop_front();
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (s_State.unfenced > 0) {
+        s_State.fences.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), s_State.unfenced});
+        s_State.unfenced = 0;
+    }
+    s_State.bytesLastFrame = uploaded;
+    RenderStatistics::GetCurrent().bufferBytes += uploaded;
+}
+
+TextureStreamerStats TextureStreamer::GetStats() {
+    TextureStreamerStats stats;
+    stats.pendingTextures = static_cast<uint32_t>(s_State.requests.size());
+    stats.bytesInFlight = s_State.used;
+    stats.bytesLastFrame = s_State.bytesLastFrame;
+    stats.completed = s_State.completed;
+    stats.lastLatencyMs = s_State.lastLatencyMs;
+    stats.averageLatencyMs = s_State.completed ? s_State.totalLatencyMs / s_State.completed : 0.0;
+    stats.maxLatencyMs = s_State.maxLatencyMs;
+    return stats;
+}
+
+} // namespace Kosmic::Renderer
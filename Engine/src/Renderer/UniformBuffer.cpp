@@ -0,0 +1,35 @@
+#include "Kosmic/Renderer/UniformBuffer.hpp"
+#include "Kosmic/Renderer/RenderStats.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include <GL/glew.h>
+
+namespace Kosmic::Renderer {
+
+UniformBuffer::UniformBuffer(uint32_t size, uint32_t binding)
+    : m_RendererID(0), m_Size(size), m_Binding(binding) {
+    glGenBuffers(1, &m_RendererID);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_RendererID);
+}
+
+UniformBuffer::~UniformBuffer() {
+    glDeleteBuffers(1, &m_RendererID);
+}
+
+void UniformBuffer::SetData(const void* data, uint32_t size, uint32_t offset) {
+    if (offset + size > m_Size) {
+        KOSMIC_ERROR("UniformBuffer: write of {} bytes at {} exceeds size {}", size, offset, m_Size);
+        return;
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+    if (offset == 0 && size == m_Size)
+        glBufferData(GL_UNIFORM_BUFFER, size, data, GL_DYNAMIC_DRAW);
+    else
+        glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    RenderStatistics::GetCurrent().bufferBytes += size;
+}
+
+} // namespace Kosmic::Renderer
@@ -0,0 +1,199 @@
+#include "Kosmic/Renderer/VertexLayout.hpp"
+#include <GL/glew.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Kosmic::Renderer {
+
+namespace {
+
+// Round to nearest even, like the hardware conversions
+uint16_t ToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t biased = (bits >> 23) & 0xFF;
+    uint32_t mantissa = bits & 0x7FFFFF;
+    if (biased == 0xFF) return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+
+    int32_t exponent = int32_t(biased) - 127 + 15;
+    if (exponent >= 31) return static_cast<uint16_t>(sign | 0x7C00);
+    if (exponent <= 0) {
+        // Denormal, or zero when too small even for that
+        if (exponent < -10) return static_cast<uint16_t>(sign);
+        mantissa |= 0x800000;
+        uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1))) half++;
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    // A carry out of the mantissa correctly bumps the exponent
+    uint32_t half = sign | uint32_t(exponent) << 10 | mantissa >> 13;
+    uint32_t rest = mantissa & 0x1FFF;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) half++;
+    return static_cast<uint16_t>(half);
+}
+
+uint32_t ToInt2_10_10_10(const Math::Vector3& value) {
+    auto component = [](float v) {
+        return static_cast<uint32_t>(static_cast<int32_t>(std::lround(std::clamp(v, -1.0f, 1.0f) * 511.0f))) & 0x3FF;
+    };
+    return component(value.x) | component(value.y) << 10 | component(value.z) << 20;
+}
+
+uint8_t ToUNorm8(float value) {
+    return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+void Write(VertexFormat format, const float* components, uint8_t* out) {
+    switch (format) {
+        case VertexFormat::Float2:
+            std::memcpy(out, components, sizeof(float) * 2);
+            break;
+        case VertexFormat::Float3:
+            std::memcpy(out, components, sizeof(float) * 3);
+            break;
+        case VertexFormat::Half2: {
+            uint16_t half[2] = {ToHalf(components[0]), ToHalf(components[1])};
+            std::memcpy(out, half, sizeof(half));
+            break;
+        }
+        case VertexFormat::Int2_10_10_10: {
+            uint32_t packed = ToInt2_10_10_10({components[0], components[1], components[2]});
+            std::memcpy(out, &packed, sizeof(packed));
+            break;
+        }
+        case VertexFormat::UByte4:
+            out[0] = ToUNorm8(components[0]);
+            out[1] = ToUNorm8(components[1]);
+            out[2] = ToUNorm8(components[2]);
+            out[3] = 255;
+            break;
+    }
+}
+
+} // namespace
+
+uint32_t GetVertexFormatSize(VertexFormat format) {
+    switch (format) {
+        case VertexFormat::Float2:        return 8;
+        case VertexFormat::Float3:        return 12;
+        case VertexFormat::Half2:         return 4;
+        case VertexFormat::Int2_10_10_10: return 4;
+        case VertexFormat::UByte4:        return 4;
+    }
+    return 0;
+}
+
+VertexLayout& VertexLayout::Add(VertexAttribute attribute, VertexFormat format) {
+    if (elementCount == MaxElements) return *this;
+    elements[elementCount++] = {attribute, format, stride};
+    stride = (stride + GetVertexFormatSize(format) + 3) & ~3u;
+    return *this;
+}
+
+bool VertexLayout::Has(VertexAttribute attribute) const {
+    return std::any_of(elements, elements + elementCount,
+                       [attribute](const VertexElement& element) { return element.attribute == attribute; });
+}
+
+bool VertexLayout::IsValid() const {
+    if (elementCount == 0 || elementCount > MaxElements || stride == 0) return false;
+    for (uint32_t i = 0; i < elementCount; ++i) {
+        const VertexElement& element = elements[i];
+        if (static_cast<uint32_t>(element.attribute) > static_cast<uint32_t>(VertexAttribute::Normal) ||
+            static_cast<uint32_t>(element.format) > static_cast<uint32_t>(VertexFormat::UByte4) ||
+            element.offset + GetVertexFormatSize(element.format) > stride)
+            return false;
+    }
+    return Has(VertexAttribute::Position);
+}
+
+void VertexLayout::Apply() const {
+    for (uint32_t i = 0; i < elementCount; ++i) {
+        const VertexElement& element = elements[i];
+        GLuint location = static_cast<GLuint>(element.attribute);
+        const void* offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(element.offset));
+        glEnableVertexAttribArray(location);
+        switch (element.format) {
+            case VertexFormat::Float2:
+                glVertexAttribPointer(location, 2, GL_FLOAT, GL_FALSE, stride, offset);
+                break;
+            case VertexFormat::Float3:
+                glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride, offset);
+                break;
+            case VertexFormat::Half2:
+                glVertexAttribPointer(location, 2, GL_HALF_FLOAT, GL_FALSE, stride, offset);
+                break;
+            case VertexFormat::Int2_10_10_10:
+                glVertexAttribPointer(location, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, offset);
+                break;
+            case VertexFormat::UByte4:
+                glVertexAttribPointer(location, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, offset);
+                break;
+        }
+    }
+
+    // Without a color stream shaders read location 1's current value, which
+    // is context state: StateManager sets it to white when the VAO is bound
+    if (!Has(VertexAttribute::Color))
+        glDisableVertexAttribArray(static_cast<GLuint>(VertexAttribute::Color));
+}
+
+void VertexLayout::Pack(const Vertex* vertices, uint32_t count, uint8_t* out) const {
+    for (uint32_t v = 0; v < count; ++v) {
+        const Vertex& vertex = vertices[v];
+        uint8_t* destination = out + size_t(v) * stride;
+        for (uint32_t i = 0; i < elementCount; ++i) {
+            const float* source = nullptr;
+            switch (elements[i].attribute) {
+                case VertexAttribute::Position: source = &vertex.Position.x; break;
+                case VertexAttribute::Color:    source = &vertex.Color.x; break;
+                case VertexAttribute::TexCoord: source = &vertex.TexCoords.x; break;
+                case VertexAttribute::Normal:   source = &vertex.Normal.x; break;
+            }
+            Write(elements[i].format, source, destination + elements[i].offset);
+        }
+    }
+}
+
+VertexLayout VertexLayout::Standard() {
+    VertexLayout layout;
+    layout.Add(VertexAttribute::Position, VertexFormat::Float3)
+          .Add(VertexAttribute::Normal, VertexFormat::Float3)
+          .Add(VertexAttribute::TexCoord, VertexFormat::Float2)
+          .Add(VertexAttribute::Color, VertexFormat::Float3);
+    return layout;
+}
+
+VertexLayout VertexLayout::Compact(bool colors) {
+    VertexLayout layout;
+    layout.Add(VertexAttribute::Position, VertexFormat::Float3)
+          .Add(VertexAttribute::Normal, VertexFormat::Int2_10_10_10)
+          .Add(VertexAttribute::TexCoord, VertexFormat::Half2);
+    if (colors) layout.Add(VertexAttribute::Color, VertexFormat::UByte4);
+    return layout;
+}
+
+VertexLayout VertexLayout::Choose(const Vertex* vertices, uint32_t count) {
+    // Half floats step by 1/1024 or finer up to 2, about a texel of a 1024 texture
+    constexpr float HalfRange = 2.0f;
+    bool halfUVs = true, colors = false;
+    for (uint32_t i = 0; i < count; ++i) {
+        const Vertex& vertex = vertices[i];
+        if (std::fabs(vertex.TexCoords.x) > HalfRange || std::fabs(vertex.TexCoords.y) > HalfRange) halfUVs = false;
+        if (vertex.Color.x != 1.0f || vertex.Color.y != 1.0f || vertex.Color.z != 1.0f) colors = true;
+    }
+
+    VertexLayout layout;
+    layout.Add(VertexAttribute::Position, VertexFormat::Float3)
+          .Add(VertexAttribute::Normal, VertexFormat::Int2_10_10_10)
+          .Add(VertexAttribute::TexCoord, halfUVs ? VertexFormat::Half2 : VertexFormat::Float2);
+    if (colors) layout.Add(VertexAttribute::Color, VertexFormat::UByte4);
+    return layout;
+}
+
+} // namespace Kosmic::Renderer
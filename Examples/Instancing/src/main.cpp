@@ -0,0 +1,120 @@
+#include "Kosmic/Core/Application.hpp"
+#include "Kosmic/Renderer/Renderer3D.hpp"
+#include "Kosmic/Renderer/Mesh.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include "Kosmic/Core/Math/Math.hpp"
+#include "Kosmic/Assets/Material.hpp"
+#include "Kosmic/ECS/ECS.hpp"
+#include "Kosmic/ECS/RenderSystem.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace Kosmic;
+using namespace Kosmic::Math;
+
+// Spin speed in degrees per second around each axis
+struct Spin {
+    Vector3 speed;
+};
+
+// InstancingApp: a grid of spinning cubes, one entity each, drawn through the
+// ECS RenderSystem as a single instanced draw
+class InstancingApp : public Application {
+public:
+    InstancingApp(uint32_t cubeCount, bool culling, bool gpuCulling, const ApplicationSettings& settings)
+        : Application("Instancing", 800, 600, settings), m_CubeCount(cubeCount), m_Culling(culling),
+          m_GPUCulling(gpuCulling) {}
+
+private:
+    Renderer::Renderer3D renderer;
+    std::shared_ptr<Renderer::Camera> camera;
+    ECS::RenderSystem renderSystem;
+    uint32_t m_CubeCount;
+    bool m_Culling;
+    bool m_GPUCulling;
+
+protected:
+    void OnInit() override {
+        renderer.Init();
+        renderer.SetFrustumCulling(m_Culling);
+        renderer.SetGPUCulling(m_GPUCulling);
+
+        uint32_t side = static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<float>(m_CubeCount))));
+        float spacing = 1.5f;
+        float extent = side * spacing;
+
+        // Far enough back to see the whole grid
+        camera = std::make_shared<Renderer::Camera>(45.0f, 800.0f / 600.0f, 0.1f, extent * 4.0f);
+        camera->SetPosition({0.0f, 0.0f, extent * 1.6f});
+        renderer.SetCamera(camera);
+
+        auto cube = Renderer::MeshLibrary::Cube();
+        auto material = std::make_shared<Assets::Material>();
+
+        auto& registry = ECS::ECSManager::GetRegistry();
+        for (uint32_t i = 0; i < m_CubeCount; ++i) {
+            uint32_t x = i % side, y = (i / side) % side, z = i / (side * side);
+
+            auto entity = registry.create();
+            auto& transform = registry.emplace<ECS::Transform>(entity);
+            transform.position = Vector3(x * spacing, y * spacing, z * spacing) - Vector3(extent * 0.5f);
+            transform.scale = Vector3(0.8f);
+
+            // Color the grid by position
+            registry.emplace<ECS::MeshRenderer>(entity, cube, material,
+                Vector4(float(x) / side, float(y) / side, float(z) / side, 1.0f));
+            registry.emplace<Spin>(entity, Vector3(20.0f + (i % 7) * 10.0f, 30.0f + (i % 5) * 15.0f, 0.0f));
+        }
+        KOSMIC_INFO("[Instancing] Created {} cubes", m_CubeCount);
+    }
+
+    void OnUpdate(float deltaTime) override {
+        auto& registry = ECS::ECSManager::GetRegistry();
+        registry.view<ECS::Transform, const Spin>().each([deltaTime](ECS::Transform& transform, const Spin& spin) {
+            transform.rotation += spin.speed * deltaTime;
+        });
+    }
+
+    void OnRender(float /*alpha*/) override {
+        renderSystem.Submit(ECS::ECSManager::GetRegistry(), renderer);
+        renderer.Render();
+    }
+
+    void OnCleanup() override {
+        if (renderer.IsGPUCullingEnabled()) {
+            const auto& stats = renderer.GetGPUCullingStats();
+            KOSMIC_INFO("[Instancing] GPU culling, {} frames ago: {} visible, {} outside the frustum, {} occluded",
+                        stats.latency, stats.visible, stats.frustumCulled, stats.occluded);
+        } else {
+            KOSMIC_INFO("[Instancing] Last frame: {} visible, {} culled", renderSystem.GetVisibleCount(),
+                        renderSystem.GetCulledCount());
+        }
+        ECS::ECSManager::GetRegistry().clear();
+    }
+};
+
+int main(int argc, char** argv) {
+    Log::Init();
+
+    // --count, --no-culling and --gpu-culling are ours, everything else goes to the application
+    uint32_t cubeCount = 100'000;
+    bool culling = true;
+    bool gpuCulling = false;
+    std::vector<char*> args{argv[0]};
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+            cubeCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--no-culling") == 0)
+            culling = false;
+        else if (std::strcmp(argv[i], "--gpu-culling") == 0)
+            gpuCulling = true;
+        else
+            args.push_back(argv[i]);
+    }
+
+    InstancingApp app(cubeCount, culling, gpuCulling, ApplicationSettings::FromCommandLine(static_cast<int>(args.size()), args.data()));
+    app.Run();
+    return 0;
+}
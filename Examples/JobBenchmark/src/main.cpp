@@ -0,0 +1,135 @@
+#include "Kosmic/Core/Jobs.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace Kosmic;
+
+// JobBenchmark: stress test for the job system, reports the scheduling
+// overhead per job and ParallelFor scaling
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedNs(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+// Empty jobs submitted from the main thread and drained by the workers
+void BenchmarkEmptyJobs(uint32_t jobCount) {
+    std::atomic<uint32_t> executed{0};
+    Jobs::Counter counter;
+
+    auto start = Clock::now();
+    for (uint32_t i = 0; i < jobCount; ++i)
+        Jobs::Run([&executed] { executed.fetch_add(1, std::memory_order_relaxed); }, &counter);
+    Jobs::Wait(counter);
+    double ns = ElapsedNs(start);
+
+    KOSMIC_INFO("[JobBenchmark] Empty jobs (main thread): {} jobs, {:.1f} ns/job, {:.2f} M jobs/s",
+                executed.load(), ns / jobCount, jobCount / ns * 1e3);
+}
+
+// Every worker spawns its own children, exercising local pushes and stealing
+void BenchmarkFanOut(uint32_t jobCount) {
+    uint32_t roots = std::max(1u, Jobs::GetWorkerCount()) * 4;
+    uint32_t childrenPerRoot = jobCount / roots;
+    std::atomic<uint32_t> executed{0};
+    Jobs::Counter counter;
+
+    auto start = Clock::now();
+    for (uint32_t r = 0; r < roots; ++r) {
+        Jobs::Run([&] {
+            for (uint32_t i = 0; i < childrenPerRoot; ++i)
+                Jobs::Run([&executed] { executed.fetch_add(1, std::memory_order_relaxed); }, &counter);
+        }, &counter);
+    }
+    Jobs::Wait(counter);
+    double ns = ElapsedNs(start);
+
+    uint32_t total = roots * childrenPerRoot + roots;
+    KOSMIC_INFO("[JobBenchmark] Fan-out from workers: {} jobs, {:.1f} ns/job, {:.2f} M jobs/s",
+                total, ns / total, total / ns * 1e3);
+}
+
+// A chain where every job depends on the previous one, measures hand-off latency
+void BenchmarkDependencyChain(uint32_t length) {
+    std::vector<std::unique_ptr<Jobs::Counter>> counters;
+    counters.reserve(length);
+    for (uint32_t i = 0; i < length; ++i)
+        counters.push_back(std::make_unique<Jobs::Counter>());
+
+    std::atomic<uint32_t> order{0};
+    std::atomic<bool> inOrder{true};
+
+    auto start = Clock::now();
+    Jobs::Run([&order] { order.fetch_add(1); }, counters[0].get());
+    for (uint32_t i = 1; i < length; ++i) {
+        Jobs::RunAfter(*counters[i - 1], [&order, &inOrder, i] {
+            if (order.fetch_add(1) != i) inOrder = false;
+        }, counters[i].get());
+    }
+    Jobs::Wait(*counters.back());
+    double ns = ElapsedNs(start);
+
+    KOSMIC_INFO("[JobBenchmark] Dependency chain: {} jobs, {:.1f} ns/hop, order {}",
+                length, ns / length, inOrder.load() ? "ok" : "BROKEN");
+}
+
+// Data-parallel loop with several grain sizes against a serial baseline
+void BenchmarkParallelFor(uint32_t elementCount) {
+    std::vector<float> data(elementCount);
+    for (uint32_t i = 0; i < elementCount; ++i)
+        data[i] = static_cast<float>(i);
+
+    auto kernel = [&data](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i)
+            data[i] = std::sqrt(data[i] * 1.0001f + 1.0f);
+    };
+
+    auto start = Clock::now();
+    kernel(0, elementCount);
+    double serialNs = ElapsedNs(start);
+    KOSMIC_INFO("[JobBenchmark] ParallelFor serial baseline: {} elements, {:.2f} ms", elementCount, serialNs / 1e6);
+
+    for (uint32_t grain : {256u, 4096u, 65536u}) {
+        start = Clock::now();
+        Jobs::ParallelFor(elementCount, grain, kernel);
+        double ns = ElapsedNs(start);
+        KOSMIC_INFO("[JobBenchmark] ParallelFor grain {:>6}: {:.2f} ms, speedup {:.2f}x, {} chunks",
+                    grain, ns / 1e6, serialNs / ns, (elementCount + grain - 1) / grain);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Log::Init();
+
+    uint32_t jobCount = 1'000'000;
+    uint32_t workers = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+            jobCount = std::max(1u, static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)));
+        else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc)
+            workers = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    }
+
+    Jobs::Init(workers);
+    KOSMIC_INFO("[JobBenchmark] {} workers + main thread", Jobs::GetWorkerCount());
+
+    BenchmarkEmptyJobs(jobCount);
+    BenchmarkFanOut(jobCount);
+    // At least one hop, so small --jobs values still run the chain
+    BenchmarkDependencyChain(std::max(1u, jobCount / 100));
+    BenchmarkParallelFor(jobCount * 16);
+
+    Jobs::Shutdown();
+    return 0;
+}
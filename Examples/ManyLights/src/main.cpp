@@ -0,0 +1,143 @@
+#include "Kosmic/Core/Application.hpp"
+#include "Kosmic/Renderer/Renderer3D.hpp"
+#include "Kosmic/Renderer/Mesh.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include "Kosmic/Core/Math/Math.hpp"
+#include "Kosmic/Assets/Material.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace Kosmic;
+using namespace Kosmic::Math;
+
+// ManyLightsApp: a floor and a forest of pillars lit by thousands of moving
+// point and spot lights, through the clustered light lists
+class ManyLightsApp : public Application {
+public:
+    ManyLightsApp(uint32_t lightCount, uint32_t rampFrames, const ApplicationSettings& settings)
+        : Application("ManyLights", 800, 600, settings), m_LightCount(lightCount), m_RampFrames(rampFrames) {}
+
+private:
+    // Circles around its center, every fourth one is a spot light facing down
+    struct MovingLight {
+        Vector3 center;
+        Vector3 color;
+        float orbit;
+        float speed;
+        float phase;
+        bool spot;
+    };
+
+    Renderer::Renderer3D renderer;
+    std::shared_ptr<Renderer::Camera> camera;
+    std::shared_ptr<Renderer::Mesh> cube;
+    std::shared_ptr<Assets::Material> material;
+    std::vector<MovingLight> m_Lights;
+    std::vector<Mat4> m_Pillars;
+    Mat4 m_Floor{1.0f};
+    uint32_t m_LightCount;
+    uint32_t m_RampFrames;
+    uint32_t m_Frame{0};
+    float m_Time{0.0f};
+
+protected:
+    void OnInit() override {
+        renderer.Init();
+        // Dim, so the point lights carry the scene
+        renderer.SetAmbientLight({Vector3(1.0f), 0.08f});
+        renderer.SetDirectionalLight({Vector3(-0.2f, -1.0f, -0.3f), Vector3(1.0f), 0.05f});
+
+        // The area grows with the light count, keeping the density per cluster similar
+        float extent = std::max(20.0f, std::sqrt(static_cast<float>(m_LightCount)) * 2.0f);
+
+        camera = std::make_shared<Renderer::Camera>(60.0f, 800.0f / 600.0f, 0.1f, extent * 2.0f);
+        camera->SetPosition({0.0f, extent * 0.25f, extent * 0.6f});
+        camera->SetRotation(-25.0f, -90.0f);
+        renderer.SetCamera(camera);
+
+        cube = Renderer::MeshLibrary::Cube();
+        material = std::make_shared<Assets::Material>();
+        material->diffuse = Vector3(0.8f);
+
+        m_Floor = glm::scale(glm::translate(Mat4(1.0f), glm::vec3(0.0f, -0.5f, 0.0f)),
+                             glm::vec3(extent * 2.0f, 1.0f, extent * 2.0f));
+        for (float x = -extent; x <= extent; x += 4.0f) {
+            for (float z = -extent; z <= extent; z += 4.0f) {
+                Mat4 pillar = glm::translate(Mat4(1.0f), glm::vec3(x, 1.0f, z));
+                m_Pillars.push_back(glm::scale(pillar, glm::vec3(0.6f, 2.0f, 0.6f)));
+            }
+        }
+
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> position(-extent, extent), height(0.3f, 2.5f);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f), orbit(0.5f, 3.0f);
+        m_Lights.reserve(m_LightCount);
+        for (uint32_t i = 0; i < m_LightCount; ++i) {
+            Vector3 color(0.2f + 0.8f * unit(random), 0.2f + 0.8f * unit(random), 0.2f + 0.8f * unit(random));
+            m_Lights.push_back({{position(random), height(random), position(random)}, color, orbit(random),
+                                0.3f + unit(random), unit(random) * 2.0f * PI, i % 4 == 3});
+        }
+        KOSMIC_INFO("[ManyLights] {} lights, {} pillars{}", m_LightCount, m_Pillars.size(),
+                    m_RampFrames ? " (ramping up)" : "");
+    }
+
+    void OnUpdate(float deltaTime) override {
+        m_Time += deltaTime;
+    }
+
+    void OnRender(float /*alpha*/) override {
+        renderer.Submit(cube, material, m_Floor);
+        for (const Mat4& pillar : m_Pillars)
+            renderer.Submit(cube, material, pillar);
+
+        // With --ramp the count grows from none to all over that many frames
+        uint32_t count = m_LightCount;
+        if (m_RampFrames > 0)
+            count = static_cast<uint32_t>(uint64_t(m_LightCount) * std::min(m_Frame, m_RampFrames) / m_RampFrames);
+        for (uint32_t i = 0; i < count; ++i) {
+            const MovingLight& light = m_Lights[i];
+            float angle = m_Time * light.speed + light.phase;
+            Vector3 position = light.center + Vector3(std::cos(angle), 0.0f, std::sin(angle)) * light.orbit;
+            if (light.spot)
+                renderer.SubmitSpotLight({position + Vector3(0.0f, 2.0f, 0.0f), Vector3(0.0f, -1.0f, 0.0f),
+                                          light.color, 8.0f, 6.0f, std::cos(Deg2Rad(25.0f)),
+                                          std::cos(Deg2Rad(35.0f))});
+            else
+                renderer.SubmitPointLight({position, light.color, 3.0f, 4.0f});
+        }
+        renderer.Render();
+        m_Frame++;
+    }
+
+    void OnCleanup() override {
+        const auto& stats = renderer.GetLightStats();
+        KOSMIC_INFO("[ManyLights] Last frame: {} lights, {} visible, {} cluster entries, at most {} per cluster",
+                    stats.lights, stats.visibleLights, stats.lightIndices, stats.maxClusterLights);
+        m_Lights.clear();
+    }
+};
+
+int main(int argc, char** argv) {
+    Log::Init();
+
+    // --lights and --ramp are ours, everything else goes to the application
+    uint32_t lightCount = 2048;
+    uint32_t rampFrames = 0;
+    std::vector<char*> args{argv[0]};
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--lights") == 0 && i + 1 < argc)
+            lightCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--ramp") == 0 && i + 1 < argc)
+            rampFrames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else
+            args.push_back(argv[i]);
+    }
+
+    ManyLightsApp app(lightCount, rampFrames, ApplicationSettings::FromCommandLine(static_cast<int>(args.size()), args.data()));
+    app.Run();
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include "Kosmic/Core/Application.hpp"
+#include "Kosmic/Renderer/Renderer3D.hpp"
+#include "Kosmic/Renderer/GeometryPool.hpp"
+#include "Kosmic/Renderer/Mesh.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include "Kosmic/Core/Math/Math.hpp"
+#include "Kosmic/Assets/Material.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace Kosmic;
+using namespace Kosmic::Math;
+
+// A lumpy sphere; every rock gets its own shape and vertex count
+std::shared_ptr<Renderer::Mesh> MakeRock(std::mt19937& random) {
+    std::uniform_int_distribution<uint32_t> segments(6, 16);
+    std::uniform_real_distribution<float> phase(0.0f, 2.0f * PI), amount(0.05f, 0.25f);
+    uint32_t sectors = segments(random), stacks = segments(random) / 2 + 2;
+    float phaseX = phase(random), phaseY = phase(random), bumps = amount(random);
+
+    std::vector<Renderer::Vertex> vertices;
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i <= stacks; ++i) {
+        float stackAngle = PI / 2 - i * PI / stacks;
+        for (uint32_t j = 0; j <= sectors; ++j) {
+            float sectorAngle = j * 2 * PI / sectors;
+            Vector3 normal(std::cos(stackAngle) * std::cos(sectorAngle), std::cos(stackAngle) * std::sin(sectorAngle),
+                           std::sin(stackAngle));
+            float radius = 1.0f + bumps * std::sin(3.0f * sectorAngle + phaseX) * std::cos(2.0f * stackAngle + phaseY);
+
+            Renderer::Vertex vertex;
+            vertex.Position = normal * (radius * 0.5f);
+            vertex.Normal = normal;
+            vertex.TexCoords = {float(j) / sectors, float(i) / stacks};
+            vertex.Color = {1.0f, 1.0f, 1.0f};
+            vertices.push_back(vertex);
+        }
+    }
+    for (uint32_t i = 0; i < stacks; ++i) {
+        uint32_t k1 = i * (sectors + 1), k2 = k1 + sectors + 1;
+        for (uint32_t j = 0; j < sectors; ++j, ++k1, ++k2) {
+            if (i != 0) indices.insert(indices.end(), {k1, k2, k1 + 1});
+            if (i != stacks - 1) indices.insert(indices.end(), {k1 + 1, k2, k2 + 1});
+        }
+    }
+    return std::make_shared<Renderer::Mesh>(vertices, indices);
+}
+
+// MultiDrawApp: a field of distinct meshes, each submitted as its own draw.
+// With the geometry pool they share one VAO and go out as a few multi-draws.
+class MultiDrawApp : public Application {
+public:
+    MultiDrawApp(uint32_t meshCount, const ApplicationSettings& settings)
+        : Application("MultiDraw", 800, 600, settings), m_MeshCount(meshCount) {}
+
+private:
+    struct Rock {
+        std::shared_ptr<Renderer::Mesh> mesh;
+        std::shared_ptr<Assets::Material> material;
+        Vector3 position;
+        float spin;
+    };
+
+    Renderer::Renderer3D renderer;
+    std::shared_ptr<Renderer::Camera> camera;
+    std::vector<Rock> m_Rocks;
+    uint32_t m_MeshCount;
+    float m_Time{0.0f};
+
+protected:
+    void OnInit() override {
+        renderer.Init();
+
+        uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(m_MeshCount))));
+        float spacing = 1.5f;
+        float extent = side * spacing;
+
+        camera = std::make_shared<Renderer::Camera>(45.0f, 800.0f / 600.0f, 0.1f, extent * 4.0f);
+        camera->SetPosition({0.0f, extent * 0.5f, extent * 0.9f});
+        camera->SetRotation(-30.0f, -90.0f);
+        renderer.SetCamera(camera);
+
+        // A handful of colors, so materials are shared like in a real scene
+        std::vector<std::shared_ptr<Assets::Material>> materials;
+        for (int i = 0; i < 8; ++i) {
+            auto material = std::make_shared<Assets::Material>();
+            material->diffuse = Vector3(0.4f + 0.08f * i, 0.35f + 0.05f * (i % 3), 0.3f + 0.07f * (7 - i));
+            materials.push_back(material);
+        }
+
+        std::mt19937 random(1234);
+        m_Rocks.reserve(m_MeshCount);
+        for (uint32_t i = 0; i < m_MeshCount; ++i) {
+            Vector3 position(float(i % side) * spacing - extent * 0.5f, 0.0f, float(i / side) * spacing - extent * 0.5f);
+            m_Rocks.push_back({MakeRock(random), materials[i % materials.size()], position, 10.0f + (i % 9) * 10.0f});
+        }
+
+        auto stats = Renderer::GeometryPool::GetStats();
+        KOSMIC_INFO("[MultiDraw] Created {} meshes, {} in {} pool pages ({:.1f} of {:.1f} MB)", m_MeshCount,
+                    stats.allocations, stats.pages, stats.usedBytes / 1048576.0, stats.capacityBytes / 1048576.0);
+    }
+
+    void OnUpdate(float deltaTime) override {
+        m_Time += deltaTime;
+    }
+
+    void OnRender(float /*alpha*/) override {
+        for (const Rock& rock : m_Rocks) {
+            Mat4 transform = glm::translate(Mat4(1.0f), glm::vec3(rock.position.x, rock.position.y, rock.position.z));
+            transform = glm::rotate(transform, glm::radians(rock.spin * m_Time), glm::vec3(0.0f, 1.0f, 0.0f));
+            renderer.Submit(rock.mesh, rock.material, transform);
+        }
+        renderer.Render();
+    }
+
+    void OnCleanup() override {
+        const auto& stats = renderer.GetQueueStats();
+        KOSMIC_INFO("[MultiDraw] Last frame: {} draws in {} draw calls ({} multi-draw), {} VAO binds, {} culled",
+                    stats.draws, stats.drawCalls, stats.multiDraws, stats.meshBinds, stats.culled);
+        m_Rocks.clear();
+    }
+};
+
+int main(int argc, char** argv) {
+    Log::Init();
+
+    // --count, --no-pool and --no-mdi are ours, everything else goes to the application
+    uint32_t meshCount = 5000;
+    std::vector<char*> args{argv[0]};
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+            meshCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--no-pool") == 0)
+            Renderer::GeometryPool::SetEnabled(false);
+        else if (std::strcmp(argv[i], "--no-mdi") == 0)
+            Renderer::GeometryPool::SetMultiDrawIndirect(false);
+        else
+            args.push_back(argv[i]);
+    }
+
+    MultiDrawApp app(meshCount, ApplicationSettings::FromCommandLine(static_cast<int>(args.size()), args.data()));
+    app.Run();
+    return 0;
+}
@@ -0,0 +1,191 @@
+#include "Kosmic/Core/Application.hpp"
+#include "Kosmic/Renderer/Renderer3D.hpp"
+#include "Kosmic/Renderer/Mesh.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include "Kosmic/Core/Input.hpp"
+#include "Kosmic/Core/Math/Math.hpp"
+#include "Kosmic/Assets/Material.hpp"
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace Kosmic;
+using namespace Kosmic::Math;
+
+// How hidden draws are found, O cycles through them at runtime
+enum class OcclusionMode { Off, CPU, Queries, Count };
+
+const char* GetModeName(OcclusionMode mode) {
+    switch (mode) {
+        case OcclusionMode::CPU: return "CPU rasterizer";
+        case OcclusionMode::Queries: return "hardware queries";
+        default: return "off";
+    }
+}
+
+// OcclusionApp: a walk down the street of a city of box buildings, with
+// lots of small props scattered between and behind them. The buildings are
+// also the occluders for the CPU culler; hardware queries need none.
+class OcclusionApp : public Application {
+public:
+    OcclusionApp(OcclusionMode mode, const ApplicationSettings& settings)
+        : Application("Occlusion", 800, 600, settings), m_Mode(mode) {}
+
+private:
+    Renderer::Renderer3D renderer;
+    std::shared_ptr<Renderer::Camera> camera;
+    std::shared_ptr<Renderer::Mesh> cube;
+    std::shared_ptr<Assets::Material> buildingMaterial;
+    std::shared_ptr<Assets::Material> propMaterial;
+    Renderer::OccluderMesh m_BoxOccluder;  // The unit cube, shared by every building
+    std::vector<Mat4> m_Buildings;
+    std::vector<Mat4> m_Props;
+    Mat4 m_Ground{1.0f};
+    OcclusionMode m_Mode;
+    bool m_SwitchHeld{false};
+    float m_Time{0.0f};
+
+    // Totals over the run, for the summary on exit
+    uint64_t m_Tested{0};
+    uint64_t m_Occluded{0};
+    double m_RasterTime{0.0};
+    double m_TestTime{0.0};
+    uint64_t m_Queries{0};
+    uint32_t m_CPUFrames{0};
+    uint32_t m_QueryFrames{0};
+
+protected:
+    void OnInit() override {
+        renderer.Init();
+        SetMode(m_Mode);
+        renderer.SetAmbientLight({Vector3(1.0f), 0.3f});
+        renderer.SetDirectionalLight({Vector3(-0.3f, -1.0f, -0.4f), Vector3(1.0f), 0.8f});
+
+        camera = std::make_shared<Renderer::Camera>(60.0f, 800.0f / 600.0f, 0.1f, 400.0f);
+        camera->SetPosition({0.0f, 1.7f, 0.0f});
+        renderer.SetCamera(camera);
+
+        cube = Renderer::MeshLibrary::Cube();
+        buildingMaterial = std::make_shared<Assets::Material>();
+        buildingMaterial->diffuse = Vector3(0.6f, 0.6f, 0.65f);
+        propMaterial = std::make_shared<Assets::Material>();
+        propMaterial->diffuse = Vector3(0.9f, 0.5f, 0.2f);
+
+        constexpr int Blocks = 12;
+        constexpr float BlockSize = 20.0f, Street = 8.0f;
+        constexpr float Extent = Blocks * (BlockSize + Street) * 0.5f;
+        m_Ground = glm::scale(glm::translate(Mat4(1.0f), glm::vec3(0.0f, -0.5f, 0.0f)),
+                              glm::vec3(Extent * 2.0f, 1.0f, Extent * 2.0f));
+
+        std::mt19937 random(4321);
+        std::uniform_real_distribution<float> height(8.0f, 40.0f), unit(0.0f, 1.0f);
+        // The cube mesh spans -0.5 to 0.5, so one box occluder placed with
+        // each building's transform covers it exactly
+        m_BoxOccluder = Renderer::OccluderMesh::Box({{-0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, 0.5f}});
+        for (int bx = 0; bx < Blocks; ++bx) {
+            for (int bz = 0; bz < Blocks; ++bz) {
+                float x = -Extent + Street + bx * (BlockSize + Street) + BlockSize * 0.5f;
+                float z = -Extent + Street + bz * (BlockSize + Street) + BlockSize * 0.5f;
+                float h = height(random);
+                Mat4 transform = glm::scale(glm::translate(Mat4(1.0f), glm::vec3(x, h * 0.5f, z)),
+                                            glm::vec3(BlockSize, h, BlockSize));
+                m_Buildings.push_back(transform);
+
+                // Props on the pavement around the block
+                for (int i = 0; i < 48; ++i) {
+                    float along = (unit(random) - 0.5f) * (BlockSize + Street * 0.5f);
+                    float side = (BlockSize + Street * 0.5f) * 0.5f * (unit(random) < 0.5f ? -1.0f : 1.0f);
+                    glm::vec3 offset = unit(random) < 0.5f ? glm::vec3(along, 0.0f, side) : glm::vec3(side, 0.0f, along);
+                    float size = 0.3f + unit(random) * 0.7f;
+                    m_Props.push_back(glm::scale(glm::translate(Mat4(1.0f), glm::vec3(x, size * 0.5f, z) + offset),
+                                                 glm::vec3(size)));
+                }
+            }
+        }
+        KOSMIC_INFO("[Occlusion] {} buildings, {} props, occlusion {} ({} kernel), O to switch",
+                    m_Buildings.size(), m_Props.size(), GetModeName(m_Mode),
+                    Renderer::OcclusionCuller::GetKernelName());
+    }
+
+    void SetMode(OcclusionMode mode) {
+        m_Mode = mode;
+        renderer.SetOcclusionCulling(mode == OcclusionMode::CPU);
+        renderer.SetOcclusionQueries(mode == OcclusionMode::Queries);
+    }
+
+    void OnUpdate(float deltaTime) override {
+        m_Time += deltaTime;
+        // Down the street and back, looking along it
+        float z = std::sin(m_Time * 0.1f) * 120.0f;
+        camera->SetPosition({2.0f, 1.7f, z});
+        camera->SetRotation(0.0f, -90.0f + std::sin(m_Time * 0.3f) * 30.0f);
+
+        bool switchHeld = Input::IsKeyPressed(SDLK_o);
+        if (switchHeld && !m_SwitchHeld) {
+            SetMode(static_cast<OcclusionMode>((static_cast<int>(m_Mode) + 1) % static_cast<int>(OcclusionMode::Count)));
+            KOSMIC_INFO("[Occlusion] Occlusion {}", GetModeName(m_Mode));
+        }
+        m_SwitchHeld = switchHeld;
+    }
+
+    void OnRender(float /*alpha*/) override {
+        renderer.Submit(cube, buildingMaterial, m_Ground);
+        for (const Mat4& building : m_Buildings) {
+            renderer.Submit(cube, buildingMaterial, building);
+            renderer.SubmitOccluder(m_BoxOccluder, building);
+        }
+        for (const Mat4& prop : m_Props)
+            renderer.Submit(cube, propMaterial, prop);
+        renderer.Render();
+
+        if (m_Mode == OcclusionMode::CPU) {
+            const auto& stats = renderer.GetOcclusionStats();
+            m_Tested += stats.tested;
+            m_Occluded += stats.occluded;
+            m_RasterTime += stats.rasterTime;
+            m_TestTime += stats.testTime;
+            m_CPUFrames++;
+        } else if (m_Mode == OcclusionMode::Queries) {
+            const auto& stats = renderer.GetOcclusionQueryStats();
+            m_Tested += stats.tested;
+            m_Occluded += stats.hidden;
+            m_Queries += stats.issued;
+            m_QueryFrames++;
+        }
+    }
+
+    void OnCleanup() override {
+        if (m_Tested > 0)
+            KOSMIC_INFO("[Occlusion] {:.1f}% of tested draws occluded", 100.0 * m_Occluded / m_Tested);
+        if (m_CPUFrames > 0)
+            KOSMIC_INFO("[Occlusion] CPU: {:.3f} ms raster + {:.3f} ms test per frame", m_RasterTime / m_CPUFrames,
+                        m_TestTime / m_CPUFrames);
+        if (m_QueryFrames > 0)
+            KOSMIC_INFO("[Occlusion] Queries: {:.1f} issued per frame", double(m_Queries) / m_QueryFrames);
+        m_Buildings.clear();
+        m_Props.clear();
+    }
+};
+
+int main(int argc, char** argv) {
+    Log::Init();
+
+    // --occlusion off|cpu|queries is ours, everything else goes to the application
+    OcclusionMode mode = OcclusionMode::CPU;
+    std::vector<char*> args{argv[0]};
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--occlusion") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            mode = std::strcmp(name, "off") == 0     ? OcclusionMode::Off
+                 : std::strcmp(name, "queries") == 0 ? OcclusionMode::Queries
+                                                     : OcclusionMode::CPU;
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+
+    OcclusionApp app(mode, ApplicationSettings::FromCommandLine(static_cast<int>(args.size()), args.data()));
+    app.Run();
+    return 0;
+}
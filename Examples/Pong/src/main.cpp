@@ -5,6 +5,7 @@
 #include "Kosmic/Core/Logging.hpp"
 #include "Kosmic/Core/Input.hpp"
 #include "Kosmic/Core/Math/Math.hpp"
+#include "Kosmic/Assets/Material.hpp"
 
 using namespace Kosmic;
 using namespace Kosmic::Renderer;
@@ -13,17 +14,21 @@ using namespace Kosmic::Math;
 // PongApp: Implements a classic Pong game using Kosmic Engine
 class PongApp : public Application {
 public:
-    PongApp() : Application("Pong", 800, 600) {}
+    PongApp(const ApplicationSettings& settings) : Application("Pong", 800, 600, settings) {}
 
 private:
     Renderer3D renderer;
     std::shared_ptr<Camera> camera;
     
-    // Meshes for paddles and ball
-    std::shared_ptr<Mesh> leftPaddle;
-    std::shared_ptr<Mesh> rightPaddle;
+    // Meshes for paddles and ball, both paddles share one mesh
+    std::shared_ptr<Mesh> paddle;
     std::shared_ptr<Mesh> ball;
 
+    // Colors of the game objects
+    std::shared_ptr<Assets::Material> leftPaddleMaterial;
+    std::shared_ptr<Assets::Material> rightPaddleMaterial;
+    std::shared_ptr<Assets::Material> ballMaterial;
+
     // Game parameters (in world units)
     float gameWidth = 10.0f;
     float gameHeight = 8.0f;
@@ -37,6 +42,11 @@ private:
     Vector3 ballPos;
     Vector3 ballVel;  // velocity for ball
 
+    // Positions before the last update, for interpolating between steps
+    Vector3 prevLeftPaddlePos;
+    Vector3 prevRightPaddlePos;
+    Vector3 prevBallPos;
+
     // Paddle movement speed (units per second)
     float paddleSpeed = 5.0f;
     // Ball speed multiplier
@@ -56,22 +66,21 @@ protected:
         renderer.SetCamera(camera);
 
         // Create game objects
-        leftPaddle = MeshLibrary::Cube();
-        rightPaddle = MeshLibrary::Cube();
+        paddle = MeshLibrary::Cube();
         ball = MeshLibrary::Sphere();
 
+        leftPaddleMaterial = std::make_shared<Assets::Material>();
+        leftPaddleMaterial->diffuse = {1.0f, 0.2f, 0.2f}; // Red for left paddle
+        rightPaddleMaterial = std::make_shared<Assets::Material>();
+        rightPaddleMaterial->diffuse = {0.2f, 0.2f, 1.0f}; // Blue for right paddle
+        ballMaterial = std::make_shared<Assets::Material>(); // White for ball
+
         // Set initial game state
         ResetGameState();
 
         // Configure light
-        auto shader = renderer.GetShader();
-        shader->Bind();
-        shader->SetVec3("u_AmbientLightColor", Vector3(1.0f, 1.0f, 1.0f));
-        shader->SetFloat("u_AmbientLightIntensity", 0.7f);
-        shader->SetVec3("u_DirLightDirection", Vector3(-0.2f, -1.0f, -0.3f));
-        shader->SetVec3("u_DirLightColor", Vector3(1.0f, 1.0f, 1.0f));
-        shader->SetFloat("u_DirLightIntensity", 0.3f);
-        shader->Unbind();
+        renderer.SetAmbientLight({Vector3(1.0f, 1.0f, 1.0f), 0.7f});
+        renderer.SetDirectionalLight({Vector3(-0.2f, -1.0f, -0.3f), Vector3(1.0f, 1.0f, 1.0f), 0.3f});
         
         KOSMIC_INFO("[Pong] Initialization complete");
     }
@@ -87,10 +96,18 @@ private:
         float angle = (std::rand() % 120 - 60) * (PI / 180.0f); // Random angle between -60 and 60 degrees
         ballVel = Vector3(std::cos(angle), std::sin(angle), 0.0f) * ballSpeed;
         if (std::rand() % 2) ballVel.x = -ballVel.x; // Random initial direction
+
+        prevLeftPaddlePos = leftPaddlePos;
+        prevRightPaddlePos = rightPaddlePos;
+        prevBallPos = ballPos;
     }
 
     // Update game logic
     void OnUpdate(float deltaTime) override {
+        prevLeftPaddlePos = leftPaddlePos;
+        prevRightPaddlePos = rightPaddlePos;
+        prevBallPos = ballPos;
+
         // Left Paddle control (W and S keys)
         if (Input::IsKeyPressed(SDLK_w))
             leftPaddlePos.y += paddleSpeed * deltaTime;
@@ -138,54 +155,38 @@ private:
             ballPos = Vector3(0.0f, 0.0f, 0.0f);
             // Restart ball with opposite direction
             ballVel = Normalize(Vector3(-ballVel.x, ballVel.y, 0.0f)) * ballSpeed;
+            prevBallPos = ballPos; // Don't interpolate across the reset
         }
     }
 
     // Render game objects
-    void OnRender() override {
-        // Clear the screen (the renderer's Render will clear buffers)
+    void OnRender(float alpha) override {
+        // Draw between the last two simulation steps
+        Vector3 leftPos = Lerp(prevLeftPaddlePos, leftPaddlePos, alpha);
+        Vector3 rightPos = Lerp(prevRightPaddlePos, rightPaddlePos, alpha);
+        Vector3 ballDrawPos = Lerp(prevBallPos, ballPos, alpha);
+
+        // Transforms: scale then translate
+        Mat4 leftPaddleTransform = Scale(Translate(Mat4(1.0f), { leftPos.x, leftPos.y, 0.0f }), { paddleWidth, paddleHeight, 1.0f });
+        Mat4 rightPaddleTransform = Scale(Translate(Mat4(1.0f), { rightPos.x, rightPos.y, 0.0f }), { paddleWidth, paddleHeight, 1.0f });
+        Mat4 ballTransform = Scale(Translate(Mat4(1.0f), { ballDrawPos.x, ballDrawPos.y, 0.0f }), { ballSize, ballSize, 1.0f });
+
+        renderer.Submit(paddle, leftPaddleMaterial, leftPaddleTransform);
+        renderer.Submit(paddle, rightPaddleMaterial, rightPaddleTransform);
+        renderer.Submit(ball, ballMaterial, ballTransform);
+
+        // Clears the screen and draws the submitted objects
         renderer.Render();
-
-        // Get the shader from renderer and bind it for manual drawing
-        auto shader = renderer.GetShader();
-        shader->Bind();
-        // Set view and projection matrices from camera
-        shader->SetMat4("view", camera->GetViewMatrix());
-        shader->SetMat4("projection", camera->GetProjectionMatrix());
-        shader->SetInt("u_Texture", 0); // default texture unit
-
-        // Left Paddle transform: scale then translate
-        Mat4 leftPaddleTransform = Scale(Translate(Mat4(1.0f), { leftPaddlePos.x, leftPaddlePos.y, 0.0f }), { paddleWidth, paddleHeight, 1.0f });
-        leftPaddle->SetTransform(leftPaddleTransform);
-        shader->SetMat4("model", leftPaddleTransform);
-        shader->SetVec4("u_Color", Math::Vector4(1.0f, 0.2f, 0.2f, 1.0f)); // Red for left paddle
-        leftPaddle->Draw();
-
-        // Right Paddle transform
-        Mat4 rightPaddleTransform = Scale(Translate(Mat4(1.0f), { rightPaddlePos.x, rightPaddlePos.y, 0.0f }), { paddleWidth, paddleHeight, 1.0f });
-        rightPaddle->SetTransform(rightPaddleTransform);
-        shader->SetMat4("model", rightPaddleTransform);
-        shader->SetVec4("u_Color", Math::Vector4(0.2f, 0.2f, 1.0f, 1.0f)); // Blue for right paddle
-        rightPaddle->Draw();
-
-        // Ball transform
-        Mat4 ballTransform = Scale(Translate(Mat4(1.0f), { ballPos.x, ballPos.y, 0.0f }), { ballSize, ballSize, 1.0f });
-        ball->SetTransform(ballTransform);
-        shader->SetMat4("model", ballTransform);
-        shader->SetVec4("u_Color", Math::Vector4(1.0f, 1.0f, 1.0f, 1.0f)); // White for ball
-        ball->Draw();
-
-        shader->Unbind();
     }
 
     // Cleanup
     void OnCleanup() override {}
 };
 
-int main() {
+int main(int argc, char** argv) {
     Log::Init();
     KOSMIC_INFO("[Pong] Starting PongApp...");
-    PongApp app;
+    PongApp app(ApplicationSettings::FromCommandLine(argc, argv));
     app.Run();
     KOSMIC_INFO("[Pong] PongApp terminated.");
     return 0;
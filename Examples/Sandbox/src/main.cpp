@@ -7,18 +7,18 @@
 #include "Kosmic/Renderer/Lighting.hpp"
 #include "Kosmic/Core/Input.hpp"
 #include "Kosmic/Assets/Model.hpp"
+#include "Kosmic/Assets/AssetManager.hpp"
 #include "Kosmic/ECS/ECS.hpp"
 
 using namespace Kosmic;
 
 class SandboxApp : public Application {
 public:
-	SandboxApp() : Application("Sandbox", 800, 600) {}
+	SandboxApp(const ApplicationSettings& settings) : Application("Sandbox", 800, 600, settings) {}
 
 private:
     Renderer::Renderer3D renderer;
     std::shared_ptr<Renderer::Camera> camera;
-    std::shared_ptr<Renderer::Texture> texture;
     std::shared_ptr<Assets::Model> model;
     
     Renderer::Lighting::AmbientLight ambientLight;
@@ -38,13 +38,9 @@ protected:
         renderer.SetCamera(camera);
 		KOSMIC_INFO("(Sandbox) Camera setup complete.");
 
-		// Load texture
-		texture = std::make_shared<Renderer::Texture>("Resources/Textures/kosmic.png");
-		KOSMIC_INFO("(Sandbox) Texture loaded.");
-        
-        // Load 3D model
-        model = std::make_shared<Assets::Model>("Resources/Models/cottage_obj.obj");
-        KOSMIC_INFO("(Sandbox) Model loaded.");
+        // Load 3D model in the background, it shows up once uploaded
+        model = Assets::AssetManager::LoadModel("Resources/Models/cottage_obj.obj");
+        KOSMIC_INFO("(Sandbox) Model requested.");
         
         // Initialize lighting (in white for ambient and directional)
         ambientLight.color = {1.0f, 1.0f, 1.0f};
@@ -52,6 +48,8 @@ protected:
         dirLight.direction = { -0.2f, -1.0f, -0.3f };
         dirLight.color = {1.0f, 1.0f, 1.0f};
         dirLight.intensity = 0.7f;
+        renderer.SetAmbientLight(ambientLight);
+        renderer.SetDirectionalLight(dirLight);
         
         // ECS initialization: create an entity with a Transform component
         auto& registry = ECS::ECSManager::GetRegistry();
@@ -93,39 +91,24 @@ protected:
     }
 
     // Rendering
-	void OnRender() override {
-        // Configure lighting uniforms via shader
-        auto shader = renderer.GetShader();
-        shader->Bind();
-        shader->SetVec3("u_AmbientLightColor", ambientLight.color);
-        shader->SetFloat("u_AmbientLightIntensity", ambientLight.intensity);
-        shader->SetVec3("u_DirLightDirection", dirLight.direction);
-        shader->SetVec3("u_DirLightColor", dirLight.color);
-        shader->SetFloat("u_DirLightIntensity", dirLight.intensity);
-        shader->Unbind();
-        
-        // Bind texture
-        texture->Bind(0);
-        
-        // Render scene
-        renderer.Render();
-        
-        // Draw imported model with same shader
+	void OnRender(float /*alpha*/) override {
+        // Queue the imported model, its meshes are sorted and batched by the renderer
         if (model) {
-            model->Draw(shader);
+            model->Submit(renderer);
         }
         
-        texture->Unbind();
+        // Render scene
+        renderer.Render();
     }
 
     // Cleaning
 	void OnCleanup() override {}
 };
 
-int main() {
+int main(int argc, char** argv) {
     Log::Init(); // Initialize logger
 	KOSMIC_INFO("(Sandbox) Starting SandboxApp...");
-	SandboxApp app;
+	SandboxApp app(ApplicationSettings::FromCommandLine(argc, argv));
 	app.Run();
 	KOSMIC_INFO("(Sandbox) SandboxApp terminated.");
 	return 0;
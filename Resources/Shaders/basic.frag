@@ -1,29 +1,73 @@
 #version 330 core
 
-in vec3 vertexColor;
+in vec4 vertexColor;
 in vec2 TexCoord;
 in vec3 Normal;
+in vec3 FragPos;
 out vec4 FragColor;
 
 uniform sampler2D u_Texture;
 uniform vec4 u_Color;
 
-// Ambient light uniforms
-uniform vec3 u_AmbientLightColor = vec3(1.0, 1.0, 1.0);
-uniform float u_AmbientLightIntensity = 0.7;
-// Directional light uniforms
-uniform vec3 u_DirLightDirection = vec3(-0.2, -1.0, -0.3);
-uniform vec3 u_DirLightColor = vec3(1.0, 1.0, 1.0);
-uniform float u_DirLightIntensity = 0.3;
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 skyProjection;
+    vec4 cameraPosition;
+};
+
+// Scene lights, uploaded once per frame by Renderer3D
+layout (std140) uniform Lighting {
+    vec4 u_Ambient;         // rgb color, a intensity
+    vec4 u_LightDirection;  // xyz direction of the directional light
+    vec4 u_LightColor;      // rgb color, a intensity
+    vec4 u_ClusterScale;    // xy log(depth) to slice, zw pixel to tile
+    uvec4 u_ClusterGrid;    // tiles across, tiles down, depth slices
+};
+
+// Point and spot lights by cluster, see LightClusters.hpp
+uniform usamplerBuffer u_ClusterLights; // First index and count per cluster
+uniform usamplerBuffer u_LightIndices;
+uniform samplerBuffer u_LightData;      // Three texels per light
+
+vec3 ClusterLights(vec3 normal) {
+    float depth = -(view * vec4(FragPos, 1.0)).z;
+    int slice = int(clamp(log(max(depth, 1e-4)) * u_ClusterScale.x + u_ClusterScale.y,
+                          0.0, float(u_ClusterGrid.z - 1u)));
+    ivec2 tile = min(ivec2(gl_FragCoord.xy * u_ClusterScale.zw), ivec2(u_ClusterGrid.xy) - 1);
+    int cluster = tile.x + (tile.y + slice * int(u_ClusterGrid.y)) * int(u_ClusterGrid.x);
+    uvec2 lights = texelFetch(u_ClusterLights, cluster).xy;
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < lights.y; ++i) {
+        int light = int(texelFetch(u_LightIndices, int(lights.x + i)).r) * 3;
+        vec4 positionRange = texelFetch(u_LightData, light);
+        vec4 colorCutoff = texelFetch(u_LightData, light + 1);
+        vec4 directionOuter = texelFetch(u_LightData, light + 2);
+
+        vec3 toLight = positionRange.xyz - FragPos;
+        float distanceSquared = max(dot(toLight, toLight), 1e-8);
+        vec3 direction = toLight * inversesqrt(distanceSquared);
+        // Inverse square, windowed down to zero at the range
+        float ratio = distanceSquared / (positionRange.w * positionRange.w);
+        float window = clamp(1.0 - ratio * ratio, 0.0, 1.0);
+        float attenuation = window * window / (distanceSquared + 1.0);
+        // Point lights have cutoffs that let every direction through
+        float spot = clamp((dot(-direction, directionOuter.xyz) - directionOuter.w) /
+                           max(colorCutoff.w - directionOuter.w, 1e-4), 0.0, 1.0);
+        result += colorCutoff.rgb * (max(dot(normal, direction), 0.0) * attenuation * spot);
+    }
+    return result;
+}
 
 void main() {
-    vec3 ambient = u_AmbientLightColor * u_AmbientLightIntensity;
+    vec3 ambient = u_Ambient.rgb * u_Ambient.a;
     vec3 normal = normalize(Normal);
-    float diff = max(dot(normal, normalize(-u_DirLightDirection)), 0.0);
-    vec3 diffuse = u_DirLightColor * u_DirLightIntensity * diff;
+    float diff = max(dot(normal, normalize(-u_LightDirection.xyz)), 0.0);
+    vec3 diffuse = u_LightColor.rgb * u_LightColor.a * diff + ClusterLights(normal);
     
     // Combine color from texture and uniform
-    vec4 finalColor = u_Color; // use only uniform color
+    vec4 finalColor = u_Color * vertexColor; // per-instance color when instanced
     if (textureSize(u_Texture, 0).x > 1) {
         finalColor *= texture(u_Texture, TexCoord);
     }
@@ -4,16 +4,24 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aColor;
 layout (location = 2) in vec2 aTexCoord;
 layout (location = 3) in vec3 aNormal;
+// Shared by every program, see UniformBuffer.hpp
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 skyProjection;
+    vec4 cameraPosition;
+};
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-out vec3 vertexColor;
+out vec4 vertexColor;
 out vec2 TexCoord;
 out vec3 Normal;
+out vec3 FragPos;
 
 void main() {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-    vertexColor = aColor;
+    vec4 worldPosition = model * vec4(aPos, 1.0);
+    gl_Position = projection * view * worldPosition;
+    FragPos = worldPosition.xyz;
+    vertexColor = vec4(aColor, 1.0);
     TexCoord = aTexCoord;
     // Passing normal directly
     Normal = aNormal;
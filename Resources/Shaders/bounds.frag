@@ -0,0 +1,8 @@
+#version 330 core
+
+// Only depth matters, occlusion queries draw with color writes off
+out vec4 FragColor;
+
+void main() {
+    FragColor = vec4(1.0);
+}
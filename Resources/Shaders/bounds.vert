@@ -0,0 +1,17 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+// Shared by every program, see UniformBuffer.hpp
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 skyProjection;
+    vec4 cameraPosition;
+};
+// World-space box, the unit cube is stretched over it
+uniform vec3 u_Center;
+uniform vec3 u_Size;
+
+void main() {
+    gl_Position = projection * view * vec4(u_Center + aPos * u_Size, 1.0);
+}
@@ -0,0 +1,40 @@
+#version 430 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in vec3 aNormal;
+// Index of the instance, from the culling output with divisor 1: the base
+// instance of each draw command points at its batch's visible instances
+layout (location = 10) in uint aInstance;
+
+// Shared by every program, see UniformBuffer.hpp
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 skyProjection;
+    vec4 cameraPosition;
+};
+
+// Same layout as InstanceData in Mesh.hpp
+struct Instance {
+    mat4 model;
+    vec4 color;
+};
+layout (std430, binding = 0) readonly buffer Instances { Instance instances[]; };
+
+out vec4 vertexColor;
+out vec2 TexCoord;
+out vec3 Normal;
+out vec3 FragPos;
+
+void main() {
+    mat4 model = instances[aInstance].model;
+    vec4 worldPosition = model * vec4(aPos, 1.0);
+    gl_Position = projection * view * worldPosition;
+    FragPos = worldPosition.xyz;
+    vertexColor = vec4(aColor, 1.0) * instances[aInstance].color;
+    TexCoord = aTexCoord;
+    // Same as instanced.vert (assumes uniform scale)
+    Normal = mat3(model) * aNormal;
+}
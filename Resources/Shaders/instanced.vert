@@ -0,0 +1,33 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in vec3 aNormal;
+// Per instance, see InstanceData in Mesh.hpp
+layout (location = 4) in mat4 aModel;
+layout (location = 8) in vec4 aInstanceColor;
+
+// Shared by every program, see UniformBuffer.hpp
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 skyProjection;
+    vec4 cameraPosition;
+};
+
+out vec4 vertexColor;
+out vec2 TexCoord;
+out vec3 Normal;
+out vec3 FragPos;
+
+void main() {
+    vec4 worldPosition = aModel * vec4(aPos, 1.0);
+    gl_Position = projection * view * worldPosition;
+    FragPos = worldPosition.xyz;
+    vertexColor = vec4(aColor, 1.0) * aInstanceColor;
+    TexCoord = aTexCoord;
+    // Instances move independently, so the normal follows the model matrix
+    // (assumes uniform scale)
+    Normal = mat3(aModel) * aNormal;
+}
@@ -0,0 +1,39 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in vec3 aNormal;
+// Per draw, the multi-draw's base instance picks it (see GeometryPool.hpp)
+layout (location = 9) in uint aDrawID;
+
+// Shared by every program, see UniformBuffer.hpp
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 skyProjection;
+    vec4 cameraPosition;
+};
+
+// Five texels per draw: the model matrix columns, then the color
+uniform samplerBuffer u_DrawData;
+// Added to the draw ID; the draw itself where there is no multi-draw indirect
+uniform int u_DrawBase;
+
+out vec4 vertexColor;
+out vec2 TexCoord;
+out vec3 Normal;
+out vec3 FragPos;
+
+void main() {
+    int texel = (u_DrawBase + int(aDrawID)) * 5;
+    mat4 model = mat4(texelFetch(u_DrawData, texel), texelFetch(u_DrawData, texel + 1),
+                      texelFetch(u_DrawData, texel + 2), texelFetch(u_DrawData, texel + 3));
+    vec4 worldPosition = model * vec4(aPos, 1.0);
+    gl_Position = projection * view * worldPosition;
+    FragPos = worldPosition.xyz;
+    vertexColor = vec4(aColor, 1.0) * texelFetch(u_DrawData, texel + 4);
+    TexCoord = aTexCoord;
+    // Same as instanced.vert (assumes uniform scale)
+    Normal = mat3(model) * aNormal;
+}
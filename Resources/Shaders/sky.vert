@@ -2,15 +2,19 @@
 
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 view;
-uniform mat4 projection;
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 skyProjection;
+    vec4 cameraPosition;
+};
 
 out float vHeight; // Pass Y coordinate for gradient
 
 void main() {
     mat4 viewNoTranslate = view;
     viewNoTranslate[3] = vec4(0.0, 0.0, 0.0, 1.0);
-    vec4 pos = projection * viewNoTranslate * vec4(aPos, 1.0);
+    vec4 pos = skyProjection * viewNoTranslate * vec4(aPos, 1.0);
     gl_Position = pos;
     vHeight = aPos.y; // Use Y for gradient computation
 }
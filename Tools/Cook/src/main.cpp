@@ -0,0 +1,343 @@
+#include "Kosmic/Assets/Model.hpp"
+#include "Kosmic/Assets/MeshFile.hpp"
+#include "Kosmic/Assets/TextureFile.hpp"
+#include "Kosmic/Renderer/Texture.hpp"
+#include "Kosmic/Core/Jobs.hpp"
+#include "Kosmic/Core/Logging.hpp"
+#include "Kosmic/Core/MappedFile.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace Kosmic;
+namespace fs = std::filesystem;
+
+// kosmic-cook: converts the models and textures under a resource directory
+// into their cooked runtime formats (.kmesh, .ktex) next to the sources.
+// A manifest of content hashes skips sources that did not change.
+//
+// Textures are block compressed: BC1, BC3 when alpha is used (or BC7 for
+// both with --bc7), and BC5 for normal maps. Models are cooked first so the normal maps their materials
+// reference are known; files named like "*_n", "*_nrm" or "*_normal" count
+// as normal maps too.
+namespace {
+
+enum class AssetKind { Model, Texture };
+
+struct Asset {
+    fs::path source;
+    std::string relative;  // Manifest key, always with forward slashes
+    AssetKind kind;
+    uint64_t hash{0};
+    bool normalMap{false};
+    bool dirty{false};
+    bool cooked{false};
+};
+
+struct Settings {
+    bool force{false};
+    bool compress{true};
+    bool bc7{false};    // Colour textures as BC7 instead of BC1/BC3
+    bool report{false}; // Per texture memory lines on top of the totals
+};
+
+struct ManifestEntry {
+    uint64_t hash{0};
+    uint32_t version{0};
+};
+
+constexpr const char* ManifestName = ".kosmic-cook";
+
+bool IsModel(const std::string& extension) {
+    static const char* extensions[] = {".obj", ".fbx", ".gltf", ".glb", ".dae", ".3ds", ".blend", ".ply"};
+    return std::any_of(std::begin(extensions), std::end(extensions), [&](const char* e) { return extension == e; });
+}
+
+bool IsTexture(const std::string& extension) {
+    static const char* extensions[] = {".png", ".jpg", ".jpeg", ".tga", ".bmp", ".psd"};
+    return std::any_of(std::begin(extensions), std::end(extensions), [&](const char* e) { return extension == e; });
+}
+
+const char* GetExtension(AssetKind kind) {
+    return kind == AssetKind::Model ? Assets::MeshFile::Extension : Assets::TextureFile::Extension;
+}
+
+// Bumping a format version recooks everything of that kind. Texture
+// settings change the output too, so they are folded in.
+uint32_t GetVersion(const Asset& asset, const Settings& settings) {
+    if (asset.kind == AssetKind::Model) return Assets::MeshFile::Version;
+    return Assets::TextureFile::Version << 8 | uint32_t(settings.bc7) << 2 | uint32_t(settings.compress) << 1 |
+           uint32_t(asset.normalMap);
+}
+
+bool IsNormalMapName(const fs::path& path) {
+    std::string stem = path.stem().string();
+    std::transform(stem.begin(), stem.end(), stem.begin(), [](unsigned char c) { return std::tolower(c); });
+    static const char* suffixes[] = {"_n", "_nrm", "_norm", "_normal", "_normals", "_normalmap"};
+    return std::any_of(std::begin(suffixes), std::end(suffixes), [&](const char* suffix) {
+        return stem.size() > std::strlen(suffix) && stem.ends_with(suffix);
+    });
+}
+
+// FNV-1a over the whole file
+uint64_t HashFile(const fs::path& path) {
+    MappedFile file(path.string());
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < file.GetSize(); ++i) {
+        hash ^= file.GetData()[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// One "<hash> <version> <path>" per line
+std::unordered_map<std::string, ManifestEntry> ReadManifest(const fs::path& path) {
+    std::unordered_map<std::string, ManifestEntry> manifest;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        ManifestEntry entry;
+        std::string relative;
+        fields >> std::hex >> entry.hash >> std::dec >> entry.version;
+        fields.ignore(1);
+        std::getline(fields, relative);
+        if (fields.fail() || relative.empty()) continue;
+        manifest[relative] = entry;
+    }
+    return manifest;
+}
+
+bool WriteManifest(const fs::path& path, const std::vector<Asset>& assets, const Settings& settings) {
+    fs::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        out << "# kosmic-cook manifest: content hash, format version, source\n";
+        for (const Asset& asset : assets) {
+            // Failed sources are left out so the next run tries again
+            if (asset.dirty && !asset.cooked) continue;
+            out << std::hex << asset.hash << std::dec << ' ' << GetVersion(asset, settings) << ' ' << asset.relative << '\n';
+        }
+        if (!out) return false;
+    }
+    std::error_code error;
+    fs::rename(temporary, path, error);
+    return !error;
+}
+
+bool Cook(const Asset& asset, const Settings& settings) {
+    std::string source = asset.source.string();
+    std::string cooked = Assets::GetCookedPath(source, GetExtension(asset.kind));
+    if (asset.kind == AssetKind::Model) return Assets::Model::Cook(source, cooked);
+
+    Renderer::TextureCookOptions options;
+    options.compress = settings.compress;
+    options.normalMap = asset.normalMap;
+    options.bc7 = settings.bc7;
+    return Renderer::Texture::Cook(source, cooked, options);
+}
+
+// Normal maps referenced by the cooked models' materials
+void MarkNormalMaps(std::vector<Asset>& assets) {
+    std::unordered_set<std::string> normalMaps;
+    for (const Asset& asset : assets) {
+        if (asset.kind != AssetKind::Model) continue;
+        MappedFile file(Assets::GetCookedPath(asset.source.string(), Assets::MeshFile::Extension));
+        std::optional<Assets::MeshFile::View> view = Assets::MeshFile::Parse(file.GetData(), file.GetSize());
+        if (!view) continue;
+        for (uint32_t i = 0; i < view->header->materialCount; ++i) {
+            const char* map = view->materials[i].normalMap;
+            if (map[0] == '\0') continue;
+            fs::path path = asset.source.parent_path() / std::string(map, strnlen(map, Assets::MeshFile::MaxPath));
+            normalMaps.insert(path.lexically_normal().generic_string());
+        }
+    }
+
+    for (Asset& asset : assets)
+        if (asset.kind == AssetKind::Texture)
+            asset.normalMap = IsNormalMapName(asset.source) ||
+                              normalMaps.contains(asset.source.lexically_normal().generic_string());
+}
+
+// Cooks the dirty assets of one kind, returns how many failed
+uint32_t CookAssets(std::vector<Asset>& assets, AssetKind kind, const Settings& settings,
+                    const std::unordered_map<std::string, ManifestEntry>& manifest) {
+    Jobs::ParallelFor(static_cast<uint32_t>(assets.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            Asset& asset = assets[i];
+            if (asset.kind != kind) continue;
+
+            std::string source = asset.source.string();
+            std::string cooked = Assets::GetCookedPath(source, GetExtension(asset.kind));
+            auto entry = manifest.find(asset.relative);
+            Assets::CookedHeader header;
+            asset.dirty = settings.force || entry == manifest.end() || entry->second.hash != asset.hash ||
+                          entry->second.version != GetVersion(asset, settings) ||
+                          !Assets::ReadCookedHeader(cooked, header);
+
+            // Same content but touched (checkout, copy): refresh the stamp the
+            // runtime compares, instead of cooking again
+            Assets::SourceStamp stamp = Assets::GetSourceStamp(source);
+            if (!asset.dirty && header.source != stamp && !Assets::WriteSourceStamp(cooked, stamp))
+                asset.dirty = true;
+        }
+    });
+
+    std::atomic<uint32_t> failed{0};
+    Jobs::ParallelFor(static_cast<uint32_t>(assets.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            Asset& asset = assets[i];
+            if (asset.kind != kind || !asset.dirty) continue;
+            asset.cooked = Cook(asset, settings);
+            if (asset.cooked)
+                KOSMIC_INFO("[Cook] {}", asset.relative);
+            else
+                failed++;
+        }
+    });
+    return failed.load();
+}
+
+// Video memory of the cooked textures against the same mip chains uploaded
+// uncompressed, which is what the runtime did before textures were compressed
+void ReportTextureMemory(const std::vector<Asset>& assets, const Settings& settings) {
+    using Assets::TextureFile::Format;
+    constexpr uint32_t FormatCount = static_cast<uint32_t>(Format::BC7) + 1;
+    uint64_t total = 0, totalUncompressed = 0;
+    uint32_t counts[FormatCount]{};
+
+    for (const Asset& asset : assets) {
+        if (asset.kind != AssetKind::Texture) continue;
+        MappedFile file(Assets::GetCookedPath(asset.source.string(), Assets::TextureFile::Extension));
+        std::optional<Assets::TextureFile::View> view = Assets::TextureFile::Parse(file.GetData(), file.GetSize());
+        if (!view) continue;
+
+        // Drivers keep RGB8 as 4 bytes per texel
+        uint64_t bytes = 0, uncompressed = 0;
+        Format format = view->header->format;
+        for (uint32_t i = 0; i < view->header->mipCount; ++i) {
+            const Assets::TextureFile::MipLevel& level = view->levels[i];
+            uncompressed += uint64_t(level.width) * level.height * 4;
+            bytes += Assets::TextureFile::IsCompressed(format) ? level.size : uint64_t(level.width) * level.height * 4;
+        }
+        total += bytes;
+        totalUncompressed += uncompressed;
+        counts[static_cast<uint32_t>(format)]++;
+
+        if (settings.report)
+            KOSMIC_INFO("[Cook]   {:<40} {:>5} {:>9.1f} KB -> {:>9.1f} KB", asset.relative,
+                        Assets::TextureFile::GetFormatName(format), uncompressed / 1024.0, bytes / 1024.0);
+    }
+    if (totalUncompressed == 0) return;
+
+    std::string formats;
+    for (uint32_t i = 0; i < FormatCount; ++i)
+        if (counts[i])
+            formats += (formats.empty() ? "" : ", ") + std::to_string(counts[i]) + " " +
+                       Assets::TextureFile::GetFormatName(static_cast<Format>(i));
+    KOSMIC_INFO("[Cook] Texture memory: {:.1f} MB uncompressed -> {:.1f} MB cooked ({:.0f}%; {})",
+                totalUncompressed / 1048576.0, total / 1048576.0, 100.0 * total / totalUncompressed, formats);
+}
+
+int CookDirectory(const fs::path& root, const Settings& settings) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<Asset> assets;
+    std::error_code error;
+    for (auto it = fs::recursive_directory_iterator(root, error); !error && it != fs::recursive_directory_iterator(); it.increment(error)) {
+        if (!it->is_regular_file()) continue;
+        std::string extension = it->path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+
+        AssetKind kind;
+        if (IsModel(extension)) kind = AssetKind::Model;
+        else if (IsTexture(extension)) kind = AssetKind::Texture;
+        else continue;
+        assets.push_back({it->path(), fs::relative(it->path(), root).generic_string(), kind});
+    }
+    if (error) {
+        KOSMIC_ERROR("[Cook] Cannot read {}: {}", root.string(), error.message());
+        return 1;
+    }
+
+    fs::path manifestPath = root / ManifestName;
+    auto manifest = ReadManifest(manifestPath);
+
+    // Hashing reads every source, which is the bulk of a no-op run
+    Jobs::ParallelFor(static_cast<uint32_t>(assets.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) assets[i].hash = HashFile(assets[i].source);
+    });
+
+    uint32_t failed = CookAssets(assets, AssetKind::Model, settings, manifest);
+    MarkNormalMaps(assets);
+    failed += CookAssets(assets, AssetKind::Texture, settings, manifest);
+
+    if (!WriteManifest(manifestPath, assets, settings))
+        KOSMIC_WARN("[Cook] Failed to write the manifest {}", manifestPath.string());
+    ReportTextureMemory(assets, settings);
+
+    uint32_t dirtyCount = static_cast<uint32_t>(std::count_if(assets.begin(), assets.end(), [](const Asset& a) { return a.dirty; }));
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    KOSMIC_INFO("[Cook] {}: {} cooked, {} up to date, {} failed in {:.2f}s",
+                root.string(), dirtyCount - failed, assets.size() - dirtyCount, failed, seconds);
+    return failed > 0 ? 1 : 0;
+}
+
+void PrintUsage() {
+    KOSMIC_INFO("Usage: kosmic-cook [--force] [--no-compress] [--bc7] [--report] [--workers N] [directory...]");
+    KOSMIC_INFO("Cooks models and textures under each directory (default: Resources)");
+    KOSMIC_INFO("  --no-compress  keep textures as RGB8/RGBA8 instead of BC1/BC3/BC5");
+    KOSMIC_INFO("  --bc7          BC7 for colour textures: better quality, twice BC1's size");
+    KOSMIC_INFO("  --report       list every texture's memory, not only the totals");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Log::Init();
+
+    Settings settings;
+    uint32_t workers = 0;
+    std::vector<fs::path> directories;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--force") == 0)
+            settings.force = true;
+        else if (std::strcmp(argv[i], "--no-compress") == 0)
+            settings.compress = false;
+        else if (std::strcmp(argv[i], "--bc7") == 0)
+            settings.bc7 = true;
+        else if (std::strcmp(argv[i], "--report") == 0)
+            settings.report = true;
+        else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc)
+            workers = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--help") == 0) {
+            PrintUsage();
+            return 0;
+        } else if (argv[i][0] == '-') {
+            KOSMIC_ERROR("Unknown option: {}", argv[i]);
+            PrintUsage();
+            return 1;
+        } else
+            directories.emplace_back(argv[i]);
+    }
+    if (directories.empty()) directories.emplace_back("Resources");
+
+    Jobs::Init(workers);
+    int result = 0;
+    for (const fs::path& directory : directories)
+        result |= CookDirectory(directory, settings);
+    Jobs::Shutdown();
+    return result;
+}